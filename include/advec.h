@@ -52,6 +52,13 @@ class Advec
         virtual unsigned long get_time_limit(unsigned long, double) = 0; ///< Get the maximum time step imposed by advection scheme
         virtual double get_cfl(double) = 0; ///< Retrieve the CFL number.
 
+        virtual void exec_block(int, int); ///< Execute the advection scheme for a block of vertical levels.
+
+        // Functions for the CFL number that is accumulated in the advection kernels.
+        bool has_fused_cfl(); ///< Check whether the CFL number is accumulated during the advection.
+        virtual double get_cfl_max_local(); ///< Get the CFL number per unit time step of this process.
+        unsigned long get_time_limit_reduced(unsigned long, double, double); ///< Get the time step limit from the reduced CFL number.
+
     protected:
         Master* master; ///< Pointer to master class.
         Model*  model;  ///< Pointer to model class.
@@ -62,5 +69,6 @@ class Advec
         static const double cflmin; ///< Minimum value for CFL used to avoid overflows.
 
         std::string swadvec;
+        std::string swfusedcfl; ///< Switch for the accumulation of the CFL number in the advection kernels.
 };
 #endif
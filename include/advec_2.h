@@ -38,15 +38,23 @@ class Advec_2 : public Advec
         ~Advec_2();              ///< Destructor of the advection class.
 
         void exec(); ///< Execute the advection scheme.
+        void exec_block(int, int); ///< Execute the advection scheme for a block of vertical levels.
         unsigned long get_time_limit(long unsigned int, double); ///< Get the limit on the time step imposed by the advection scheme.
         double get_cfl(double); ///< Get the CFL number.
+        double get_cfl_max_local(); ///< Get the CFL number per unit time step of this process.
 
     private:
         double calc_cfl(double*, double*, double*, double*, double); ///< Calculate the CFL number.
+        double calc_cfl_local(double*, double*, double*, double*);   ///< Calculate the CFL number per unit time step of this process.
 
-        void advec_u(double*, double*, double*, double*, double*, double*, double*);          ///< Calculate longitudinal velocity advection.
-        void advec_v(double*, double*, double*, double*, double*, double*, double*);          ///< Calculate latitudinal velocity advection.
-        void advec_w(double*, double*, double*, double*, double*, double*, double*);          ///< Calculate vertical velocity advection.
-        void advec_s(double*, double*, double*, double*, double*, double*, double*, double*); ///< Calculate scalar advection.
+        double cfl_fused;     ///< CFL number per unit time step accumulated during the advection of the first substep.
+        bool cfl_fused_valid; ///< Flag indicating that cfl_fused belongs to the current fields.
+
+        template<bool>
+        double advec_u(double*, double*, double*, double*, double*, double*, double*, int, int);        ///< Calculate longitudinal velocity advection.
+        void advec_v(double*, double*, double*, double*, double*, double*, double*, int, int);          ///< Calculate latitudinal velocity advection.
+        void advec_w(double*, double*, double*, double*, double*, double*, double*, int, int);          ///< Calculate vertical velocity advection.
+        template<typename T>
+        void advec_s(double*, T*, int, double*, double*, double*, double*, double*, double*, int, int); ///< Calculate scalar advection.
 };
 #endif
@@ -51,7 +51,7 @@ class Advec_4 : public Advec
         void advec_v(double* restrict, double* restrict, double* restrict, double* restrict, double* restrict); ///< Calculate latitudinal velocity advection.
         template<bool>
         void advec_w(double* restrict, double* restrict, double* restrict, double* restrict, double* restrict); ///< Calculate vertical velocity advection.
-        template<bool>
-        void advec_s(double* restrict, double* restrict, double* restrict, double* restrict, double* restrict, double* restrict); ///< Calculate scalar advection.
+        template<bool, typename T>
+        void advec_s(double* restrict, T* restrict, int, double* restrict, double* restrict, double* restrict, double* restrict); ///< Calculate scalar advection.
 };
 #endif
@@ -49,6 +49,7 @@ class Advec_4m : public Advec
         void advec_u(double*, double*, double*, double*, double*);          ///< Calculate longitudinal velocity advection.
         void advec_v(double*, double*, double*, double*, double*);          ///< Calculate latitudinal velocity advection.
         void advec_w(double*, double*, double*, double*, double*);          ///< Calculate vertical velocity advection.
-        void advec_s(double*, double*, double*, double*, double*, double*); ///< Calculate scalar advection.
+        template<typename T>
+        void advec_s(double*, T*, int, double*, double*, double*, double*); ///< Calculate scalar advection.
 };
 #endif
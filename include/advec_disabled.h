@@ -38,6 +38,7 @@ class Advec_disabled : public Advec
         ~Advec_disabled();              ///< Destructor of the advection class.
 
         void exec(); ///< Execute the advection scheme.
+        void exec_block(int, int); ///< Execute the advection scheme for a block of vertical levels.
 
         unsigned long get_time_limit(unsigned long, double); ///< Get the maximum time step imposed by advection scheme
 
@@ -56,10 +56,10 @@ class Boundary
         virtual void exec(); ///< Update the boundary conditions.
         virtual void set_ghost_cells_w(Boundary_w_type); ///< Update the boundary conditions.
 
-        virtual void exec_stats(Mask*); ///< Execute statistics of surface
+        virtual void exec_stats(); ///< Execute statistics of surface
         virtual void exec_cross();       ///< Execute cross sections of surface
 
-        virtual void get_mask(Field3d*, Field3d*, Mask*); ///< Calculate statistics mask
+        virtual void get_mask(Mask*); ///< Calculate statistics mask
         virtual void get_surface_mask(Field3d*);          ///< Calculate surface mask
 
         std::string get_switch();
@@ -118,10 +118,14 @@ class Boundary
         virtual void update_bcs();       ///< Update the boundary values.
         virtual void update_slave_bcs(); ///< Update the slave boundary values.
 
-        void calc_ghost_cells_bot_2nd(double*, double*, Boundary_type, double*, double*); ///< Calculate the bottom ghost cells with 2nd-order accuracy.
-        void calc_ghost_cells_top_2nd(double*, double*, Boundary_type, double*, double*); ///< Calculate the top ghost cells with 2nd-order accuracy.
-        void calc_ghost_cells_bot_4th(double*, double*, Boundary_type, double*, double*); ///< Calculate the bottom ghost cells with 4th-order accuracy.
-        void calc_ghost_cells_top_4th(double*, double*, Boundary_type, double*, double*); ///< Calculate the top ghost cells with 4th-order accuracy.
+        template<typename T>
+        void calc_ghost_cells_bot_2nd(T*, double*, Boundary_type, double*, double*); ///< Calculate the bottom ghost cells with 2nd-order accuracy.
+        template<typename T>
+        void calc_ghost_cells_top_2nd(T*, double*, Boundary_type, double*, double*); ///< Calculate the top ghost cells with 2nd-order accuracy.
+        template<typename T>
+        void calc_ghost_cells_bot_4th(T*, double*, Boundary_type, double*, double*); ///< Calculate the bottom ghost cells with 4th-order accuracy.
+        template<typename T>
+        void calc_ghost_cells_top_4th(T*, double*, Boundary_type, double*, double*); ///< Calculate the top ghost cells with 4th-order accuracy.
 
         void calc_ghost_cells_botw_4th(double*); ///< Calculate the bottom ghost cells for the vertical velocity with 4th order accuracy.
         void calc_ghost_cells_topw_4th(double*); ///< Calculate the top ghost cells for the vertical velocity with 4th order accuracy.
@@ -41,7 +41,7 @@ class Boundary_surface : public Boundary
         void create(Input*);
         virtual void set_values();
 
-        void exec_stats(Mask*); ///< Execute statistics of surface
+        void exec_stats(); ///< Execute statistics of surface
         void exec_cross();      ///< Execute cross sections of surface
 
         // Make these variables public for out-of-class usage.
@@ -87,12 +87,14 @@ class Boundary_surface : public Boundary
                    double*, double*, double*, double*,
                    double*, double*, double*, double*,
                    double, int);
-        void surfs(double*, double*, double*,
+        template<typename T>
+        void surfs(double*, double*, T*,
                    double*, double*, double*,
                    double, int);
 
-        double calc_obuk_noslip_flux     (const float* const, const float* const, int&, double, double, double);
-        double calc_obuk_noslip_dirichlet(const float* const, const float* const, int&, double, double, double);
+        double calc_ri_noslip_flux     (double, double, double); // Richardson number, rounded to single precision
+        double calc_ri_noslip_dirichlet(double, double, double);
+        void   calc_zL(double*);                                   // Invert the lookup table in place
 
         double ustarin;
 
@@ -100,6 +102,14 @@ class Boundary_surface : public Boundary
         float* zL_sl;
         float* f_sl;
 
+        // Index table for the inversion of the lookup table
+        int*  zL_bin;
+        int   nzL_bin;
+        int   nzL_bin0;
+        int   nzL_mono;
+        float f_bin0;
+        float f_bin_idf;
+
 #ifdef USECUDA
         float* zL_sl_g;
         float* f_sl_g;
@@ -37,7 +37,7 @@ class Boundary_surface_patch : public Boundary_surface
 
         void init(Input*);
         void set_values();
-        void get_mask(Field3d*, Field3d*, Mask*);
+        void get_mask(Mask*);
         void get_surface_mask(Field3d*);
 
     private:
@@ -24,6 +24,7 @@
 #define BUDGET
 
 #include <string>
+#include <vector>
 
 class Input;
 class Master;
@@ -53,6 +54,8 @@ class Budget
         virtual void create() = 0;
         virtual void exec_stats(Mask*) = 0;
 
+        void copy_stats(Mask*, Mask*); ///< Copy the budget profiles of one mask into another mask.
+
     protected:
         Master& master;
         Grid&   grid;
@@ -64,6 +67,12 @@ class Budget
         Stats&  stats;
 
         std::string swbudget;
+
+        std::vector<std::string> budgetlist; ///< Budgets that are calculated, all in case the list is empty.
+        std::vector<std::string> proflist;   ///< Profiles that have been added to the statistics.
+
+        bool has_budget(const std::string&); ///< Check whether a budget is calculated.
+        void add_prof(std::string, std::string, std::string, std::string); ///< Add a budget profile to the statistics.
 };
 #endif
 
@@ -49,6 +49,11 @@ class Budget_2 : public Budget
         double* umodel;
         double* vmodel;
 
+        void create_tke_budget();      ///< Add the profiles of the velocity variance and flux budgets.
+        void create_buoyancy_budget(); ///< Add the profiles of the buoyancy variance and flux budgets.
+        void exec_tke_budget(Mask*);      ///< Calculate the velocity variance and flux budgets.
+        void exec_buoyancy_budget(Mask*); ///< Calculate the buoyancy variance and flux budgets.
+
         void calc_kinetic_energy(double*, double*, const double*, const double*, const double*, const double*, const double*, const double, const double);
 
         void calc_advection_terms(double*, double*, double*, double*, double*, double*, double*, double*, double*, double*, double*,
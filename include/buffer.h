@@ -42,6 +42,8 @@ class Buffer
         void init();         ///< Initialize the arrays that contain the profiles.
         void create(Input*); ///< Read the profiles of the forces from the input.
         void exec();         ///< Add the tendencies created by the damping.
+        void exec_block(int, int); ///< Add the damping tendencies for a block of vertical levels.
+        void shift_velocity(double, double); ///< Shift the velocity profiles to a new Galilean transformation.
 
         // GPU functions and variables
         void prepare_device(); ///< Allocate and copy buffer profiles at/to GPU                             
@@ -65,8 +67,10 @@ class Buffer
         std::string swbuffer; ///< Switch for buffer.
         std::string swupdate; ///< Switch for enabling runtime updating of buffer profile.
 
-        void buffer(double* const, const double* const, 
-                    const double* const, const double* const); ///< Calculate the tendency.
+        template<typename T>
+        void buffer(double* const, const T* const, 
+                    const double* const, const double* const,
+                    int, int); ///< Calculate the tendency.
 
         // GPU functions and variables
         std::map<std::string, double*> bufferprofs_g; ///< Map containing the buffer profiles at GPU.
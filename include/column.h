@@ -0,0 +1,96 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2017 Chiel van Heerwaarden
+ * Copyright (c) 2011-2017 Thijs Heus
+ * Copyright (c) 2014-2017 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COLUMN
+#define COLUMN
+
+#include <netcdf>
+#include <map>
+#include <vector>
+using namespace netCDF;
+
+class Master;
+class Model;
+class Grid;
+class Fields;
+
+/**
+ * Class for the output of vertical columns at fixed horizontal locations.
+ * The columns are extracted by the processes that own them, buffered in
+ * memory and gathered on the master, which writes them in chunks of samples
+ * to a single NetCDF file.
+ */
+class Column
+{
+    public:
+        Column(Model*, Input*);
+        ~Column();
+
+        void init(double);
+        void create(int);
+
+        unsigned long get_time_limit(unsigned long);
+        std::string get_switch();
+
+        bool do_column();
+        void exec(int, double); ///< Add the columns of the current time to the buffer.
+        void save();            ///< Write the buffered samples to disk.
+
+    private:
+        Master* master;
+        Model*  model;
+        Grid*   grid;
+        Fields* fields;
+
+        std::string swcolumn;
+
+        double sampletime;
+        unsigned long isampletime;
+
+        int nbuffer;    ///< Number of samples that are kept in memory before they are written.
+        int nsamples;   ///< Number of samples in the buffer.
+        int nwritten;   ///< Number of samples in the file.
+
+        std::vector<std::string> columnlist; ///< List with the variables of the columns.
+        std::vector<double> xcol; ///< X-position [m] of the columns.
+        std::vector<double> ycol; ///< Y-position [m] of the columns.
+
+        std::vector<int> ncol; ///< Number of the columns owned by this process.
+        std::vector<int> icol; ///< Local x-index of the columns owned by this process.
+        std::vector<int> jcol; ///< Local y-index of the columns owned by this process.
+
+        std::vector<double> tbuf;  ///< Buffer with the times of the samples.
+        std::vector<int> iterbuf;  ///< Buffer with the iteration numbers of the samples.
+        std::map<std::string, std::vector<double> > buffer; ///< Buffer with the owned columns per variable.
+
+        std::vector<std::vector<int> > colproc; ///< Numbers of the columns per process.
+        std::vector<double> recvbuf; ///< Columns of all processes gathered on the master.
+        std::vector<double> filebuf; ///< Columns of all processes in the order of the file.
+
+        NcFile* dataFile;
+        NcVar t_var;
+        NcVar iter_var;
+        std::map<std::string, NcVar> ncvars;
+
+        int get_nlevels(std::string);
+};
+#endif
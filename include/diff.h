@@ -42,10 +42,16 @@ class Diff
         virtual void set_values() = 0;
         virtual void exec_viscosity() = 0;
         virtual void exec() = 0;
+        virtual void exec_block(int, int); ///< Execute the diffusion for a block of vertical levels.
+        virtual void exec_implicit();      ///< Execute the implicit part of the diffusion as a split step after the substep.
 
         virtual unsigned long get_time_limit(unsigned long, double) = 0;
         virtual double get_dn(double) = 0;
 
+        // Functions to reduce the diffusion number together with the CFL number.
+        virtual double get_dnmul_local(); ///< Get the diffusion number per unit time step of this process.
+        virtual unsigned long get_time_limit_reduced(unsigned long, double, double); ///< Get the time step limit from the reduced diffusion number.
+
         #ifdef USECUDA
         // GPU functions and variables
         virtual void prepare_device() = 0;
@@ -33,6 +33,7 @@ class Diff_2 : public Diff
 
         void set_values();
         void exec();
+        void exec_block(int, int);
 
         unsigned long get_time_limit(unsigned long, double);
         double get_dn(double);
@@ -47,7 +48,8 @@ class Diff_2 : public Diff
     private:
         double dnmul;
 
-        void diff_c(double*, double*, double*, double*, double);
-        void diff_w(double*, double*, double*, double*, double);
+        template<typename T>
+        void diff_c(double*, T*, int, double*, double*, const double*, int, int);
+        void diff_w(double*, double*, double*, double*, double, int, int);
 };
 #endif
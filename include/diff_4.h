@@ -48,8 +48,8 @@ class Diff_4 : public Diff
     private:
         double dnmul;
 
-        template<bool>
-        void diff_c(double* restrict, double* restrict, double* restrict, double* restrict, double);
+        template<bool, typename T>
+        void diff_c(double* restrict, T* restrict, int, double* restrict, double* restrict, const double* restrict);
         template<bool> 
         void diff_w(double* restrict, double* restrict, double* restrict, double* restrict, double);
 };
@@ -32,11 +32,16 @@ class Diff_smag_2 : public Diff
         ~Diff_smag_2();
 
         void exec();
+        void exec_block(int, int);
+        void exec_implicit();
         void exec_viscosity();
 
         unsigned long get_time_limit(unsigned long, double);
         double get_dn(double);
 
+        double get_dnmul_local();
+        unsigned long get_time_limit_reduced(unsigned long, double, double);
+
         double tPr;
 
         #ifdef USECUDA
@@ -45,10 +50,12 @@ class Diff_smag_2 : public Diff
         void clear_device();
         #endif
 
-        // Empty functions, there are allowed to pass.
-        void set_values() {}
+        void set_values();
 
     private:
+        template<bool, bool>
+        void exec_block_kernels(int, int);
+
         template<bool>
         void calc_strain2(double*,
                           double*, double*, double*,
@@ -70,18 +77,30 @@ class Diff_smag_2 : public Diff
                                 double*, double*,
                                 double, double);
 
+        template<bool, bool>
+        void diff_u(double*, double*, double*, double*, double*, double*, double*, double*, double*, double*, double*, int, int);
+        template<bool, bool>
+        void diff_v(double*, double*, double*, double*, double*, double*, double*, double*, double*, double*, double*, int, int);
+
         template<bool>
-        void diff_u(double*, double*, double*, double*, double*, double*, double*, double*, double*, double*, double*);
-        template<bool>
-        void diff_v(double*, double*, double*, double*, double*, double*, double*, double*, double*, double*, double*);
+        void diff_w(double*, double*, double*, double*, double*, double*, double*, double*, double*, int, int);
+        template<bool, typename T>
+        void diff_c(double*, T*, int, double*, double*, double*, double* const*, double* const*, double*, double*, double, int, int);
 
-        void diff_w(double*, double*, double*, double*, double*, double*, double*, double*, double*);
-        void diff_c(double*, double*, double*, double*, double*, double*, double*, double*, double*, double);
+        // Implicit vertical diffusion
+        enum Location_type {U_type, V_type, W_type, Scalar_type};
+        template<int>
+        void calc_implicit_coef(double*, double*, double*, double*, double*, double*, double*, double*, double, int, double);
+        template<typename T>
+        void diff_implicit(T*, double*, double*, double*, double*, int, int, int);
 
         double calc_dnmul(double*, double*, double);
 
         double cs;
 
+        std::string swimplicit; ///< Switch for the implicit vertical diffusion
+        double* implicit_work;  ///< Work arrays of the tridiagonal solver of one xz-slice
+
         #ifdef USECUDA
         double* mlen_g;
         #endif
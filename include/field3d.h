@@ -32,14 +32,15 @@ class Field3d
 {
     public:
         // functions
-        Field3d(Grid*, Master*, std::string, std::string, std::string);
+        Field3d(Grid*, Master*, std::string, std::string, std::string, bool=false);
         ~Field3d();
 
-        int init();
+        int init(double* =0);
         // int checkfornan();
 
         // variables at CPU
         double* data;
+        float*  data_single; ///< Storage of the 3d field in single precision, replaces data if is_single is set.
         double* databot;
         double* datatop;
         double* datamean;
@@ -51,6 +52,8 @@ class Field3d
         std::string unit;
         std::string longname;
         double visc;
+        bool is_single; ///< Switch for single precision storage of the 3d field, the 2d fields remain in double precision.
+        bool is_packed; ///< Switch that indicates that data points into a packed array that is owned by the fields class.
 
         // Device functions and variables
         void init_device();  ///< Allocate Field3D fields at device 
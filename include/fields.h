@@ -24,6 +24,7 @@
 #define FIELDS
 #include <map>
 #include <vector>
+#include <cstdint>
 #include "field3d.h"
 
 class Master;
@@ -47,11 +48,12 @@ class Fields
         void create_stats(); ///< Initialization of the fields statistics.
 
         void exec();
-        void get_mask(Field3d*, Field3d*, Mask*);
-        void exec_stats(Mask*);
+        void get_mask(Mask*);
+        void exec_stats();
 
         void init_momentum_field  (Field3d*&, Field3d*&, std::string, std::string, std::string);
         void init_prognostic_field(std::string, std::string, std::string);
+        void init_prognostic_single_field(std::string, std::string, std::string);
         void init_diagnostic_field(std::string, std::string, std::string);
         void init_tmp_field       (std::string, std::string, std::string);
 
@@ -62,6 +64,12 @@ class Fields
         double check_tke();
         double check_mass();
 
+        void get_double_field(double*, const Field3d*); ///< Copy a double or single precision 3d field into a double precision array.
+        void set_single_field(Field3d*, const double*); ///< Store a double precision array in a single precision 3d field.
+
+        void get_layer_mean_velocity(double*, double*, double, double); ///< Get the mean horizontal velocity in a layer.
+        void shift_velocity(double, double);                           ///< Subtract a constant from the horizontal velocity.
+
         void set_calc_mean_profs(bool);
         void set_minimum_tmp_fields(int);
 
@@ -87,6 +95,15 @@ class Fields
         FieldMap sp; ///< Map containing all prognostic scalar field3d instances
         FieldMap st; ///< Map containing all prognostic scalar tendency field3d instances
 
+        // The double precision scalars are stored as consecutive 3d fields of ncells values each, such that the
+        // scalar n starts at offset n*ncells and the kernels can process all scalars in a single sweep.
+        double* sp_packed; ///< Packed 4d array containing the data of all prognostic scalars in the order of sp
+        double* st_packed; ///< Packed 4d array containing the data of all scalar tendencies in the order of st
+
+        FieldMap sps; ///< Map containing all prognostic scalar field3d instances stored in single precision
+        FieldMap sts; ///< Map containing the double precision tendencies of the single precision scalars
+        FieldMap spall; ///< Map containing all prognostic scalars, both in double and in single precision
+
         FieldMap atmp; ///< Map containing all temporary field3d instances
 
         double* rhoref;  ///< Reference density at full levels 
@@ -138,9 +155,11 @@ class Fields
 
         void check_added_cross(std::string, std::string, std::vector<std::string>*, std::vector<std::string>*);
 
+        void calc_scalar_stats(Field3d*, double*); ///< Calculate the statistics of a scalar, of which the data is passed separately.
+
         // masks
-        void calc_mask_wplus(double*, double*, double*, int*, int*, int*, double*);
-        void calc_mask_wmin (double*, double*, double*, int*, int*, int*, double*);
+        void calc_mask_wplus(uint64_t*, uint64_t*, uint64_t*, double*);
+        void calc_mask_wmin (uint64_t*, uint64_t*, uint64_t*, double*);
 
         // perturbations
         double rndamp;
@@ -159,10 +178,6 @@ class Fields
         int randomize    (Input*, std::string, double*);
         int add_vortex_pair(Input*);
 
-        // statistics
-        double* umodel;
-        double* vmodel;
-
         int n_tmp_fields;   // number of temporary fields
 
         /* 
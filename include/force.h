@@ -88,6 +88,13 @@ class Force
         std::vector<std::string> timedeplist;
         std::map<std::string, double*> timedepdata;
 
+        // NetCDF time dependent profiles, of which only a window of time records is kept in memory.
+        int timedepwindow; ///< Number of time records that is resident in memory.
+        int timedepstart;  ///< Index of the first resident time record.
+
+        int create_time_dependent_nc();       ///< Read the time axis from the NetCDF file and allocate the window.
+        void read_time_dependent_window(int); ///< Read the window of time records that starts at the given index.
+
         void update_time_dependent_profs(double, double, int, int); ///< Set the time dependent profiles.
 
         void calc_flux(double* const, const double* const,
@@ -111,6 +118,7 @@ class Force
         double* vg_g;  ///< Pointer to GPU array v-component geostrophic wind.
         double* wls_g; ///< Pointer to GPU array large-scale vertical velocity.
         std::map<std::string, double*> timedepdata_g;
+        void update_time_dependent_window_g(); ///< Copy the resident time records to the GPU.
 
 };
 #endif
@@ -110,6 +110,14 @@ class Grid
         double utrans; ///< Galilean transformation velocity in x-direction.
         double vtrans; ///< Galilean transformation velocity in y-direction.
 
+        std::string swtrans; ///< Switch for the adaptive Galilean transformation velocity.
+        double transtime;    ///< Time between two updates of the transformation velocity.
+        double transzmin;    ///< Bottom of the layer of which the mean wind is the transformation velocity.
+        double transzmax;    ///< Top of the layer of which the mean wind is the transformation velocity.
+
+        void save_trans(int); ///< Saves the transformation velocity to file.
+        void load_trans(int); ///< Loads the transformation velocity from file.
+
         std::string swspatialorder; ///< Default spatial order of the operators to be used on this grid.
 
         void set_minimum_ghost_cells(int, int, int);
@@ -118,6 +126,7 @@ class Grid
         void init_mpi(); ///< Creates the MPI data types used in grid operations.
         void exit_mpi(); ///< Destructs the MPI data types used in grid operations.
         void boundary_cyclic   (double*, Edge=Both_edges); ///< Fills the ghost cells in the periodic directions.
+        void boundary_cyclic   (float*,  Edge=Both_edges); ///< Fills the ghost cells in the periodic directions of a single precision field.
         void boundary_cyclic_2d(double*); ///< Fills the ghost cells of one slice in the periodic direction.
         void transpose_zx(double*, double*); ///< Changes the transpose orientation from z to x.
         void transpose_xz(double*, double*); ///< Changes the transpose orientation from x to z.
@@ -128,9 +137,11 @@ class Grid
 
         void get_max (double*);      ///< Gets the maximum of a number over all processes.
         void get_max (int*);         ///< Gets the maximum of a number over all processes.
+        void get_max (double*, int); ///< Gets the maximum of an array of numbers over all processes in one reduction.
         void get_sum (double*);      ///< Gets the sum of a number over all processes.
         void get_prof(double*, int); ///< Averages a vertical profile over all processes.
         void calc_mean(double*, const double*, int);
+        void calc_mean(double*, const float*, int);
 
         // IO functions
         int save_field3d(double*, double*, double*, char*, double); ///< Saves a full 3d field.
@@ -189,12 +200,20 @@ class Grid
         void calculate(); ///< Computation of dimensions, faces and ghost cells.
         void check_ghost_cells(); ///< Check whether slice thickness is at least equal to number of ghost cells.
 
+        template<typename T>
+        void boundary_cyclic_kernel(T*, Edge); ///< Fills the ghost cells in the periodic directions for double and single precision fields.
+
+        template<typename T>
+        void calc_mean_kernel(double*, const T*, int); ///< Calculates the mean profile of a double or single precision field.
+
 #ifdef USEMPI
         // MPI Datatypes
         MPI_Datatype eastwestedge;     ///< MPI datatype containing the ghostcells at the east-west sides.
         MPI_Datatype northsouthedge;   ///< MPI datatype containing the ghostcells at the north-south sides.
         MPI_Datatype eastwestedge2d;   ///< MPI datatype containing the ghostcells for one slice at the east-west sides.
         MPI_Datatype northsouthedge2d; ///< MPI datatype containing the ghostcells for one slice at the north-south sides.
+        MPI_Datatype eastwestedge_single;   ///< MPI datatype containing the ghostcells at the east-west sides of single precision fields.
+        MPI_Datatype northsouthedge_single; ///< MPI datatype containing the ghostcells at the north-south sides of single precision fields.
 
         MPI_Datatype transposez;  ///< MPI datatype containing base blocks for z-orientation in zx-transpose.
         MPI_Datatype transposez2; ///< MPI datatype containing base blocks for z-orientation in zy-transpose.
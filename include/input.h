@@ -67,6 +67,7 @@ class Input
 
         int read_ini_file();
         int read_data_file(Data_map*, std::string, bool);
+        void read_lines(std::vector<std::string>*, FILE*); ///< Read a file on the master and broadcast its lines in a single message.
 
         template <class valuetype>
         int parse_item(valuetype*, std::string, std::string, std::string, bool, valuetype);
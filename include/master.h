@@ -55,6 +55,9 @@ class Master
         void sum(int *, int);
         void sum(double *, int);
 
+        // gather data of varying size per process on the master
+        void gather(double*, int, double*, int*);
+
         // overload the max function
         void max(double *, int);
 
@@ -37,9 +37,11 @@ class Pres;
 class Force;
 class Thermo;
 class Buffer;
+class Tendency;
 class Stats;
 class Cross;
 class Dump;
+class Column;
 class Budget;
 
 class Model
@@ -69,11 +71,13 @@ class Model
         Force*    force;   
         Thermo*   thermo;
         Buffer*   buffer;
+        Tendency* tendency;
 
         // Postprocessing and output modules.
         Stats*  stats;
         Cross*  cross;
         Dump*   dump;
+        Column* column;
         Budget* budget;
 
     private:
@@ -83,7 +87,10 @@ class Model
         void delete_objects();
 
         void print_status();
-        void calc_stats(std::string);
+        void calc_stats();
         void set_time_step();
+        void update_trans(); ///< Reset the Galilean transformation velocity to the mean wind.
+
+        unsigned long itransnext; ///< Integer time of the next update of the Galilean transformation.
 };
 #endif
@@ -0,0 +1,96 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2017 Chiel van Heerwaarden
+ * Copyright (c) 2011-2017 Thijs Heus
+ * Copyright (c) 2014-2017 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLICE_BALANCE
+#define SLICE_BALANCE
+
+#ifdef USEMPI
+#include <mpi.h>
+#endif
+#include <vector>
+
+class Master;
+class Grid;
+
+/**
+ * Class for the load balancing of column physics.
+ * Physics that only couples the levels of a column, such as the microphysics, are
+ * computed per xz-slice. Because clouds and rain are concentrated on a few processes,
+ * the cost per process can differ strongly. This class measures the cost per slice and
+ * periodically makes a plan in which processes on the same node with the highest cost
+ * send slices to processes with the lowest cost. The receiving process computes the
+ * slice from a copy of the fields and returns the result, so the results do not depend
+ * on the plan. Without MPI, all slices are computed locally.
+ */
+class Slice_balance
+{
+    public:
+        Slice_balance(Master*, Grid*); ///< Constructor of the slice balance class.
+        ~Slice_balance();              ///< Destructor of the slice balance class.
+
+        void init(int, int); ///< Set the number of fields that is sent with a slice and the number that is returned.
+        void update_plan();  ///< Redistribute the slices over the processes of a node, based on the measured cost.
+
+        void add_cost(int, double);          ///< Add the measured cost of a local slice.
+        void set_imported_cost(int, double); ///< Set the measured cost of an imported slice.
+
+        bool is_exported(int);                    ///< Check whether a local slice is computed by another process.
+        int get_nimported();                      ///< Get the number of slices computed for other processes.
+        double* get_imported_field(int, int);     ///< Get a field of an imported slice, with the layout of an xz-slice.
+
+        void send_slices(double* const*);         ///< Send the exported slices and start receiving the imported slices.
+        void wait_imported();                     ///< Wait until the imported slices have arrived.
+        void return_slices();                     ///< Return the results of the imported slices.
+        void receive_slices(double* const*);      ///< Copy the results of the exported slices into the fields.
+
+    private:
+        Master* master; ///< Pointer to master class.
+        Grid*   grid;   ///< Pointer to grid class.
+
+        int nin;        ///< Number of fields that is sent with a slice.
+        int nout;       ///< Number of fields that is returned, these are the first fields.
+        int nslice;     ///< Number of values of one field of a slice.
+
+        double* cost;   ///< Measured cost per local slice since the last plan.
+
+        std::vector<int> export_j;    ///< Local slices that are computed by another process.
+        std::vector<int> export_dest; ///< Process that computes the exported slice.
+        std::vector<int> import_j;    ///< Slice index at the source of the imported slices.
+        std::vector<int> import_src;  ///< Process that owns the imported slice.
+        bool* exported;               ///< Flag per local slice whether it is exported.
+
+        double* sendbuf;   ///< Exported slices, preceded by a slot for the cost.
+        double* retbuf;    ///< Results of the exported slices.
+        double* importbuf; ///< Imported slices, preceded by a slot for the cost.
+
+#ifdef USEMPI
+        MPI_Comm commnode; ///< Communicator of the processes on the same node.
+        int nodeid;        ///< Rank in the node communicator.
+        int nnode;         ///< Number of processes in the node communicator.
+
+        std::vector<MPI_Request> sendreqs;
+        std::vector<MPI_Request> importreqs;
+        std::vector<MPI_Request> returnreqs;
+        std::vector<MPI_Request> resultreqs;
+#endif
+};
+#endif
@@ -25,6 +25,8 @@
 
 //#include <netcdfcpp.h>
 #include <netcdf>
+#include <vector>
+#include <cstdint>
 using namespace netCDF;
 
 class Master;
@@ -37,6 +39,9 @@ struct Prof_var
 {
     NcVar ncvar;
     double* data;
+    double* sum;      ///< Sum of the samples of the time average.
+    int* nsamples;    ///< Number of samples of the time average.
+    bool partial;     ///< The data is the contribution of this process only.
 };
 
 // struct for time series
@@ -44,16 +49,58 @@ struct Time_series_var
 {
     NcVar ncvar;
     double data;
+    double sum;
+    int nsamples;
+    bool partial;
 };
 
-// typedefs for containers of profiles and time series
+// struct for histograms per height level
+struct Hist_var
+{
+    NcVar ncvar;
+    std::vector<std::string> vars; ///< Variable along each bin dimension of the histogram.
+    int nbins;    ///< Total number of bins at one level.
+    double* data; ///< Number of cells in each bin, summed over the samples of this process.
+    double* nsum; ///< Number of cells in the mask, summed over the samples.
+};
+
+// struct for the bins of a histogram variable
+struct Hist_bins
+{
+    double min;
+    double max;
+    int nbins;
+    std::string type; ///< Bin the value or the deviation from the horizontal mean.
+};
+
+// struct for the horizontal autocorrelations of a variable
+struct Corr_var
+{
+    NcVar ncvarx;
+    NcVar ncvary;
+    NcVar ncvarlx;
+    NcVar ncvarly;
+    double* covx; ///< Autocovariance in the x-direction, summed over the rows and samples of this process.
+    double* covy; ///< Autocovariance in the y-direction, summed over the rows and samples of this process.
+    double* lx;   ///< Integral length scale in the x-direction.
+    double* ly;   ///< Integral length scale in the y-direction.
+};
+
+// typedefs for containers of profiles, time series and histograms
 typedef std::map<std::string, Prof_var> Prof_map;
 typedef std::map<std::string, Time_series_var> Time_series_map;
+typedef std::map<std::string, Hist_var> Hist_map;
 
 // structure
 struct Mask
 {
     std::string name;
+    uint64_t* mfield;    ///< Packed mask at the full levels, one bit per grid cell.
+    uint64_t* mfieldh;   ///< Packed mask at the half levels.
+    uint64_t* mfieldbot; ///< Packed mask at the surface.
+    int* nmask;
+    int* nmaskh;
+    int nmaskbot;
     NcFile* dataFile;
     NcDim z_dim;
     NcDim zh_dim;
@@ -61,7 +108,10 @@ struct Mask
     NcVar iter_var;
     NcVar t_var;
     Prof_map profs;
+    Prof_map tmp_profs;
     Time_series_map tseries;
+    Hist_map hists;
+    std::map<std::string, NcDim> bin_dims;
 };
 
 typedef std::map<std::string, Mask> Mask_map;
@@ -76,58 +126,108 @@ class Stats
         void create(int);
 
         unsigned long get_time_limit(unsigned long);
-        void get_mask(Field3d*, Field3d*, Mask*);
+        void reset_masks();
+        void get_mask(Mask*);
+        void count_masks();
         void exec(int, double, unsigned long);
         bool doStats();
         std::string get_switch();
 
         // Container for all stats, masks as uppermost in hierarchy
         Mask_map masks;
-        int* nmask;
-        int* nmaskh;
-        int nmaskbot;
+
+        // Set or get the bit of cell (i,j,k) of a packed mask, use k=0 for the surface mask.
+        // The bits of a row along x are stored in words of 64 bits, including the ghost cells.
+        inline void set_mask_bit(uint64_t* const mask, const int i, const int j, const int k)
+        {
+            mask[i/64 + (j + k*mjcells)*mwords] |= (uint64_t)1 << (i%64);
+        }
+
+        inline bool get_mask_bit(const uint64_t* const mask, const int i, const int j, const int k)
+        {
+            return (mask[i/64 + (j + k*mjcells)*mwords] >> (i%64)) & 1;
+        }
 
         // Interface functions.
         void add_mask(const std::string);
         void add_prof(std::string, std::string, std::string, std::string);
+        void add_tmp_prof(std::string);
         void add_fixed_prof(std::string, std::string, std::string, std::string, double*);
         void add_time_series(std::string, std::string, std::string);
 
-        void calc_area(double*, const int[3], int*);
+        // The statistics are computed for all masks at once, the
+        // result is stored in the profile with the given name of each mask.
+        void calc_area(std::string, const int[3]);
 
-        void calc_mean(double* const, const double* const,
-                       const double, const int[3],
-                       const double* const, const int* const);
+        void calc_mean(std::string, const double* const,
+                       const double, const int[3]);
 
-        void calc_mean2d(double* const, const double* const,
-                         const double,
-                         const double* const, const int* const);
+        void calc_mean2d(std::string, const double* const,
+                         const double);
 
-        void calc_moment  (double*, double*, double*, double, const int[3], double*, int*);
+        void calc_moment  (double*, std::string, std::string, double, const int[3]);
+        void calc_moments (double*, std::string, std::string, const int[3]);
 
-        void calc_diff_2nd(double*, double*, double*, double, const int[3], double*, int*);
-        void calc_diff_2nd(double*, double*, double*, double*, double*,
-                           double*, double*, double, const int[3], double*, int*);
-        void calc_diff_4th(double*, double*, double*, double, const int[3], double*, int*);
+        void calc_diff_2nd(double*, std::string, double*, double, const int[3]);
+        void calc_diff_2nd(double*, double*, double*, std::string, double*,
+                           double*, double*, double, const int[3]);
+        void calc_diff_4th(double*, std::string, double*, double, const int[3]);
 
-        void calc_grad_2nd(double*, double*, double*, const int[3], double*, int*);
-        void calc_grad_4th(double*, double*, double*, const int[3], double*, int*);
+        void calc_grad_2nd(double*, std::string, double*, const int[3]);
+        void calc_grad_4th(double*, std::string, double*, const int[3]);
 
-        void calc_flux_2nd(double*, double*, double*, double*, double*, double*, const int[3], double*, int*);
-        void calc_flux_4th(double*, double*, double*, double*, const int[3], double*, int*);
+        void calc_flux_2nd(double*, std::string, double*, std::string, std::string, double*, const int[3]);
+        void calc_flux_4th(double*, double*, std::string, double*, const int[3]);
 
-        void add_fluxes   (double*, double*, double*);
-        void calc_count   (double*, double*, double, double*, int*);
-        void calc_path    (double*, double*, int*, double*);
-        void calc_cover   (double*, double*, int*, double*, double);
+        void add_fluxes   (std::string, std::string, std::string);
+        void calc_count   (double*, std::string, double);
+        void calc_path    (double*, std::string);
+        void calc_cover   (double*, std::string, double);
 
         void calc_sorted_prof(double*, double*, double*);
 
+        void calc_hists(); ///< Add the current sample to the histograms of all masks.
+        void calc_corrs(); ///< Add the current sample to the horizontal autocorrelations.
+
     private:
         int nstats;
 
+        // Packed mask fields of all masks, stored one after another.
+        uint64_t* mfield;
+        uint64_t* mfieldh;
+        uint64_t* mfieldbot;
+
+        int mwords;  ///< Number of words in a row of a packed mask.
+        int mjcells; ///< Number of rows in a level of a packed mask.
+        int msize;   ///< Number of words of a packed three-dimensional mask.
+
         // mask calculations
-        void calc_mask(double*, double*, double*, int*, int*, int*);
+        void calc_mask(uint64_t*, uint64_t*, uint64_t*);
+        bool get_weights(double*, const uint64_t*, int, int, int, const int[3]);
+
+        std::vector<Prof_var*> get_prof_vars(std::string);
+        std::vector<double*> get_profs(std::string);
+        void sum_profs(std::vector<double>&, std::string, bool);
+        void sum_profs(std::vector<double>&, const std::vector<std::string>&, bool);
+        void reduce_profs(std::vector<Prof_var*>&);
+        void accumulate_stats();
+        void average_stats();
+
+        // Histograms of one or two variables at the full levels.
+        std::vector<std::string> histlist;
+        std::map<std::string, Hist_bins> histbins;
+
+        void add_hists();
+        void reduce_hists();
+        void get_center_field(double*, std::string);
+
+        // Horizontal autocorrelations and integral length scales of the full domain.
+        std::vector<std::string> corrlist;
+        std::map<std::string, Corr_var> corrs;
+        int ncorrsamples;
+
+        void add_corrs();
+        void reduce_corrs();
 
     protected:
         Model*  model;
@@ -138,6 +238,11 @@ class Stats
         double sampletime;
         unsigned long isampletime;
 
+        // Time averaging of the samples between two outputs.
+        double averagetime;
+        unsigned long iaveragetime;
+        bool doaverage;
+
         std::string swstats;
 
         static const int nthres = 0;
@@ -0,0 +1,59 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2017 Chiel van Heerwaarden
+ * Copyright (c) 2011-2017 Thijs Heus
+ * Copyright (c) 2014-2017 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TENDENCY
+#define TENDENCY
+
+#include <string>
+
+class Master;
+class Input;
+class Model;
+class Grid;
+
+/**
+ * Class for the fused tendency sweep.
+ * Instead of letting advection, diffusion, buoyancy and buffer damping make a full
+ * pass over the tendency arrays each, this class walks once through the domain in
+ * blocks of vertical levels and applies all four operators on a block before moving
+ * on, so that the fields of a block are reused from cache. The operators use their
+ * own kernels restricted to the block, so the numerics are unchanged.
+ */
+class Tendency
+{
+    public:
+        Tendency(Model*, Input*); ///< Constructor of the tendency class.
+        ~Tendency();              ///< Destructor of the tendency class.
+
+        std::string get_switch(); ///< Retrieve the switch of the fused sweep.
+
+        void exec(); ///< Calculate the advection, diffusion, buoyancy and buffer tendencies in a single sweep.
+
+    private:
+        Master* master; ///< Pointer to master class.
+        Model*  model;  ///< Pointer to model class.
+        Grid*   grid;   ///< Pointer to grid class.
+
+        std::string swfused; ///< Switch for the fused tendency sweep.
+        int kblock;          ///< Number of vertical levels per block in the fused sweep.
+};
+#endif
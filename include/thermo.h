@@ -48,11 +48,16 @@ class Thermo
         virtual void exec() = 0;
         virtual unsigned long get_time_limit(unsigned long, double) = 0;
 
-        virtual void exec_stats(Mask*) = 0;
+        // Functions for the fused tendency sweep, in which the buoyancy is computed per block of levels.
+        virtual void prepare_block_sweep() {}  ///< Execute the column operations needed before the sweep.
+        virtual void exec_block(int, int);    ///< Add the buoyancy tendency for a block of vertical levels.
+        virtual void finish_block_sweep() {}   ///< Execute the column operations that follow the sweep.
+
+        virtual void exec_stats() = 0;
         virtual void exec_cross() = 0;
         virtual void exec_dump() = 0;
 
-        virtual void get_mask(Field3d*, Field3d*, Mask*) = 0;
+        virtual void get_mask(Mask*) = 0;
 
         // Interfacing functions to get buoyancy properties from other classes.
         virtual bool check_field_exists(std::string name) = 0;
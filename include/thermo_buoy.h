@@ -54,10 +54,10 @@ class Thermo_buoy : public Thermo
         // Empty functions that are allowed to pass.
         void init() {}
         void create(Input*) {}
-        void exec_stats(Mask*) {}
+        void exec_stats() {}
         void exec_cross() {}
         void exec_dump() {}
-        void get_mask(Field3d*, Field3d*, Mask*) {}
+        void get_mask(Mask*) {}
         
 #ifdef USECUDA
     void prepare_device() {};
@@ -42,10 +42,11 @@ class Thermo_disabled : public Thermo
         void init() {}
         void create(Input*) {}
         void exec() {}
-        void exec_stats(Mask*) {}
+        void exec_block(int, int) {}
+        void exec_stats() {}
         void exec_cross() {}
         void exec_dump() {}
-        void get_mask(Field3d*, Field3d*, Mask*) {}
+        void get_mask(Mask*) {}
         void get_prog_vars(std::vector<std::string>*) {}
         double get_buoyancy_diffusivity();
 
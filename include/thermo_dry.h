@@ -45,10 +45,11 @@ class Thermo_dry : public Thermo
         void init();
         void create(Input*);
         void exec();                ///< Add the tendencies belonging to the buoyancy.
+        void exec_block(int, int);  ///< Add the buoyancy tendency for a block of vertical levels.
         unsigned long get_time_limit(unsigned long, double); ///< Compute the time limit (n/a for thermo_dry)
 
 
-        void exec_stats(Mask*);
+        void exec_stats();
         void exec_cross();
         void exec_dump();
 
@@ -66,7 +67,7 @@ class Thermo_dry : public Thermo
 #endif
 
         // Empty functions that are allowed to pass.
-        void get_mask(Field3d*, Field3d*, Mask*) {}
+        void get_mask(Mask*) {}
 
     private:
         void init_stat();  ///< Initialize the thermo statistics
@@ -85,7 +86,7 @@ class Thermo_dry : public Thermo
                                double *, double *,
                                double *, double *); ///< Calculation of the near-surface and surface buoyancy.
         void calc_buoyancy_fluxbot(double *, double *, double *);  ///< Calculation of the buoyancy flux at the bottom.
-        void calc_buoyancy_tend_2nd(double *, double *, double *); ///< Calculation of the buoyancy tendency with 2nd order accuracy.
+        void calc_buoyancy_tend_2nd(double *, double *, double *, int, int); ///< Calculation of the buoyancy tendency with 2nd order accuracy.
         void calc_buoyancy_tend_4th(double *, double *, double *); ///< Calculation of the buoyancy tendency with 4th order accuracy.
 
         void calc_base_state(double *, double *, double *, double *, double *, double *, double *, double *, double); ///< For anelastic setup, calculate base state from initial input profiles
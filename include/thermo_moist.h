@@ -23,12 +23,14 @@
 #ifndef THERMO_MOIST
 #define THERMO_MOIST
 
+#include <cstdint>
 #include "thermo.h"
 
 class Master;
 class Grid;
 class Fields;
 class Stats;
+class Slice_balance;
 struct Mask;
 
 class Thermo_moist : public Thermo
@@ -40,10 +42,13 @@ class Thermo_moist : public Thermo
         void init();
         void create(Input*);
         void exec();
+        void prepare_block_sweep();
+        void exec_block(int, int);
+        void finish_block_sweep();
         unsigned long get_time_limit(unsigned long, double); ///< Compute the time limit (only for sw_micro=1)
 
-        void get_mask(Field3d*, Field3d*, Mask*);
-        void exec_stats(Mask*);
+        void get_mask(Mask*);
+        void exec_stats();
         void exec_cross();
         void exec_dump();
 
@@ -77,18 +82,22 @@ class Thermo_moist : public Thermo
         Stats *stats;
 
         // masks
-        void calc_mask_ql    (double*, double*, double*, int *, int *, int *, double*);
-        void calc_mask_qlcore(double*, double*, double*, int *, int *, int *, double*, double*, double*);
+        void calc_mask_ql    (uint64_t*, uint64_t*, uint64_t*, double*);
+        void calc_mask_qlcore(uint64_t*, uint64_t*, uint64_t*, double*, double*, double*);
 
-        void calc_buoyancy_tend_2nd(double*, double*, double*, double*, double*, double*, double*, double*);
+        void calc_buoyancy_tend_2nd(double*, double*, double*, double*, double*, double*, double*, double*, int, int);
         void calc_buoyancy_tend_4th(double*, double*, double*, double*, double*, double*, double*, double*);
 
-        void calc_buoyancy(double*, double*, double*, double*, double*, double*);
+        void calc_buoyancy(double*, double*, double*, double*, double*, double*, double*);
         void calc_N2(double*, double*, double*, double*); ///< Calculation of the Brunt-Vaissala frequency.
         void calc_base_state(double*, double*, double*, double*, double*, double*, double*, double*, double*, double*);
+        bool update_base_state(); ///< Update pref and exnref if the mean state has changed sufficiently.
 
         void calc_maximum_thv_perturbation_cloud(double*, double*, double*, double*, double*, double*, double*);
         void calc_liquid_water(double*, double*, double*, double*);
+
+        double* get_liquid_water();        ///< Get the cached liquid water field of the current state.
+        void    copy_liquid_water(double*); ///< Copy the cached liquid water field into a field.
         void calc_buoyancy_bot(double*, double*,
                                double*, double*,
                                double*, double*,
@@ -109,6 +118,25 @@ class Thermo_moist : public Thermo
         double* pref;
         double* prefh;
 
+        // Update policy of the base state for swupdatebasestate=1
+        double basestatetime;           ///< Minimum time between two updates of the base state
+        double basestatetol;            ///< Minimum change of the mean thv that triggers an update
+        double* thvmean_basestate;      ///< Mean thv at the last update of the base state
+        unsigned long basestate_itime;  ///< Time of the last update of the base state
+        bool basestate_valid;
+
+        // Cache of the liquid water field, which is valid for the state of the prognostic
+        // fields at the time and substep at which it was computed, and for the pressure profile.
+        double* ql_cache;
+        double* ql_cache_pref;
+        bool ql_cache_valid;
+        unsigned long ql_cache_itime;
+        int ql_cache_substep;
+
+        // Work arrays of the saturation adjustment of a horizontal slice.
+        int*    sat_index;
+        double* sat_work;
+
         // GPU functions and variables
         double* thvref_g; 
         double* thvrefh_g;
@@ -121,7 +149,21 @@ class Thermo_moist : public Thermo
         std::string swmicro; ///< Microphysics scheme
         std::string swmicrobudget; ///< Calculate budget statistics
         double cflmax_micro; ///< Maximum allowed CFL for sedimentation.
+        std::string swmicrosubcycle; ///< Sub-cycle the sedimentation instead of limiting the time step
+
+        // Load balancing of the microphysics over the processes of a node
+        std::string swbalance;  ///< Switch for the load balancing of the microphysics
+        int balanceiter;        ///< Number of iterations between two updates of the distribution
+        Slice_balance* balance;
+
+        // Table of the saturation vapor pressure
+        std::string swesattable; ///< Switch for the table of the saturation vapor pressure
+        double* esat_table;      ///< Saturation vapor pressure, 0 if the table is not used
+        void init_esat_table();  ///< Fill the table and check its accuracy
         void exec_microphysics();
+        void exec_microphysics_slice(double*, double*, double*, double*,
+                                     double*, double*, double*, double*, double*,
+                                     int, int, double); ///< Microphysics of one xz-slice
 
 };
 #endif
@@ -44,6 +44,7 @@ class Timeloop
         void set_time_step_limit();
         void set_time_step_limit(unsigned long);
         double get_sub_time_step();
+        double get_stage_time_step(); ///< Time interval covered by the substep that has just been integrated.
 
         void exec();
 
@@ -67,6 +68,7 @@ class Timeloop
         unsigned long get_idt()   { return idt;   }
         int get_iotime()    { return iotime;    }
         int get_iteration() { return iteration; }
+        int get_substep()   { return substep;   }
 
     private:
         Master* master;
@@ -81,8 +83,10 @@ class Timeloop
 
         int outputiter;
 
-        void rk3(double*, double*, double);
-        void rk4(double*, double*, double);
+        template<typename T>
+        void rk3(T* const*, double* const*, int, double);
+        template<typename T>
+        void rk4(T* const*, double* const*, int, double);
 
         double rk3subdt(double);
         double rk4subdt(double);
@@ -46,6 +46,7 @@ Advec::Advec(Model* modelin, Input* inputin)
 
     int nerror = 0;
     nerror += inputin->get_item(&cflmax, "advec", "cflmax", "", 1.);
+    nerror += inputin->get_item(&swfusedcfl, "advec", "swfusedcfl", "", "0");
 
     swadvec = "0";
 
@@ -60,9 +61,27 @@ Advec::~Advec()
 Advec* Advec::factory(Master* masterin, Input* inputin, Model* modelin, const std::string swspatialorder)
 {
     std::string swadvec;
-    if (inputin->get_item(&swadvec, "advec", "swadvec", "", swspatialorder))
+    std::string swfusedcfl;
+    int nerror = 0;
+    nerror += inputin->get_item(&swadvec, "advec", "swadvec", "", swspatialorder);
+    nerror += inputin->get_item(&swfusedcfl, "advec", "swfusedcfl", "", "0");
+    if (nerror)
         throw 1;
 
+    // The accumulation of the CFL number is only implemented in the 2nd order CPU kernels.
+    #ifdef USECUDA
+    if (swfusedcfl == "1")
+    {
+        masterin->print_error("swfusedcfl=1 is not supported on the GPU\n");
+        throw 1;
+    }
+    #endif
+    if (swfusedcfl == "1" && swadvec != "2")
+    {
+        masterin->print_error("swfusedcfl=1 is not supported for swadvec=%s\n", swadvec.c_str());
+        throw 1;
+    }
+
     if (swadvec == "0")
         return new Advec_disabled(modelin, inputin);
     else if (swadvec == "2")
@@ -80,6 +99,31 @@ Advec* Advec::factory(Master* masterin, Input* inputin, Model* modelin, const st
     }
 }
 
+void Advec::exec_block(const int kb, const int ke)
+{
+    master->print_error("swadvec=%s does not support the fused tendency sweep\n", swadvec.c_str());
+    throw 1;
+}
+
+bool Advec::has_fused_cfl()
+{
+    return swfusedcfl == "1";
+}
+
+double Advec::get_cfl_max_local()
+{
+    master->print_error("swadvec=%s does not support swfusedcfl=1\n", swadvec.c_str());
+    throw 1;
+}
+
+unsigned long Advec::get_time_limit_reduced(const unsigned long idt, const double dt, const double cflperdt)
+{
+    // Calculate cfl and prevent zero divisons.
+    double cfl = cflperdt*dt;
+    cfl = std::max(cflmin, cfl);
+    return idt * cflmax / cfl;
+}
+
 std::string Advec::get_switch()
 {
     return swadvec;
@@ -30,12 +30,16 @@
 #include "constants.h"
 #include "finite_difference.h"
 #include "model.h"
+#include "timeloop.h"
 
 using namespace Finite_difference::O2;
 
 Advec_2::Advec_2(Model* modelin, Input* inputin) : Advec(modelin, inputin)
 {
     swadvec = "2";
+
+    cfl_fused = 0.;
+    cfl_fused_valid = false;
 }
 
 Advec_2::~Advec_2()
@@ -58,20 +62,70 @@ unsigned long Advec_2::get_time_limit(unsigned long idt, double dt)
 
 void Advec_2::exec()
 {
-    advec_u(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
-            fields->rhoref, fields->rhorefh);
+    exec_block(grid->kstart, grid->kend);
+}
+#endif
+
+void Advec_2::exec_block(const int kb, const int ke)
+{
+    // Accumulate the CFL number in the first substep, in which the fields equal those
+    // for which the time step of the current step is determined.
+    if (swfusedcfl == "1" && !model->timeloop->in_substep())
+    {
+        if (kb == grid->kstart)
+            cfl_fused = 0.;
+
+        cfl_fused = std::max(cfl_fused,
+                             advec_u<true>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
+                                           fields->rhoref, fields->rhorefh, kb, ke));
+
+        if (ke == grid->kend)
+            cfl_fused_valid = true;
+    }
+    else
+        advec_u<false>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
+                       fields->rhoref, fields->rhorefh, kb, ke);
+
     advec_v(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
-            fields->rhoref, fields->rhorefh);
+            fields->rhoref, fields->rhorefh, kb, ke);
     advec_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi,
-            fields->rhoref, fields->rhorefh);
+            fields->rhoref, fields->rhorefh, kb, ke);
+
+    // packed scalars
+    if (!fields->sp.empty())
+        advec_s(fields->st_packed, fields->sp_packed, fields->sp.size(), fields->u->data, fields->v->data, fields->w->data,
+                grid->dzi, fields->rhoref, fields->rhorefh, kb, ke);
 
-    for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-        advec_s(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data,
-                grid->dzi, fields->rhoref, fields->rhorefh);
+    for (FieldMap::const_iterator it = fields->sts.begin(); it!=fields->sts.end(); it++)
+        advec_s(it->second->data, fields->sps[it->first]->data_single, 1, fields->u->data, fields->v->data, fields->w->data,
+                grid->dzi, fields->rhoref, fields->rhorefh, kb, ke);
+}
+
+double Advec_2::get_cfl_max_local()
+{
+    // Use the CFL number of the advection of the first substep if available, these
+    // are the same fields that the time step is computed for. Otherwise, compute it.
+    if (cfl_fused_valid)
+    {
+        cfl_fused_valid = false;
+        return cfl_fused;
+    }
+    else
+        return calc_cfl_local(fields->u->data, fields->v->data, fields->w->data, grid->dzi);
 }
-#endif
 
 double Advec_2::calc_cfl(double* restrict u, double* restrict v, double* restrict w, double* restrict dzi, double dt)
+{
+    double cfl = calc_cfl_local(u, v, w, dzi);
+
+    grid->get_max(&cfl);
+
+    cfl = cfl*dt;
+
+    return cfl;
+}
+
+double Advec_2::calc_cfl_local(double* restrict u, double* restrict v, double* restrict w, double* restrict dzi)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -91,15 +145,13 @@ double Advec_2::calc_cfl(double* restrict u, double* restrict v, double* restric
                 cfl = std::max(cfl, std::abs(interp2(u[ijk], u[ijk+ii]))*dxi + std::abs(interp2(v[ijk], v[ijk+jj]))*dyi + std::abs(interp2(w[ijk], w[ijk+kk]))*dzi[k]);
             }
 
-    grid->get_max(&cfl);
-
-    cfl = cfl*dt;
-
     return cfl;
 }
 
-void Advec_2::advec_u(double* restrict ut, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+template<bool calc_cfl>
+double Advec_2::advec_u(double* restrict ut, double* restrict u, double* restrict v, double* restrict w,
+                        double* restrict dzi, double* restrict rhoref, double* restrict rhorefh,
+                        const int kb, const int ke)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -108,7 +160,9 @@ void Advec_2::advec_u(double* restrict ut, double* restrict u, double* restrict
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart; k<grid->kend; ++k)
+    double cfl = 0;
+
+    for (int k=kb; k<ke; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -123,11 +177,18 @@ void Advec_2::advec_u(double* restrict ut, double* restrict u, double* restrict
 
                          - ( rhorefh[k+1] * interp2(w[ijk-ii+kk], w[ijk+kk]) * interp2(u[ijk   ], u[ijk+kk])
                            - rhorefh[k  ] * interp2(w[ijk-ii   ], w[ijk   ]) * interp2(u[ijk-kk], u[ijk   ]) ) / rhoref[k] * dzi[k];
+
+                // The velocities needed for the CFL number at the cell center are already loaded.
+                if (calc_cfl)
+                    cfl = std::max(cfl, std::abs(interp2(u[ijk], u[ijk+ii]))*dxi + std::abs(interp2(v[ijk], v[ijk+jj]))*dyi + std::abs(interp2(w[ijk], w[ijk+kk]))*dzi[k]);
             }
+
+    return cfl;
 }
 
 void Advec_2::advec_v(double* restrict vt, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh,
+                      const int kb, const int ke)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -136,7 +197,7 @@ void Advec_2::advec_v(double* restrict vt, double* restrict u, double* restrict
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart; k<grid->kend; ++k)
+    for (int k=kb; k<ke; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -155,7 +216,8 @@ void Advec_2::advec_v(double* restrict vt, double* restrict u, double* restrict
 }
 
 void Advec_2::advec_w(double* restrict wt, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzhi, double* restrict rhoref, double* restrict rhorefh)
+                      double* restrict dzhi, double* restrict rhoref, double* restrict rhorefh,
+                      const int kb, const int ke)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -164,7 +226,7 @@ void Advec_2::advec_w(double* restrict wt, double* restrict u, double* restrict
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
+    for (int k=std::max(kb, grid->kstart+1); k<ke; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -182,30 +244,35 @@ void Advec_2::advec_w(double* restrict wt, double* restrict u, double* restrict
             }
 }
 
-void Advec_2::advec_s(double* restrict st, double* restrict s, double* restrict u, double* restrict v, double* restrict w,
-                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
+template<typename T>
+void Advec_2::advec_s(double* restrict st, T* restrict s, const int ns, double* restrict u, double* restrict v, double* restrict w,
+                      double* restrict dzi, double* restrict rhoref, double* restrict rhorefh,
+                      const int kb, const int ke)
 {
     const int ii = 1;
     const int jj = grid->icells;
     const int kk = grid->ijcells;
+    const long nn = grid->ncells;
 
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    for (int k=grid->kstart; k<grid->kend; ++k)
+    for (int k=kb; k<ke; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
+            for (int n=0; n<ns; ++n)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj + k*kk;
-                st[ijk] +=
-                         - ( u[ijk+ii] * interp2(s[ijk   ], s[ijk+ii])
-                           - u[ijk   ] * interp2(s[ijk-ii], s[ijk   ]) ) * dxi
-
-                         - ( v[ijk+jj] * interp2(s[ijk   ], s[ijk+jj])
-                           - v[ijk   ] * interp2(s[ijk-jj], s[ijk   ]) ) * dyi
-
-                         - ( rhorefh[k+1] * w[ijk+kk] * interp2(s[ijk   ], s[ijk+kk])
-                           - rhorefh[k  ] * w[ijk   ] * interp2(s[ijk-kk], s[ijk   ]) ) / rhoref[k] * dzi[k];
-            }
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk  = i + j*jj + k*kk;
+                    const long ijkn = ijk + n*nn;
+                    st[ijkn] +=
+                             - ( u[ijk+ii] * interp2(s[ijkn   ], s[ijkn+ii])
+                               - u[ijk   ] * interp2(s[ijkn-ii], s[ijkn   ]) ) * dxi
+
+                             - ( v[ijk+jj] * interp2(s[ijkn   ], s[ijkn+jj])
+                               - v[ijk   ] * interp2(s[ijkn-jj], s[ijkn   ]) ) * dyi
+
+                             - ( rhorefh[k+1] * w[ijk+kk] * interp2(s[ijkn   ], s[ijkn+kk])
+                               - rhorefh[k  ] * w[ijk   ] * interp2(s[ijkn-kk], s[ijkn   ]) ) / rhoref[k] * dzi[k];
+                }
 }
@@ -76,8 +76,13 @@ void Advec_2i4::exec()
     advec_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi,
             fields->rhoref, fields->rhorefh);
 
-    for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-        advec_s(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
+    // packed scalars
+    if (!fields->sp.empty())
+        advec_s(fields->st_packed, fields->sp_packed, fields->sp.size(), fields->u->data, fields->v->data, fields->w->data, grid->dzi,
+                fields->rhoref, fields->rhorefh);
+
+    for (FieldMap::const_iterator it = fields->sts.begin(); it!=fields->sts.end(); it++)
+        advec_s(it->second->data, fields->sps[it->first]->data_single, 1, fields->u->data, fields->v->data, fields->w->data, grid->dzi,
                 fields->rhoref, fields->rhorefh);
 
 }
@@ -448,7 +453,8 @@ void Advec_2i4::advec_w(double* restrict wt, double* restrict u, double* restric
         }
 }
 
-void Advec_2i4::advec_s(double* restrict st, double* restrict s, double* restrict u, double* restrict v, double* restrict w,
+template<typename T>
+void Advec_2i4::advec_s(double* restrict st, T* restrict s, const int ns, double* restrict u, double* restrict v, double* restrict w,
                         double* restrict dzi, double* restrict rhoref, double* restrict rhorefh)
 {
     const int ii1 = 1;
@@ -457,6 +463,7 @@ void Advec_2i4::advec_s(double* restrict st, double* restrict s, double* restric
     const int jj2 = 2*grid->icells;
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
+    const long nn  = grid->ncells;
 
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
@@ -467,85 +474,95 @@ void Advec_2i4::advec_s(double* restrict st, double* restrict s, double* restric
     // assume that w at the boundary equals zero...
     int k = kstart;
     for (int j=grid->jstart; j<grid->jend; ++j)
+        for (int n=0; n<ns; ++n)
 #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
-        {
-            const int ijk = i + j*jj1 + k*kk1;
-            st[ijk] += 
-                     - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
-                       - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk  = i + j*jj1 + k*kk1;
+                const long ijkn = ijk + n*nn;
+                st[ijkn] += 
+                         - ( u[ijk+ii1] * interp4(s[ijkn-ii1], s[ijkn    ], s[ijkn+ii1], s[ijkn+ii2])
+                           - u[ijk    ] * interp4(s[ijkn-ii2], s[ijkn-ii1], s[ijkn    ], s[ijkn+ii1]) ) * dxi
 
-                     - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
-                       - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
+                         - ( v[ijk+jj1] * interp4(s[ijkn-jj1], s[ijkn    ], s[ijkn+jj1], s[ijkn+jj2])
+                           - v[ijk    ] * interp4(s[ijkn-jj2], s[ijkn-jj1], s[ijkn    ], s[ijkn+jj1]) ) * dyi 
 
-                     - ( rhorefh[k+1] * w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]) ) / rhoref[k] * dzi[k];
-        }
+                         - ( rhorefh[k+1] * w[ijk+kk1] * interp2(s[ijkn    ], s[ijkn+kk1]) ) / rhoref[k] * dzi[k];
+            }
 
     k = kstart+1;
     for (int j=grid->jstart; j<grid->jend; ++j)
+        for (int n=0; n<ns; ++n)
 #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
-        {
-            const int ijk = i + j*jj1 + k*kk1;
-            st[ijk] += 
-                     - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
-                       - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk  = i + j*jj1 + k*kk1;
+                const long ijkn = ijk + n*nn;
+                st[ijkn] += 
+                         - ( u[ijk+ii1] * interp4(s[ijkn-ii1], s[ijkn    ], s[ijkn+ii1], s[ijkn+ii2])
+                           - u[ijk    ] * interp4(s[ijkn-ii2], s[ijkn-ii1], s[ijkn    ], s[ijkn+ii1]) ) * dxi
 
-                     - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
-                       - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
+                         - ( v[ijk+jj1] * interp4(s[ijkn-jj1], s[ijkn    ], s[ijkn+jj1], s[ijkn+jj2])
+                           - v[ijk    ] * interp4(s[ijkn-jj2], s[ijkn-jj1], s[ijkn    ], s[ijkn+jj1]) ) * dyi 
 
-                     - ( rhorefh[k+1] * w[ijk+kk1] * interp4(s[ijk-kk1], s[ijk    ], s[ijk+kk1], s[ijk+kk2])
-                       - rhorefh[k  ] * w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]) ) / rhoref[k] * dzi[k];
-        }
+                         - ( rhorefh[k+1] * w[ijk+kk1] * interp4(s[ijkn-kk1], s[ijkn    ], s[ijkn+kk1], s[ijkn+kk2])
+                           - rhorefh[k  ] * w[ijk    ] * interp2(s[ijkn-kk1], s[ijkn    ]) ) / rhoref[k] * dzi[k];
+            }
 
     for (k=grid->kstart+2; k<grid->kend-2; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
+            for (int n=0; n<ns; ++n)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj1 + k*kk1;
-                st[ijk] += 
-                         - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
-                           - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk  = i + j*jj1 + k*kk1;
+                    const long ijkn = ijk + n*nn;
+                    st[ijkn] += 
+                             - ( u[ijk+ii1] * interp4(s[ijkn-ii1], s[ijkn    ], s[ijkn+ii1], s[ijkn+ii2])
+                               - u[ijk    ] * interp4(s[ijkn-ii2], s[ijkn-ii1], s[ijkn    ], s[ijkn+ii1]) ) * dxi
 
-                         - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
-                           - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
+                             - ( v[ijk+jj1] * interp4(s[ijkn-jj1], s[ijkn    ], s[ijkn+jj1], s[ijkn+jj2])
+                               - v[ijk    ] * interp4(s[ijkn-jj2], s[ijkn-jj1], s[ijkn    ], s[ijkn+jj1]) ) * dyi 
 
-                         - ( rhorefh[k+1] * w[ijk+kk1] * interp4(s[ijk-kk1], s[ijk    ], s[ijk+kk1], s[ijk+kk2])
-                           - rhorefh[k  ] * w[ijk    ] * interp4(s[ijk-kk2], s[ijk-kk1], s[ijk    ], s[ijk+kk1]) ) / rhoref[k] * dzi[k];
-            }
+                             - ( rhorefh[k+1] * w[ijk+kk1] * interp4(s[ijkn-kk1], s[ijkn    ], s[ijkn+kk1], s[ijkn+kk2])
+                               - rhorefh[k  ] * w[ijk    ] * interp4(s[ijkn-kk2], s[ijkn-kk1], s[ijkn    ], s[ijkn+kk1]) ) / rhoref[k] * dzi[k];
+                }
 
     k = kend-2;
     for (int j=grid->jstart; j<grid->jend; ++j)
+        for (int n=0; n<ns; ++n)
 #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
-        {
-            const int ijk = i + j*jj1 + k*kk1;
-            st[ijk] += 
-                     - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
-                       - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk  = i + j*jj1 + k*kk1;
+                const long ijkn = ijk + n*nn;
+                st[ijkn] += 
+                         - ( u[ijk+ii1] * interp4(s[ijkn-ii1], s[ijkn    ], s[ijkn+ii1], s[ijkn+ii2])
+                           - u[ijk    ] * interp4(s[ijkn-ii2], s[ijkn-ii1], s[ijkn    ], s[ijkn+ii1]) ) * dxi
 
-                     - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
-                       - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
+                         - ( v[ijk+jj1] * interp4(s[ijkn-jj1], s[ijkn    ], s[ijkn+jj1], s[ijkn+jj2])
+                           - v[ijk    ] * interp4(s[ijkn-jj2], s[ijkn-jj1], s[ijkn    ], s[ijkn+jj1]) ) * dyi 
 
-                     - ( rhorefh[k+1] * w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1])
-                       - rhorefh[k  ] * w[ijk    ] * interp4(s[ijk-kk2], s[ijk-kk1], s[ijk    ], s[ijk+kk1]) ) / rhoref[k] * dzi[k];
-        }
+                         - ( rhorefh[k+1] * w[ijk+kk1] * interp2(s[ijkn    ], s[ijkn+kk1])
+                           - rhorefh[k  ] * w[ijk    ] * interp4(s[ijkn-kk2], s[ijkn-kk1], s[ijkn    ], s[ijkn+kk1]) ) / rhoref[k] * dzi[k];
+            }
 
     // assume that w at the boundary equals zero...
     k = kend-1;
     for (int j=grid->jstart; j<grid->jend; ++j)
+        for (int n=0; n<ns; ++n)
 #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
-        {
-            const int ijk = i + j*jj1 + k*kk1;
-            st[ijk] += 
-                     - ( u[ijk+ii1] * interp4(s[ijk-ii1], s[ijk    ], s[ijk+ii1], s[ijk+ii2])
-                       - u[ijk    ] * interp4(s[ijk-ii2], s[ijk-ii1], s[ijk    ], s[ijk+ii1]) ) * dxi
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk  = i + j*jj1 + k*kk1;
+                const long ijkn = ijk + n*nn;
+                st[ijkn] += 
+                         - ( u[ijk+ii1] * interp4(s[ijkn-ii1], s[ijkn    ], s[ijkn+ii1], s[ijkn+ii2])
+                           - u[ijk    ] * interp4(s[ijkn-ii2], s[ijkn-ii1], s[ijkn    ], s[ijkn+ii1]) ) * dxi
 
-                     - ( v[ijk+jj1] * interp4(s[ijk-jj1], s[ijk    ], s[ijk+jj1], s[ijk+jj2])
-                       - v[ijk    ] * interp4(s[ijk-jj2], s[ijk-jj1], s[ijk    ], s[ijk+jj1]) ) * dyi 
+                         - ( v[ijk+jj1] * interp4(s[ijkn-jj1], s[ijkn    ], s[ijkn+jj1], s[ijkn+jj2])
+                           - v[ijk    ] * interp4(s[ijkn-jj2], s[ijkn-jj1], s[ijkn    ], s[ijkn+jj1]) ) * dyi 
 
-                     - (- rhorefh[k  ] * w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]) ) / rhoref[k] * dzi[k];
-        }
+                         - (- rhorefh[k  ] * w[ijk    ] * interp2(s[ijkn-kk1], s[ijkn    ]) ) / rhoref[k] * dzi[k];
+            }
 }
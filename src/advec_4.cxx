@@ -65,8 +65,12 @@ void Advec_4::exec()
         advec_u<false>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4 );
         advec_w<false>(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi4);
 
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-            advec_s<false>(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
+        // packed scalars
+        if (!fields->sp.empty())
+            advec_s<false>(fields->st_packed, fields->sp_packed, fields->sp.size(), fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
+
+        for (FieldMap::const_iterator it = fields->sts.begin(); it!=fields->sts.end(); it++)
+            advec_s<false>(it->second->data, fields->sps[it->first]->data_single, 1, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
     }
     else
     {
@@ -74,8 +78,12 @@ void Advec_4::exec()
         advec_v<true>(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4 );
         advec_w<true>(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi4);
 
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-            advec_s<true>(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
+        // packed scalars
+        if (!fields->sp.empty())
+            advec_s<true>(fields->st_packed, fields->sp_packed, fields->sp.size(), fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
+
+        for (FieldMap::const_iterator it = fields->sts.begin(); it!=fields->sts.end(); it++)
+            advec_s<true>(it->second->data, fields->sps[it->first]->data_single, 1, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
     }
 }
 #endif
@@ -406,8 +414,8 @@ void Advec_4::advec_w(double * restrict wt, double * restrict u, double * restri
         }
 }
 
-    template<bool dim3>
-void Advec_4::advec_s(double * restrict st, double * restrict s, double * restrict u, double * restrict v, double * restrict w, double * restrict dzi4)
+    template<bool dim3, typename T>
+void Advec_4::advec_s(double * restrict st, T * restrict s, const int ns, double * restrict u, double * restrict v, double * restrict w, double * restrict dzi4)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -418,6 +426,7 @@ void Advec_4::advec_s(double * restrict st, double * restrict s, double * restri
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
     const int kk3 = 3*grid->ijcells;
+    const long nn  = grid->ncells;
 
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
@@ -427,79 +436,85 @@ void Advec_4::advec_s(double * restrict st, double * restrict s, double * restri
 
     // bottom boundary
     for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
-        {
-            const int ijk = i + j*jj1 + kstart*kk1;
-            st[ijk] -= ( cg0*(u[ijk-ii1] * (ci0*s[ijk-ii3] + ci1*s[ijk-ii2] + ci2*s[ijk-ii1] + ci3*s[ijk    ]))
-                       + cg1*(u[ijk    ] * (ci0*s[ijk-ii2] + ci1*s[ijk-ii1] + ci2*s[ijk    ] + ci3*s[ijk+ii1]))
-                       + cg2*(u[ijk+ii1] * (ci0*s[ijk-ii1] + ci1*s[ijk    ] + ci2*s[ijk+ii1] + ci3*s[ijk+ii2]))
-                       + cg3*(u[ijk+ii2] * (ci0*s[ijk    ] + ci1*s[ijk+ii1] + ci2*s[ijk+ii2] + ci3*s[ijk+ii3])) ) * cgi*dxi;
-
-            if (dim3)
-            {
-                st[ijk] -= ( cg0*(v[ijk-jj1] * (ci0*s[ijk-jj3] + ci1*s[ijk-jj2] + ci2*s[ijk-jj1] + ci3*s[ijk    ]))
-                           + cg1*(v[ijk    ] * (ci0*s[ijk-jj2] + ci1*s[ijk-jj1] + ci2*s[ijk    ] + ci3*s[ijk+jj1]))
-                           + cg2*(v[ijk+jj1] * (ci0*s[ijk-jj1] + ci1*s[ijk    ] + ci2*s[ijk+jj1] + ci3*s[ijk+jj2]))
-                           + cg3*(v[ijk+jj2] * (ci0*s[ijk    ] + ci1*s[ijk+jj1] + ci2*s[ijk+jj2] + ci3*s[ijk+jj3])) ) * cgi*dyi;
-            }
-
-            st[ijk] -= ( cg0*(w[ijk-kk1] * (bi0*s[ijk-kk2] + bi1*s[ijk-kk1] + bi2*s[ijk    ] + bi3*s[ijk+kk1]))
-                       + cg1*(w[ijk    ] * (ci0*s[ijk-kk2] + ci1*s[ijk-kk1] + ci2*s[ijk    ] + ci3*s[ijk+kk1]))
-                       + cg2*(w[ijk+kk1] * (ci0*s[ijk-kk1] + ci1*s[ijk    ] + ci2*s[ijk+kk1] + ci3*s[ijk+kk2]))
-                       + cg3*(w[ijk+kk2] * (ci0*s[ijk    ] + ci1*s[ijk+kk1] + ci2*s[ijk+kk2] + ci3*s[ijk+kk3])) )
-                     * dzi4[kstart];
-        }
-
-    for (int k=grid->kstart+1; k<grid->kend-1; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
+        for (int n=0; n<ns; ++n)
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; i++)
             {
-                const int ijk = i + j*jj1 + k*kk1;
-                st[ijk] -= ( cg0*(u[ijk-ii1] * (ci0*s[ijk-ii3] + ci1*s[ijk-ii2] + ci2*s[ijk-ii1] + ci3*s[ijk    ]))
-                           + cg1*(u[ijk    ] * (ci0*s[ijk-ii2] + ci1*s[ijk-ii1] + ci2*s[ijk    ] + ci3*s[ijk+ii1]))
-                           + cg2*(u[ijk+ii1] * (ci0*s[ijk-ii1] + ci1*s[ijk    ] + ci2*s[ijk+ii1] + ci3*s[ijk+ii2]))
-                           + cg3*(u[ijk+ii2] * (ci0*s[ijk    ] + ci1*s[ijk+ii1] + ci2*s[ijk+ii2] + ci3*s[ijk+ii3])) ) * cgi*dxi;
+                const int ijk  = i + j*jj1 + kstart*kk1;
+                const long ijkn = ijk + n*nn;
+                st[ijkn] -= ( cg0*(u[ijk-ii1] * (ci0*s[ijkn-ii3] + ci1*s[ijkn-ii2] + ci2*s[ijkn-ii1] + ci3*s[ijkn    ]))
+                            + cg1*(u[ijk    ] * (ci0*s[ijkn-ii2] + ci1*s[ijkn-ii1] + ci2*s[ijkn    ] + ci3*s[ijkn+ii1]))
+                            + cg2*(u[ijk+ii1] * (ci0*s[ijkn-ii1] + ci1*s[ijkn    ] + ci2*s[ijkn+ii1] + ci3*s[ijkn+ii2]))
+                            + cg3*(u[ijk+ii2] * (ci0*s[ijkn    ] + ci1*s[ijkn+ii1] + ci2*s[ijkn+ii2] + ci3*s[ijkn+ii3])) ) * cgi*dxi;
 
                 if (dim3)
                 {
-                    st[ijk] -= ( cg0*(v[ijk-jj1] * (ci0*s[ijk-jj3] + ci1*s[ijk-jj2] + ci2*s[ijk-jj1] + ci3*s[ijk    ]))
-                               + cg1*(v[ijk    ] * (ci0*s[ijk-jj2] + ci1*s[ijk-jj1] + ci2*s[ijk    ] + ci3*s[ijk+jj1]))
-                               + cg2*(v[ijk+jj1] * (ci0*s[ijk-jj1] + ci1*s[ijk    ] + ci2*s[ijk+jj1] + ci3*s[ijk+jj2]))
-                               + cg3*(v[ijk+jj2] * (ci0*s[ijk    ] + ci1*s[ijk+jj1] + ci2*s[ijk+jj2] + ci3*s[ijk+jj3])) ) * cgi*dyi;
+                    st[ijkn] -= ( cg0*(v[ijk-jj1] * (ci0*s[ijkn-jj3] + ci1*s[ijkn-jj2] + ci2*s[ijkn-jj1] + ci3*s[ijkn    ]))
+                                + cg1*(v[ijk    ] * (ci0*s[ijkn-jj2] + ci1*s[ijkn-jj1] + ci2*s[ijkn    ] + ci3*s[ijkn+jj1]))
+                                + cg2*(v[ijk+jj1] * (ci0*s[ijkn-jj1] + ci1*s[ijkn    ] + ci2*s[ijkn+jj1] + ci3*s[ijkn+jj2]))
+                                + cg3*(v[ijk+jj2] * (ci0*s[ijkn    ] + ci1*s[ijkn+jj1] + ci2*s[ijkn+jj2] + ci3*s[ijkn+jj3])) ) * cgi*dyi;
                 }
 
-                st[ijk] -= ( cg0*(w[ijk-kk1] * (ci0*s[ijk-kk3] + ci1*s[ijk-kk2] + ci2*s[ijk-kk1] + ci3*s[ijk    ]))
-                           + cg1*(w[ijk    ] * (ci0*s[ijk-kk2] + ci1*s[ijk-kk1] + ci2*s[ijk    ] + ci3*s[ijk+kk1]))
-                           + cg2*(w[ijk+kk1] * (ci0*s[ijk-kk1] + ci1*s[ijk    ] + ci2*s[ijk+kk1] + ci3*s[ijk+kk2]))
-                           + cg3*(w[ijk+kk2] * (ci0*s[ijk    ] + ci1*s[ijk+kk1] + ci2*s[ijk+kk2] + ci3*s[ijk+kk3])) )
-                         * dzi4[k];
+                st[ijkn] -= ( cg0*(w[ijk-kk1] * (bi0*s[ijkn-kk2] + bi1*s[ijkn-kk1] + bi2*s[ijkn    ] + bi3*s[ijkn+kk1]))
+                            + cg1*(w[ijk    ] * (ci0*s[ijkn-kk2] + ci1*s[ijkn-kk1] + ci2*s[ijkn    ] + ci3*s[ijkn+kk1]))
+                            + cg2*(w[ijk+kk1] * (ci0*s[ijkn-kk1] + ci1*s[ijkn    ] + ci2*s[ijkn+kk1] + ci3*s[ijkn+kk2]))
+                            + cg3*(w[ijk+kk2] * (ci0*s[ijkn    ] + ci1*s[ijkn+kk1] + ci2*s[ijkn+kk2] + ci3*s[ijkn+kk3])) )
+                          * dzi4[kstart];
             }
 
+    for (int k=grid->kstart+1; k<grid->kend-1; k++)
+        for (int j=grid->jstart; j<grid->jend; j++)
+            for (int n=0; n<ns; ++n)
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; i++)
+                {
+                    const int ijk  = i + j*jj1 + k*kk1;
+                    const long ijkn = ijk + n*nn;
+                    st[ijkn] -= ( cg0*(u[ijk-ii1] * (ci0*s[ijkn-ii3] + ci1*s[ijkn-ii2] + ci2*s[ijkn-ii1] + ci3*s[ijkn    ]))
+                                + cg1*(u[ijk    ] * (ci0*s[ijkn-ii2] + ci1*s[ijkn-ii1] + ci2*s[ijkn    ] + ci3*s[ijkn+ii1]))
+                                + cg2*(u[ijk+ii1] * (ci0*s[ijkn-ii1] + ci1*s[ijkn    ] + ci2*s[ijkn+ii1] + ci3*s[ijkn+ii2]))
+                                + cg3*(u[ijk+ii2] * (ci0*s[ijkn    ] + ci1*s[ijkn+ii1] + ci2*s[ijkn+ii2] + ci3*s[ijkn+ii3])) ) * cgi*dxi;
+
+                    if (dim3)
+                    {
+                        st[ijkn] -= ( cg0*(v[ijk-jj1] * (ci0*s[ijkn-jj3] + ci1*s[ijkn-jj2] + ci2*s[ijkn-jj1] + ci3*s[ijkn    ]))
+                                    + cg1*(v[ijk    ] * (ci0*s[ijkn-jj2] + ci1*s[ijkn-jj1] + ci2*s[ijkn    ] + ci3*s[ijkn+jj1]))
+                                    + cg2*(v[ijk+jj1] * (ci0*s[ijkn-jj1] + ci1*s[ijkn    ] + ci2*s[ijkn+jj1] + ci3*s[ijkn+jj2]))
+                                    + cg3*(v[ijk+jj2] * (ci0*s[ijkn    ] + ci1*s[ijkn+jj1] + ci2*s[ijkn+jj2] + ci3*s[ijkn+jj3])) ) * cgi*dyi;
+                    }
+
+                    st[ijkn] -= ( cg0*(w[ijk-kk1] * (ci0*s[ijkn-kk3] + ci1*s[ijkn-kk2] + ci2*s[ijkn-kk1] + ci3*s[ijkn    ]))
+                                + cg1*(w[ijk    ] * (ci0*s[ijkn-kk2] + ci1*s[ijkn-kk1] + ci2*s[ijkn    ] + ci3*s[ijkn+kk1]))
+                                + cg2*(w[ijk+kk1] * (ci0*s[ijkn-kk1] + ci1*s[ijkn    ] + ci2*s[ijkn+kk1] + ci3*s[ijkn+kk2]))
+                                + cg3*(w[ijk+kk2] * (ci0*s[ijkn    ] + ci1*s[ijkn+kk1] + ci2*s[ijkn+kk2] + ci3*s[ijkn+kk3])) )
+                              * dzi4[k];
+                }
+
     // top boundary
     for (int j=grid->jstart; j<grid->jend; j++)
+        for (int n=0; n<ns; ++n)
 #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
-        {
-            const int ijk = i + j*jj1 + (kend-1)*kk1;
-            st[ijk] -= ( cg0*(u[ijk-ii1] * (ci0*s[ijk-ii3] + ci1*s[ijk-ii2] + ci2*s[ijk-ii1] + ci3*s[ijk    ]))
-                       + cg1*(u[ijk    ] * (ci0*s[ijk-ii2] + ci1*s[ijk-ii1] + ci2*s[ijk    ] + ci3*s[ijk+ii1]))
-                       + cg2*(u[ijk+ii1] * (ci0*s[ijk-ii1] + ci1*s[ijk    ] + ci2*s[ijk+ii1] + ci3*s[ijk+ii2]))
-                       + cg3*(u[ijk+ii2] * (ci0*s[ijk    ] + ci1*s[ijk+ii1] + ci2*s[ijk+ii2] + ci3*s[ijk+ii3])) ) * cgi*dxi;
-
-            if (dim3)
+            for (int i=grid->istart; i<grid->iend; i++)
             {
-                st[ijk] -= ( cg0*(v[ijk-jj1] * (ci0*s[ijk-jj3] + ci1*s[ijk-jj2] + ci2*s[ijk-jj1] + ci3*s[ijk    ]))
-                           + cg1*(v[ijk    ] * (ci0*s[ijk-jj2] + ci1*s[ijk-jj1] + ci2*s[ijk    ] + ci3*s[ijk+jj1]))
-                           + cg2*(v[ijk+jj1] * (ci0*s[ijk-jj1] + ci1*s[ijk    ] + ci2*s[ijk+jj1] + ci3*s[ijk+jj2]))
-                           + cg3*(v[ijk+jj2] * (ci0*s[ijk    ] + ci1*s[ijk+jj1] + ci2*s[ijk+jj2] + ci3*s[ijk+jj3])) ) * cgi*dyi;
-            }
+                const int ijk  = i + j*jj1 + (kend-1)*kk1;
+                const long ijkn = ijk + n*nn;
+                st[ijkn] -= ( cg0*(u[ijk-ii1] * (ci0*s[ijkn-ii3] + ci1*s[ijkn-ii2] + ci2*s[ijkn-ii1] + ci3*s[ijkn    ]))
+                            + cg1*(u[ijk    ] * (ci0*s[ijkn-ii2] + ci1*s[ijkn-ii1] + ci2*s[ijkn    ] + ci3*s[ijkn+ii1]))
+                            + cg2*(u[ijk+ii1] * (ci0*s[ijkn-ii1] + ci1*s[ijkn    ] + ci2*s[ijkn+ii1] + ci3*s[ijkn+ii2]))
+                            + cg3*(u[ijk+ii2] * (ci0*s[ijkn    ] + ci1*s[ijkn+ii1] + ci2*s[ijkn+ii2] + ci3*s[ijkn+ii3])) ) * cgi*dxi;
 
-            st[ijk] -= ( cg0*(w[ijk-kk1] * (ci0*s[ijk-kk3] + ci1*s[ijk-kk2] + ci2*s[ijk-kk1] + ci3*s[ijk    ]))
-                       + cg1*(w[ijk    ] * (ci0*s[ijk-kk2] + ci1*s[ijk-kk1] + ci2*s[ijk    ] + ci3*s[ijk+kk1]))
-                       + cg2*(w[ijk+kk1] * (ci0*s[ijk-kk1] + ci1*s[ijk    ] + ci2*s[ijk+kk1] + ci3*s[ijk+kk2]))
-                       + cg3*(w[ijk+kk2] * (ti0*s[ijk-kk1] + ti1*s[ijk    ] + ti2*s[ijk+kk1] + ti3*s[ijk+kk2])) )
-                     * dzi4[kend-1];
-        }
+                if (dim3)
+                {
+                    st[ijkn] -= ( cg0*(v[ijk-jj1] * (ci0*s[ijkn-jj3] + ci1*s[ijkn-jj2] + ci2*s[ijkn-jj1] + ci3*s[ijkn    ]))
+                                + cg1*(v[ijk    ] * (ci0*s[ijkn-jj2] + ci1*s[ijkn-jj1] + ci2*s[ijkn    ] + ci3*s[ijkn+jj1]))
+                                + cg2*(v[ijk+jj1] * (ci0*s[ijkn-jj1] + ci1*s[ijkn    ] + ci2*s[ijkn+jj1] + ci3*s[ijkn+jj2]))
+                                + cg3*(v[ijk+jj2] * (ci0*s[ijkn    ] + ci1*s[ijkn+jj1] + ci2*s[ijkn+jj2] + ci3*s[ijkn+jj3])) ) * cgi*dyi;
+                }
+
+                st[ijkn] -= ( cg0*(w[ijk-kk1] * (ci0*s[ijkn-kk3] + ci1*s[ijkn-kk2] + ci2*s[ijkn-kk1] + ci3*s[ijkn    ]))
+                            + cg1*(w[ijk    ] * (ci0*s[ijkn-kk2] + ci1*s[ijkn-kk1] + ci2*s[ijkn    ] + ci3*s[ijkn+kk1]))
+                            + cg2*(w[ijk+kk1] * (ci0*s[ijkn-kk1] + ci1*s[ijkn    ] + ci2*s[ijkn+kk1] + ci3*s[ijkn+kk2]))
+                            + cg3*(w[ijk+kk2] * (ti0*s[ijkn-kk1] + ti1*s[ijkn    ] + ti2*s[ijkn+kk1] + ti3*s[ijkn+kk2])) )
+                          * dzi4[kend-1];
+            }
 }
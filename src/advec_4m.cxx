@@ -65,8 +65,12 @@ void Advec_4m::exec()
     advec_v(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4 );
     advec_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzhi4);
 
-    for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); ++it)
-        advec_s(it->second->data, fields->sp[it->first]->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
+    // packed scalars
+    if (!fields->sp.empty())
+        advec_s(fields->st_packed, fields->sp_packed, fields->sp.size(), fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
+
+    for (FieldMap::const_iterator it = fields->sts.begin(); it!=fields->sts.end(); ++it)
+        advec_s(it->second->data, fields->sps[it->first]->data_single, 1, fields->u->data, fields->v->data, fields->w->data, grid->dzi4);
 }
 #endif
 
@@ -377,7 +381,8 @@ interp4top(w[ijk-kk1], w[ijk    ], w[ijk+kk1], w[ijk+kk2]) * interp4top(w[ijk-kk
  */
 }
 
-void Advec_4m::advec_s(double * restrict st, double * restrict s, double * restrict u, double * restrict v, double * restrict w, double * restrict dzi4)
+template<typename T>
+void Advec_4m::advec_s(double * restrict st, T * restrict s, const int ns, double * restrict u, double * restrict v, double * restrict w, double * restrict dzi4)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -388,6 +393,7 @@ void Advec_4m::advec_s(double * restrict st, double * restrict s, double * restr
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
     const int kk3 = 3*grid->ijcells;
+    const long nn  = grid->ncells;
 
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
@@ -397,73 +403,79 @@ void Advec_4m::advec_s(double * restrict st, double * restrict s, double * restr
 
     // bottom boundary
     for (int j=grid->jstart; j<grid->jend; ++j)
+        for (int n=0; n<ns; ++n)
 #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
-        {
-            const int ijk = i + j*jj1 + kstart*kk1;
-            st[ijk] +=
-                     - grad4(u[ijk-ii1] * interp2(s[ijk-ii3], s[ijk    ]),
-                             u[ijk    ] * interp2(s[ijk-ii1], s[ijk    ]),
-                             u[ijk+ii1] * interp2(s[ijk    ], s[ijk+ii1]),
-                             u[ijk+ii2] * interp2(s[ijk    ], s[ijk+ii3]), dxi)
-
-                     - grad4(v[ijk-jj1] * interp2(s[ijk-jj3], s[ijk    ]),
-                             v[ijk    ] * interp2(s[ijk-jj1], s[ijk    ]),
-                             v[ijk+jj1] * interp2(s[ijk    ], s[ijk+jj1]),
-                             v[ijk+jj2] * interp2(s[ijk    ], s[ijk+jj3]), dyi)
-
-                     - grad4x(-w[ijk+kk1] * interp2(s[ijk-kk1], s[ijk+kk2]),
-                               w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]),
-                               w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]),
-                               w[ijk+kk2] * interp2(s[ijk    ], s[ijk+kk3])) 
-                       * dzi4[kstart];
-        }
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk  = i + j*jj1 + kstart*kk1;
+                const long ijkn = ijk + n*nn;
+                st[ijkn] +=
+                         - grad4(u[ijk-ii1] * interp2(s[ijkn-ii3], s[ijkn    ]),
+                                 u[ijk    ] * interp2(s[ijkn-ii1], s[ijkn    ]),
+                                 u[ijk+ii1] * interp2(s[ijkn    ], s[ijkn+ii1]),
+                                 u[ijk+ii2] * interp2(s[ijkn    ], s[ijkn+ii3]), dxi)
+
+                         - grad4(v[ijk-jj1] * interp2(s[ijkn-jj3], s[ijkn    ]),
+                                 v[ijk    ] * interp2(s[ijkn-jj1], s[ijkn    ]),
+                                 v[ijk+jj1] * interp2(s[ijkn    ], s[ijkn+jj1]),
+                                 v[ijk+jj2] * interp2(s[ijkn    ], s[ijkn+jj3]), dyi)
+
+                         - grad4x(-w[ijk+kk1] * interp2(s[ijkn-kk1], s[ijkn+kk2]),
+                                   w[ijk    ] * interp2(s[ijkn-kk1], s[ijkn    ]),
+                                   w[ijk+kk1] * interp2(s[ijkn    ], s[ijkn+kk1]),
+                                   w[ijk+kk2] * interp2(s[ijkn    ], s[ijkn+kk3])) 
+                           * dzi4[kstart];
+            }
 
     for (int k=grid->kstart+1; k<grid->kend-1; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
+            for (int n=0; n<ns; ++n)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ijk = i + j*jj1 + k*kk1;
-                st[ijk] +=
-                         - grad4(u[ijk-ii1] * interp2(s[ijk-ii3], s[ijk    ]),
-                                 u[ijk    ] * interp2(s[ijk-ii1], s[ijk    ]),
-                                 u[ijk+ii1] * interp2(s[ijk    ], s[ijk+ii1]),
-                                 u[ijk+ii2] * interp2(s[ijk    ], s[ijk+ii3]), dxi)
-
-                         - grad4(v[ijk-jj1] * interp2(s[ijk-jj3], s[ijk    ]),
-                                 v[ijk    ] * interp2(s[ijk-jj1], s[ijk    ]),
-                                 v[ijk+jj1] * interp2(s[ijk    ], s[ijk+jj1]),
-                                 v[ijk+jj2] * interp2(s[ijk    ], s[ijk+jj3]), dyi)
-
-                         - grad4x(w[ijk-kk1] * interp2(s[ijk-kk3], s[ijk    ]),
-                                  w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]),
-                                  w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]),
-                                  w[ijk+kk2] * interp2(s[ijk    ], s[ijk+kk3])) 
-                           * dzi4[k];
-            }
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk  = i + j*jj1 + k*kk1;
+                    const long ijkn = ijk + n*nn;
+                    st[ijkn] +=
+                             - grad4(u[ijk-ii1] * interp2(s[ijkn-ii3], s[ijkn    ]),
+                                     u[ijk    ] * interp2(s[ijkn-ii1], s[ijkn    ]),
+                                     u[ijk+ii1] * interp2(s[ijkn    ], s[ijkn+ii1]),
+                                     u[ijk+ii2] * interp2(s[ijkn    ], s[ijkn+ii3]), dxi)
+
+                             - grad4(v[ijk-jj1] * interp2(s[ijkn-jj3], s[ijkn    ]),
+                                     v[ijk    ] * interp2(s[ijkn-jj1], s[ijkn    ]),
+                                     v[ijk+jj1] * interp2(s[ijkn    ], s[ijkn+jj1]),
+                                     v[ijk+jj2] * interp2(s[ijkn    ], s[ijkn+jj3]), dyi)
+
+                             - grad4x(w[ijk-kk1] * interp2(s[ijkn-kk3], s[ijkn    ]),
+                                      w[ijk    ] * interp2(s[ijkn-kk1], s[ijkn    ]),
+                                      w[ijk+kk1] * interp2(s[ijkn    ], s[ijkn+kk1]),
+                                      w[ijk+kk2] * interp2(s[ijkn    ], s[ijkn+kk3])) 
+                               * dzi4[k];
+                }
 
     // top boundary
     for (int j=grid->jstart; j<grid->jend; ++j)
+        for (int n=0; n<ns; ++n)
 #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
-        {
-            const int ijk = i + j*jj1 + (kend-1)*kk1;
-            st[ijk] +=
-                     - grad4(u[ijk-ii1] * interp2(s[ijk-ii3], s[ijk    ]),
-                             u[ijk    ] * interp2(s[ijk-ii1], s[ijk    ]),
-                             u[ijk+ii1] * interp2(s[ijk    ], s[ijk+ii1]),
-                             u[ijk+ii2] * interp2(s[ijk    ], s[ijk+ii3]), dxi)
-
-                     - grad4(v[ijk-jj1] * interp2(s[ijk-jj3], s[ijk    ]),
-                             v[ijk    ] * interp2(s[ijk-jj1], s[ijk    ]),
-                             v[ijk+jj1] * interp2(s[ijk    ], s[ijk+jj1]),
-                             v[ijk+jj2] * interp2(s[ijk    ], s[ijk+jj3]), dyi)
-
-                     - grad4x( w[ijk-kk1] * interp2(s[ijk-kk3], s[ijk    ]),
-                               w[ijk    ] * interp2(s[ijk-kk1], s[ijk    ]),
-                               w[ijk+kk1] * interp2(s[ijk    ], s[ijk+kk1]),
-                              -w[ijk    ] * interp2(s[ijk-kk2], s[ijk+kk1])) 
-                       * dzi4[kend-1];
-        }
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ijk  = i + j*jj1 + (kend-1)*kk1;
+                const long ijkn = ijk + n*nn;
+                st[ijkn] +=
+                         - grad4(u[ijk-ii1] * interp2(s[ijkn-ii3], s[ijkn    ]),
+                                 u[ijk    ] * interp2(s[ijkn-ii1], s[ijkn    ]),
+                                 u[ijk+ii1] * interp2(s[ijkn    ], s[ijkn+ii1]),
+                                 u[ijk+ii2] * interp2(s[ijkn    ], s[ijkn+ii3]), dxi)
+
+                         - grad4(v[ijk-jj1] * interp2(s[ijkn-jj3], s[ijkn    ]),
+                                 v[ijk    ] * interp2(s[ijkn-jj1], s[ijkn    ]),
+                                 v[ijk+jj1] * interp2(s[ijkn    ], s[ijkn+jj1]),
+                                 v[ijk+jj2] * interp2(s[ijkn    ], s[ijkn+jj3]), dyi)
+
+                         - grad4x( w[ijk-kk1] * interp2(s[ijkn-kk3], s[ijkn    ]),
+                                   w[ijk    ] * interp2(s[ijkn-kk1], s[ijkn    ]),
+                                   w[ijk+kk1] * interp2(s[ijkn    ], s[ijkn+kk1]),
+                                  -w[ijk    ] * interp2(s[ijkn-kk2], s[ijkn+kk1])) 
+                           * dzi4[kend-1];
+            }
 }
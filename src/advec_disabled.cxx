@@ -53,3 +53,7 @@ double Advec_disabled::get_cfl(const double dt)
 void Advec_disabled::exec()
 {
 }
+
+void Advec_disabled::exec_block(const int kb, const int ke)
+{
+}
@@ -30,6 +30,7 @@
 #include "defines.h"
 #include "model.h"
 #include "timeloop.h"
+#include "stats.h"
 #include "finite_difference.h"
 
 // Boundary schemes.
@@ -107,8 +108,8 @@ void Boundary::process_bcs(Input* inputin)
         nerror++;
     }
 
-    // read the boundaries per field
-    for (FieldMap::const_iterator it=fields->sp.begin(); it!=fields->sp.end(); ++it)
+    // read the boundaries per field, the single precision scalars are treated identically
+    for (FieldMap::const_iterator it=fields->spall.begin(); it!=fields->spall.end(); ++it)
     {
         sbc[it->first] = new Field3dBc;
         nerror += inputin->get_item(&swbot, "boundary", "sbcbot", it->first);
@@ -184,7 +185,7 @@ void Boundary::process_time_dependent(Input* inputin)
         std::vector<std::string> tmplist = timedeplist;
 
         // see if there is data available for the surface boundary conditions
-        for (FieldMap::const_iterator it=fields->sp.begin(); it!=fields->sp.end(); ++it)
+        for (FieldMap::const_iterator it=fields->spall.begin(); it!=fields->spall.end(); ++it)
         {
             std::string name = "sbot[" + it->first + "]";
             if (std::find(timedeplist.begin(), timedeplist.end(), name) != timedeplist.end()) 
@@ -212,16 +213,10 @@ void Boundary::update_time_dependent()
     if (swtimedep == "0")
         return;
 
-    // first find the index for the time entries
+    // first find the index for the time entries with a binary search on the sorted times
     unsigned int index0 = 0;
-    unsigned int index1 = 0;
-    for (std::vector<double>::const_iterator it=timedeptime.begin(); it!=timedeptime.end(); ++it)
-    {
-        if (model->timeloop->get_time() < *it)
-            break;
-        else
-            ++index1;
-    }
+    unsigned int index1 = std::upper_bound(timedeptime.begin(), timedeptime.end(), model->timeloop->get_time())
+                        - timedeptime.begin();
 
     // second, calculate the weighting factor
     double fac0, fac1;
@@ -250,7 +245,7 @@ void Boundary::update_time_dependent()
     }
 
     // process time dependent bcs for the surface fluxes
-    for (FieldMap::const_iterator it1=fields->sp.begin(); it1!=fields->sp.end(); ++it1)
+    for (FieldMap::const_iterator it1=fields->spall.begin(); it1!=fields->spall.end(); ++it1)
     {
         std::string name = "sbot[" + it1->first + "]";
         std::map<std::string, double *>::const_iterator it2 = timedepdata.find(name);
@@ -280,7 +275,7 @@ void Boundary::set_values()
     set_bc(fields->u->datatop, fields->u->datagradtop, fields->u->datafluxtop, mbctop, utop, fields->visc, grid->utrans);
     set_bc(fields->v->datatop, fields->v->datagradtop, fields->v->datafluxtop, mbctop, vtop, fields->visc, grid->vtrans);
 
-    for (FieldMap::const_iterator it=fields->sp.begin(); it!=fields->sp.end(); ++it)
+    for (FieldMap::const_iterator it=fields->spall.begin(); it!=fields->spall.end(); ++it)
     {
         set_bc(it->second->databot, it->second->datagradbot, it->second->datafluxbot, sbc[it->first]->bcbot, sbc[it->first]->bot, it->second->visc, noOffset);
         set_bc(it->second->datatop, it->second->datagradtop, it->second->datafluxtop, sbc[it->first]->bctop, sbc[it->first]->top, it->second->visc, noOffset);
@@ -298,6 +293,9 @@ void Boundary::exec()
     for (FieldMap::const_iterator it = fields->sp.begin(); it!=fields->sp.end(); ++it)
         grid->boundary_cyclic(it->second->data);
 
+    for (FieldMap::const_iterator it = fields->sps.begin(); it!=fields->sps.end(); ++it)
+        grid->boundary_cyclic(it->second->data_single);
+
     // Update the boundary values.
     update_bcs();
 
@@ -314,6 +312,12 @@ void Boundary::exec()
             calc_ghost_cells_bot_2nd(it->second->data, grid->dzh, sbc[it->first]->bcbot, it->second->databot, it->second->datagradbot);
             calc_ghost_cells_top_2nd(it->second->data, grid->dzh, sbc[it->first]->bctop, it->second->datatop, it->second->datagradtop);
         }
+
+        for (FieldMap::const_iterator it=fields->sps.begin(); it!=fields->sps.end(); ++it)
+        {
+            calc_ghost_cells_bot_2nd(it->second->data_single, grid->dzh, sbc[it->first]->bcbot, it->second->databot, it->second->datagradbot);
+            calc_ghost_cells_top_2nd(it->second->data_single, grid->dzh, sbc[it->first]->bctop, it->second->datatop, it->second->datagradtop);
+        }
     }
     else if (grid->swspatialorder == "4")
     {
@@ -331,6 +335,12 @@ void Boundary::exec()
             calc_ghost_cells_bot_4th(it->second->data, grid->z, sbc[it->first]->bcbot, it->second->databot, it->second->datagradbot);
             calc_ghost_cells_top_4th(it->second->data, grid->z, sbc[it->first]->bctop, it->second->datatop, it->second->datagradtop);
         }
+
+        for (FieldMap::const_iterator it=fields->sps.begin(); it!=fields->sps.end(); ++it)
+        {
+            calc_ghost_cells_bot_4th(it->second->data_single, grid->z, sbc[it->first]->bcbot, it->second->databot, it->second->datagradbot);
+            calc_ghost_cells_top_4th(it->second->data_single, grid->z, sbc[it->first]->bctop, it->second->datatop, it->second->datagradtop);
+        }
     }
 
     // Update the boundary fields that are a slave of the boundary condition.
@@ -359,16 +369,16 @@ void Boundary::exec_cross()
 {
 }
 
-void Boundary::exec_stats(Mask* m)
+void Boundary::exec_stats()
 {
 }
 
 // Computational kernel for boundary calculation.
 namespace
 {
-    template<int spatial_order>
+    template<int spatial_order, typename T>
     void calc_slave_bc_bot(double* const restrict abot, double* const restrict agradbot, double* const restrict afluxbot,
-                           const double* const restrict a,
+                           const T* const restrict a,
                            const Grid* const grid, const double* const restrict dzhi,
                            const Boundary::Boundary_type boundary_type, const double visc)
     {
@@ -432,6 +442,12 @@ void Boundary::update_slave_bcs()
                                  it->second->data,
                                  grid, grid->dzhi,
                                  sbc[it->first]->bcbot, it->second->visc);
+
+        for (FieldMap::const_iterator it=fields->sps.begin(); it!=fields->sps.end(); ++it)
+            calc_slave_bc_bot<2>(it->second->databot, it->second->datagradbot, it->second->datafluxbot,
+                                 it->second->data_single,
+                                 grid, grid->dzhi,
+                                 sbc[it->first]->bcbot, it->second->visc);
     }
     else if (grid->swspatialorder == "4")
     {
@@ -450,6 +466,12 @@ void Boundary::update_slave_bcs()
                                  it->second->data,
                                  grid, grid->dzhi4,
                                  sbc[it->first]->bcbot, it->second->visc);
+
+        for (FieldMap::const_iterator it=fields->sps.begin(); it!=fields->sps.end(); ++it)
+            calc_slave_bc_bot<4>(it->second->databot, it->second->datagradbot, it->second->datafluxbot,
+                                 it->second->data_single,
+                                 grid, grid->dzhi4,
+                                 sbc[it->first]->bcbot, it->second->visc);
     }
 }
 
@@ -520,7 +542,8 @@ void Boundary::set_bc(double* restrict a, double* restrict agrad, double* restri
 }
 
 // BOUNDARY CONDITIONS THAT CONTAIN A 2D PATTERN
-void Boundary::calc_ghost_cells_bot_2nd(double* restrict a, double* restrict dzh, Boundary_type boundary_type,
+template<typename T>
+void Boundary::calc_ghost_cells_bot_2nd(T* restrict a, double* restrict dzh, Boundary_type boundary_type,
                                         double* restrict abot, double* restrict agradbot)
 {
     int ij,ijk,jj,kk,kstart;
@@ -554,7 +577,8 @@ void Boundary::calc_ghost_cells_bot_2nd(double* restrict a, double* restrict dzh
     }
 }
 
-void Boundary::calc_ghost_cells_top_2nd(double* restrict a, double* restrict dzh, Boundary_type boundary_type,
+template<typename T>
+void Boundary::calc_ghost_cells_top_2nd(T* restrict a, double* restrict dzh, Boundary_type boundary_type,
                                         double* restrict atop, double* restrict agradtop)
 {
     int ij,ijk,jj,kk,kend;
@@ -588,7 +612,8 @@ void Boundary::calc_ghost_cells_top_2nd(double* restrict a, double* restrict dzh
     }
 }
 
-void Boundary::calc_ghost_cells_bot_4th(double* restrict a, double* restrict z, Boundary_type boundary_type,
+template<typename T>
+void Boundary::calc_ghost_cells_bot_4th(T* restrict a, double* restrict z, Boundary_type boundary_type,
                                         double* restrict abot, double* restrict agradbot)
 {
     int ij,ijk,jj,kk1,kk2,kstart;
@@ -627,7 +652,8 @@ void Boundary::calc_ghost_cells_bot_4th(double* restrict a, double* restrict z,
     }
 }
 
-void Boundary::calc_ghost_cells_top_4th(double* restrict a, double* restrict z, Boundary_type boundary_type,
+template<typename T>
+void Boundary::calc_ghost_cells_top_4th(T* restrict a, double* restrict z, Boundary_type boundary_type,
                                         double* restrict atop, double* restrict agradtop)
 {
     const int kend = grid->kend;
@@ -737,18 +763,10 @@ void Boundary::calc_ghost_cells_topw_4th(double* restrict w)
         }
 }
 
-void Boundary::get_mask(Field3d* field, Field3d* fieldh, Mask* m)
+void Boundary::get_mask(Mask* m)
 {
-    // Set surface mask
-    for (int i=0; i<grid->ijcells; ++i)
-        fieldh->databot[i] = 1;
-
-    // Set atmospheric mask
-    for (int i=0; i<grid->ncells; ++i)
-    {
-        field ->data[i] = 1;
-        fieldh->data[i] = 1;
-    }
+    // Without patches, the mask covers the whole domain
+    model->stats->get_mask(m);
 }
 
 void Boundary::get_surface_mask(Field3d* field)
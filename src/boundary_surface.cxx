@@ -43,6 +43,7 @@ namespace
     namespace most = Monin_obukhov;
     // Size of the lookup table.
     const int nzL = 10000; // Size of the lookup table for MO iterations.
+    const int nzL_bin_per_entry = 4; // Number of bins of the index table per entry of the lookup table.
 }
 
 Boundary_surface::Boundary_surface(Model* modelin, Input* inputin) : Boundary(modelin, inputin)
@@ -54,6 +55,7 @@ Boundary_surface::Boundary_surface(Model* modelin, Input* inputin) : Boundary(mo
     nobuk = 0;
     zL_sl = 0;
     f_sl  = 0;
+    zL_bin = 0;
 
 #ifdef USECUDA
     ustar_g = 0;
@@ -71,6 +73,7 @@ Boundary_surface::~Boundary_surface()
     delete[] nobuk;
     delete[] zL_sl;
     delete[] f_sl;
+    delete[] zL_bin;
 
 #ifdef USECUDA
     clear_device();
@@ -221,10 +224,10 @@ void Boundary_surface::exec_cross()
         throw 1;
 }
 
-void Boundary_surface::exec_stats(Mask *m)
+void Boundary_surface::exec_stats()
 {
-    stats->calc_mean2d(&m->tseries["obuk"].data , obuk , 0., fields->atmp["tmp4"]->databot, &stats->nmaskbot);
-    stats->calc_mean2d(&m->tseries["ustar"].data, ustar, 0., fields->atmp["tmp4"]->databot, &stats->nmaskbot);
+    stats->calc_mean2d("obuk" , obuk , 0.);
+    stats->calc_mean2d("ustar", ustar, 0.);
 }
 
 void Boundary_surface::set_values()
@@ -238,7 +241,7 @@ void Boundary_surface::set_values()
     set_bc(fields->u->datatop, fields->u->datagradtop, fields->u->datafluxtop, mbctop, utop, fields->visc, grid->utrans);
     set_bc(fields->v->datatop, fields->v->datagradtop, fields->v->datafluxtop, mbctop, vtop, fields->visc, grid->vtrans);
 
-    for (FieldMap::const_iterator it=fields->sp.begin(); it!=fields->sp.end(); ++it)
+    for (FieldMap::const_iterator it=fields->spall.begin(); it!=fields->spall.end(); ++it)
     {
         set_bc(it->second->databot, it->second->datagradbot, it->second->datafluxbot, sbc[it->first]->bcbot, sbc[it->first]->bot, it->second->visc, no_offset);
         set_bc(it->second->datatop, it->second->datagradtop, it->second->datafluxtop, sbc[it->first]->bctop, sbc[it->first]->top, it->second->visc, no_offset);
@@ -326,6 +329,37 @@ void Boundary_surface::init_solver()
         for (int n=0; n<nzL; ++n)
             f_sl[n] = zL_sl[n] * std::pow(most::fm(zsl, z0m, zsl/zL_sl[n]), 2) / most::fh(zsl, z0h, zsl/zL_sl[n]);
     }
+    else
+        return;
+
+    // Find the end of the part in which the evaluation function increases monotonically. In the stable
+    // limit the function can decrease again, in that case only the weakly stable branch is used.
+    nzL_mono = nzL-1;
+    for (int n=0; n<nzL-1; ++n)
+        if (f_sl[n+1] < f_sl[n])
+        {
+            nzL_mono = n;
+            break;
+        }
+
+    // Build an index table on a uniform grid of the evaluation function that covers the part of the
+    // lookup table with uniform spacing in z/L. Each bin stores the first entry of the lookup table
+    // that is not smaller than the lower bound of the bin, which inverts the table in O(1).
+    nzL_bin0  = nzL/10;
+    nzL_bin   = nzL_bin_per_entry*(nzL_mono - nzL_bin0);
+    f_bin0    = f_sl[nzL_bin0];
+    f_bin_idf = nzL_bin / (f_sl[nzL_mono] - f_sl[nzL_bin0]);
+
+    zL_bin = new int[nzL_bin+1];
+
+    int n = nzL_bin0;
+    for (int b=0; b<nzL_bin+1; ++b)
+    {
+        const float fb = f_bin0 + b/f_bin_idf;
+        while (n < nzL_mono && f_sl[n] < fb)
+            ++n;
+        zL_bin[b] = n;
+    }
 }
 
 #ifndef USECUDA
@@ -361,6 +395,13 @@ void Boundary_surface::update_bcs()
               it->second->databot, it->second->datagradbot, it->second->datafluxbot,
               grid->z[grid->kstart], sbc[it->first]->bcbot);
     }
+
+    for (FieldMap::const_iterator it=fields->sps.begin(); it!=fields->sps.end(); ++it)
+    {
+        surfs(ustar, obuk, it->second->data_single,
+              it->second->databot, it->second->datagradbot, it->second->datafluxbot,
+              grid->z[grid->kstart], sbc[it->first]->bcbot);
+    }
 }
 #endif
 
@@ -414,6 +455,9 @@ void Boundary_surface::stability(double* restrict ustar, double* restrict obuk,
             }
     }
     // case 2: fixed buoyancy surface value and free ustar
+    // The surface layer is solved for the whole plane at once: first the Richardson numbers are
+    // stored in obuk, then these are converted to z/L with the lookup table, and finally the
+    // Obukhov length and ustar are computed.
     else if (mbcbot == Dirichlet_type && thermobc == Flux_type)
     {
         for (int j=0; j<grid->jcells; ++j)
@@ -421,7 +465,17 @@ void Boundary_surface::stability(double* restrict ustar, double* restrict obuk,
             for (int i=0; i<grid->icells; ++i)
             {
                 const int ij = i + j*jj;
-                obuk [ij] = calc_obuk_noslip_flux(zL_sl, f_sl, nobuk[ij], dutot[ij], bfluxbot[ij], z[kstart]);
+                obuk[ij] = calc_ri_noslip_flux(dutot[ij], bfluxbot[ij], z[kstart]);
+            }
+
+        calc_zL(obuk);
+
+        for (int j=0; j<grid->jcells; ++j)
+#pragma ivdep
+            for (int i=0; i<grid->icells; ++i)
+            {
+                const int ij = i + j*jj;
+                obuk [ij] = z[kstart]/obuk[ij];
                 ustar[ij] = dutot[ij] * most::fm(z[kstart], z0m, obuk[ij]);
             }
     }
@@ -434,7 +488,17 @@ void Boundary_surface::stability(double* restrict ustar, double* restrict obuk,
                 const int ij  = i + j*jj;
                 const int ijk = i + j*jj + kstart*kk;
                 const double db = b[ijk] - bbot[ij];
-                obuk [ij] = calc_obuk_noslip_dirichlet(zL_sl, f_sl, nobuk[ij], dutot[ij], db, z[kstart]);
+                obuk[ij] = calc_ri_noslip_dirichlet(dutot[ij], db, z[kstart]);
+            }
+
+        calc_zL(obuk);
+
+        for (int j=0; j<grid->jcells; ++j)
+#pragma ivdep
+            for (int i=0; i<grid->icells; ++i)
+            {
+                const int ij = i + j*jj;
+                obuk [ij] = z[kstart]/obuk[ij];
                 ustar[ij] = dutot[ij] * most::fm(z[kstart], z0m, obuk[ij]);
             }
     }
@@ -603,7 +667,8 @@ ijk = i + j*jj + kstart*kk;
         }
 }
 
-void Boundary_surface::surfs(double* restrict ustar, double* restrict obuk, double* restrict var,
+template<typename T>
+void Boundary_surface::surfs(double* restrict ustar, double* restrict obuk, T* restrict var,
                              double* restrict varbot, double* restrict vargradbot, double* restrict varfluxbot, 
                              double zsl, int bcbot)
 {
@@ -649,13 +714,25 @@ void Boundary_surface::surfs(double* restrict ustar, double* restrict obuk, doub
 namespace
 {
     double find_zL(const float* const restrict zL, const float* const restrict f,
-                   int &n, const float Ri)
+                   const int* const restrict bin, const int nbin, const int n0, const int nmono,
+                   const float f0, const float fidf, const float Ri)
     {
-        // Determine search direction.
-        if ( (f[n]-Ri) > 0 )
-            while ( (f[n-1]-Ri) > 0 && n > 0) { --n; }
+        int n;
+
+        // The Richardson number is beyond the monotonic part of the table.
+        if (Ri > f[nmono])
+            n = nzL-1;
+        // Search the stretched part of the table for free convection.
+        else if (Ri < f[n0])
+            n = std::lower_bound(f, f+n0, Ri) - f;
+        // Find the first entry that is not smaller than Ri from the index table.
         else
-            while ( (f[n]-Ri) < 0 && n < (nzL-1) ) { ++n; }
+        {
+            const int b = std::min(std::max(static_cast<int>((Ri-f0)*fidf), 0), nbin);
+            n = bin[b];
+            while (n > n0 && f[n-1] >= Ri) { --n; }
+            while (n < nmono && f[n] < Ri) { ++n; }
+        }
 
         const double zL0 = (n == 0 || n == nzL-1) ? zL[n] : zL[n-1] + (Ri-f[n-1]) / (f[n]-f[n-1]) * (zL[n]-zL[n-1]);
 
@@ -663,22 +740,23 @@ namespace
     }
 }
 
-double Boundary_surface::calc_obuk_noslip_flux(const float* const restrict zL, const float* const restrict f,
-                                               int& n,
-                                               const double du, const double bfluxbot, const double zsl)
+void Boundary_surface::calc_zL(double* restrict zL)
+{
+    // Convert the Richardson numbers in zL in place into z/L.
+    for (int n=0; n<grid->ijcells; ++n)
+        zL[n] = find_zL(zL_sl, f_sl, zL_bin, nzL_bin, nzL_bin0, nzL_mono, f_bin0, f_bin_idf, zL[n]);
+}
+
+double Boundary_surface::calc_ri_noslip_flux(const double du, const double bfluxbot, const double zsl)
 {
     // Calculate the appropriate Richardson number and reduce precision.
     const float Ri = -Constants::kappa * bfluxbot * zsl / std::pow(du, 3);
-
-    return zsl/find_zL(zL, f, n, Ri);
+    return Ri;
 }
 
-double Boundary_surface::calc_obuk_noslip_dirichlet(const float* const restrict zL, const float* const restrict f,
-                                                    int& n,
-                                                    const double du, const double db, const double zsl)
+double Boundary_surface::calc_ri_noslip_dirichlet(const double du, const double db, const double zsl)
 {
     // Calculate the appropriate Richardson number and reduce precision.
     const float Ri = Constants::kappa * db * zsl / std::pow(du, 2);
-
-    return zsl/find_zL(zL, f, n, Ri);
+    return Ri;
 }
@@ -57,6 +57,12 @@ void Boundary_surface_bulk::init(Input *inputin)
 
     int nerror = 0;
     nerror += inputin->get_item(&z0m, "boundary", "z0m", "");
+
+    if (!fields->sps.empty())
+    {
+        master->print_error("sprecision = \"single\" is not supported with swboundary = \"surface_bulk\"\n");
+        ++nerror;
+    }
     nerror += inputin->get_item(&z0h, "boundary", "z0h", "");
 
     // Read list of cross sections
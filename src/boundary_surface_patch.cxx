@@ -29,6 +29,7 @@
 #include "boundary_surface_patch.h"
 #include "defines.h"
 #include "model.h"
+#include "stats.h"
 
 Boundary_surface_patch::Boundary_surface_patch(Model* modelin, Input* inputin) : Boundary_surface(modelin, inputin)
 {
@@ -41,6 +42,12 @@ void Boundary_surface_patch::init(Input* inputin)
     // 1. Process the boundary conditions now all fields are registered
     process_bcs(inputin);
 
+    if (!fields->sps.empty())
+    {
+        master->print_error("sprecision = \"single\" is not supported with swboundary = \"surface_patch\"\n");
+        ++nerror;
+    }
+
     // Patch type.
     nerror += inputin->get_item(&patch_dim,   "boundary", "patch_dim"  , "", 2 );
     nerror += inputin->get_item(&patch_xh,    "boundary", "patch_xh"   , "", 1.);
@@ -101,63 +108,46 @@ void Boundary_surface_patch::set_values()
     init_solver();
 }
 
-void Boundary_surface_patch::get_mask(Field3d* field, Field3d* fieldh, Mask* m)
+void Boundary_surface_patch::get_mask(Mask* m)
 {
     const int jj = grid->icells;
-    const int kk = grid->ijcells;
+
+    Stats* stats = model->stats;
 
     // Switch between patch - no patch
     int sw;
     m->name == "patch_high" ? sw = 1 : sw = 0;
 
-    // Calculate surface pattern
+    // Calculate surface pattern, the mask is also set in the ghost cells
     calc_patch(fields->atmp["tmp1"]->databot, grid->x, grid->y, patch_dim, 
                patch_xh, patch_xr, patch_xi, 
                patch_yh, patch_yr, patch_yi, 
                patch_xoffs, patch_yoffs);
+    grid->boundary_cyclic_2d(fields->atmp["tmp1"]->databot);
 
     // Set the values ranging between 0....1 to 0 or 1
-    model->stats->nmaskh[grid->kstart] = 0;
-    for (int j=grid->jstart; j<grid->jend; ++j)
-        #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+    for (int j=0; j<grid->jcells; ++j)
+        for (int i=0; i<grid->icells; ++i)
         {
             const int ij = i + j*jj;
 
-            if (fields->atmp["tmp1"]->databot[ij] >= 0.5)
-                fieldh->databot[ij] = sw;
-            else
-                fieldh->databot[ij] = 1-sw;
-
-            if (fieldh->databot[ij] == 1)
-                model->stats->nmaskh[grid->kstart] += 1;
+            const int inpatch = fields->atmp["tmp1"]->databot[ij] >= 0.5;
+            if (inpatch == sw)
+                stats->set_mask_bit(m->mfieldbot, i, j, 0);
         }
 
-    // Sum the area, and propagate info
-    master->sum(&model->stats->nmaskh[grid->kstart], 1);
-
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
-        model->stats->nmaskh[k] = model->stats->nmaskh[grid->kstart];
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        model->stats->nmask[k]  = model->stats->nmaskh[grid->kstart];
-    model->stats->nmaskbot = model->stats->nmaskh[grid->kstart]; 
-
     // Set the atmospheric values
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+    for (int k=grid->kstart; k<grid->kend+1; ++k)
+        for (int j=0; j<grid->jcells; ++j)
+            for (int i=0; i<grid->icells; ++i)
             {
-                const int ij  = i + j*jj;
-                const int ijk = i + j*jj + k*kk;
+                if (!stats->get_mask_bit(m->mfieldbot, i, j, 0))
+                    continue;
 
-                field ->data[ijk] = fieldh->databot[ij];
-                fieldh->data[ijk] = fieldh->databot[ij];
+                if (k < grid->kend)
+                    stats->set_mask_bit(m->mfield, i, j, k);
+                stats->set_mask_bit(m->mfieldh, i, j, k);
             }
-
-    grid->boundary_cyclic   (field->data    );
-    grid->boundary_cyclic   (fieldh->data   );
-    grid->boundary_cyclic_2d(fieldh->databot);
 }
 
 void Boundary_surface_patch::get_surface_mask(Field3d* field)
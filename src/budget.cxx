@@ -20,6 +20,7 @@
  * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include "input.h"
 #include "master.h"
 #include "grid.h"
@@ -27,6 +28,7 @@
 #include "thermo.h"
 #include "diff.h"
 #include "stats.h"
+#include "defines.h"
 
 #include "budget.h"
 #include "budget_disabled.h"
@@ -43,6 +45,18 @@ Budget::Budget(Input* inputin, Master* masterin, Grid* gridin, Fields* fieldsin,
     force (*forcein ),
     stats (*statsin )
 {
+    if (inputin->get_list(&budgetlist, "budget", "budgetlist", ""))
+        throw 1;
+
+    const std::string budgets[] = {"ke", "tke", "buoy", "pe"};
+    for (std::vector<std::string>::const_iterator it=budgetlist.begin(); it!=budgetlist.end(); ++it)
+    {
+        if (std::find(std::begin(budgets), std::end(budgets), *it) == std::end(budgets))
+        {
+            master.print_error("\"%s\" is an illegal value in budgetlist\n", it->c_str());
+            throw 1;
+        }
+    }
 }
 
 Budget::~Budget()
@@ -71,3 +85,26 @@ Budget* Budget::factory(Input* inputin, Master* masterin, Grid* gridin, Fields*
         throw 1;
     }
 }
+
+bool Budget::has_budget(const std::string& name)
+{
+    return budgetlist.empty() || std::find(budgetlist.begin(), budgetlist.end(), name) != budgetlist.end();
+}
+
+void Budget::add_prof(std::string name, std::string longname, std::string unit, std::string zloc)
+{
+    stats.add_prof(name, longname, unit, zloc);
+    proflist.push_back(name);
+}
+
+void Budget::copy_stats(Mask* mout, Mask* min)
+{
+    // The budgets are computed over the full domain, so they are the same for all masks.
+    for (std::vector<std::string>::const_iterator it=proflist.begin(); it!=proflist.end(); ++it)
+    {
+        double* restrict out = mout->profs[*it].data;
+        const double* restrict in = min->profs[*it].data;
+        for (int k=0; k<grid.kcells; ++k)
+            out[k] = in[k];
+    }
+}
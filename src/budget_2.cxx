@@ -78,102 +78,117 @@ void Budget_2::init()
 void Budget_2::create()
 {
     // add the profiles for the kinetic energy to the statistics
-    stats.add_prof("ke" , "Kinetic energy" , "m2 s-2", "z");
-    stats.add_prof("tke", "Turbulent kinetic energy" , "m2 s-2", "z");
+    if (has_budget("ke"))
+    {
+        add_prof("ke" , "Kinetic energy" , "m2 s-2", "z");
+        add_prof("tke", "Turbulent kinetic energy" , "m2 s-2", "z");
+    }
+
+    if (has_budget("tke"))
+        create_tke_budget();
+
+    if (has_budget("buoy") && thermo.get_switch() != "0")
+        create_buoyancy_budget();
+}
 
+void Budget_2::create_tke_budget()
+{
     // add the profiles for the kinetic energy budget to the statistics
     if(advec.get_switch() != "0")
     {
-        stats.add_prof("u2_shear" , "Shear production term in U2 budget" , "m2 s-3", "z" );
-        stats.add_prof("v2_shear" , "Shear production term in V2 budget" , "m2 s-3", "z" );
-        stats.add_prof("tke_shear", "Shear production term in TKE budget", "m2 s-3", "z" );
-        stats.add_prof("uw_shear" , "Shear production term in UW budget" , "m2 s-3", "zh");
-        stats.add_prof("vw_shear" , "Shear production term in VW budget" , "m2 s-3", "zh");
-
-        stats.add_prof("u2_turb" , "Turbulent transport term in U2 budget" , "m2 s-3", "z" );
-        stats.add_prof("v2_turb" , "Turbulent transport term in V2 budget" , "m2 s-3", "z" );
-        stats.add_prof("w2_turb" , "Turbulent transport term in W2 budget" , "m2 s-3", "zh");
-        stats.add_prof("tke_turb", "Turbulent transport term in TKE budget", "m2 s-3", "z" );
-        stats.add_prof("uw_turb" , "Turbulent transport term in UW budget" , "m2 s-3", "zh");
-        stats.add_prof("vw_turb" , "Turbulent transport term in VW budget" , "m2 s-3", "zh");
+        add_prof("u2_shear" , "Shear production term in U2 budget" , "m2 s-3", "z" );
+        add_prof("v2_shear" , "Shear production term in V2 budget" , "m2 s-3", "z" );
+        add_prof("tke_shear", "Shear production term in TKE budget", "m2 s-3", "z" );
+        add_prof("uw_shear" , "Shear production term in UW budget" , "m2 s-3", "zh");
+        add_prof("vw_shear" , "Shear production term in VW budget" , "m2 s-3", "zh");
+
+        add_prof("u2_turb" , "Turbulent transport term in U2 budget" , "m2 s-3", "z" );
+        add_prof("v2_turb" , "Turbulent transport term in V2 budget" , "m2 s-3", "z" );
+        add_prof("w2_turb" , "Turbulent transport term in W2 budget" , "m2 s-3", "zh");
+        add_prof("tke_turb", "Turbulent transport term in TKE budget", "m2 s-3", "z" );
+        add_prof("uw_turb" , "Turbulent transport term in UW budget" , "m2 s-3", "zh");
+        add_prof("vw_turb" , "Turbulent transport term in VW budget" , "m2 s-3", "zh");
     }
 
     if(diff.get_switch() != "0")
     {
-        stats.add_prof("u2_diss" , "Dissipation term in U2 budget" , "m2 s-3", "z" );
-        stats.add_prof("v2_diss" , "Dissipation term in V2 budget" , "m2 s-3", "z" );
-        stats.add_prof("w2_diss" , "Dissipation term in W2 budget" , "m2 s-3", "zh");
-        stats.add_prof("tke_diss", "Dissipation term in TKE budget", "m2 s-3", "z" );
-        stats.add_prof("uw_diss" , "Dissipation term in UW budget" , "m2 s-3", "zh");
-        stats.add_prof("vw_diss" , "Dissipation term in VW budget" , "m2 s-3", "zh");
-
-        stats.add_prof("u2_visc" , "Viscous transport term in U2 budget" , "m2 s-3", "z" );
-        stats.add_prof("v2_visc" , "Viscous transport term in V2 budget" , "m2 s-3", "z" );
-        stats.add_prof("w2_visc" , "Viscous transport term in W2 budget" , "m2 s-3", "zh");
-        stats.add_prof("tke_visc", "Viscous transport term in TKE budget", "m2 s-3", "z" );
-        stats.add_prof("uw_visc" , "Viscous transport term in UW budget" , "m2 s-3", "zh");
-        stats.add_prof("vw_visc" , "Viscous transport term in VW budget" , "m2 s-3", "zh");
+        add_prof("u2_diss" , "Dissipation term in U2 budget" , "m2 s-3", "z" );
+        add_prof("v2_diss" , "Dissipation term in V2 budget" , "m2 s-3", "z" );
+        add_prof("w2_diss" , "Dissipation term in W2 budget" , "m2 s-3", "zh");
+        add_prof("tke_diss", "Dissipation term in TKE budget", "m2 s-3", "z" );
+        add_prof("uw_diss" , "Dissipation term in UW budget" , "m2 s-3", "zh");
+        add_prof("vw_diss" , "Dissipation term in VW budget" , "m2 s-3", "zh");
+
+        add_prof("u2_visc" , "Viscous transport term in U2 budget" , "m2 s-3", "z" );
+        add_prof("v2_visc" , "Viscous transport term in V2 budget" , "m2 s-3", "z" );
+        add_prof("w2_visc" , "Viscous transport term in W2 budget" , "m2 s-3", "zh");
+        add_prof("tke_visc", "Viscous transport term in TKE budget", "m2 s-3", "z" );
+        add_prof("uw_visc" , "Viscous transport term in UW budget" , "m2 s-3", "zh");
+        add_prof("vw_visc" , "Viscous transport term in VW budget" , "m2 s-3", "zh");
 
         // For LES, add the total diffusive budget terms, which (unlike diss + visc) close
         if(diff.get_switch() == "smag2")
         {
-            stats.add_prof("u2_diff" , "Total diffusive term in U2 budget" , "m2 s-3", "z" );
-            stats.add_prof("v2_diff" , "Total diffusive term in V2 budget" , "m2 s-3", "z" );
-            stats.add_prof("w2_diff" , "Total diffusive term in W2 budget" , "m2 s-3", "zh");
-            stats.add_prof("tke_diff", "Total diffusive term in TKE budget", "m2 s-3", "z" );
-            stats.add_prof("uw_diff" , "Total diffusive term in UW budget" , "m2 s-3", "zh");
-            stats.add_prof("vw_diff" , "Total diffusive term in VW budget" , "m2 s-3", "zh");
+            add_prof("u2_diff" , "Total diffusive term in U2 budget" , "m2 s-3", "z" );
+            add_prof("v2_diff" , "Total diffusive term in V2 budget" , "m2 s-3", "z" );
+            add_prof("w2_diff" , "Total diffusive term in W2 budget" , "m2 s-3", "zh");
+            add_prof("tke_diff", "Total diffusive term in TKE budget", "m2 s-3", "z" );
+            add_prof("uw_diff" , "Total diffusive term in UW budget" , "m2 s-3", "zh");
+            add_prof("vw_diff" , "Total diffusive term in VW budget" , "m2 s-3", "zh");
         }
 
     }
 
     if(force.get_switch_lspres() == "geo")
     {
-        stats.add_prof("u2_cor", "Coriolis term in U2 budget", "m2 s-3", "z" );
-        stats.add_prof("v2_cor", "Coriolis term in V2 budget", "m2 s-3", "z" );
-        stats.add_prof("uw_cor", "Coriolis term in UW budget", "m2 s-3", "zh");
-        stats.add_prof("vw_cor", "Coriolis term in VW budget", "m2 s-3", "zh");
+        add_prof("u2_cor", "Coriolis term in U2 budget", "m2 s-3", "z" );
+        add_prof("v2_cor", "Coriolis term in V2 budget", "m2 s-3", "z" );
+        add_prof("uw_cor", "Coriolis term in UW budget", "m2 s-3", "zh");
+        add_prof("vw_cor", "Coriolis term in VW budget", "m2 s-3", "zh");
     }
 
     if (thermo.get_switch() != "0")
     {
-        stats.add_prof("w2_buoy" , "Buoyancy production/destruction term in W2 budget" , "m2 s-3", "zh");
-        stats.add_prof("tke_buoy", "Buoyancy production/destruction term in TKE budget", "m2 s-3", "z" );
-        stats.add_prof("uw_buoy" , "Buoyancy production/destruction term in UW budget" , "m2 s-3", "zh");
-        stats.add_prof("vw_buoy" , "Buoyancy production/destruction term in VW budget" , "m2 s-3", "zh");
+        add_prof("w2_buoy" , "Buoyancy production/destruction term in W2 budget" , "m2 s-3", "zh");
+        add_prof("tke_buoy", "Buoyancy production/destruction term in TKE budget", "m2 s-3", "z" );
+        add_prof("uw_buoy" , "Buoyancy production/destruction term in UW budget" , "m2 s-3", "zh");
+        add_prof("vw_buoy" , "Buoyancy production/destruction term in VW budget" , "m2 s-3", "zh");
+    }
 
-        if (advec.get_switch() != "0")
-        {
-            stats.add_prof("b2_shear", "Shear production term in B2 budget", "m2 s-5", "z");
-            stats.add_prof("b2_turb" , "Turbulent transport term in B2 budget", "m2 s-5", "z");
+    add_prof("w2_pres" , "Pressure transport term in W2 budget" , "m2 s-3", "zh");
+    add_prof("tke_pres", "Pressure transport term in TKE budget", "m2 s-3", "z" );
+    add_prof("uw_pres" , "Pressure transport term in UW budget" , "m2 s-3", "zh");
+    add_prof("vw_pres" , "Pressure transport term in VW budget" , "m2 s-3", "zh");
 
-            stats.add_prof("bw_shear", "Shear production term in B2 budget",    "m2 s-4", "zh");
-            stats.add_prof("bw_turb" , "Turbulent transport term in B2 budget", "m2 s-4", "zh");
-        }
+    add_prof("u2_rdstr", "Pressure redistribution term in U2 budget", "m2 s-3", "z" );
+    add_prof("v2_rdstr", "Pressure redistribution term in V2 budget", "m2 s-3", "z" );
+    add_prof("w2_rdstr", "Pressure redistribution term in W2 budget", "m2 s-3", "zh");
+    add_prof("uw_rdstr", "Pressure redistribution term in UW budget", "m2 s-3", "zh");
+    add_prof("vw_rdstr", "Pressure redistribution term in VW budget", "m2 s-3", "zh");
+}
 
-        if (diff.get_switch() != "0")
-        {
-            stats.add_prof("b2_visc" , "Viscous transport term in B2 budget", "m2 s-5", "z");
-            stats.add_prof("b2_diss" , "Dissipation term in B2 budget"      , "m2 s-5", "z");
-            stats.add_prof("bw_visc" , "Viscous transport term in BW budget", "m2 s-4", "zh");
-            stats.add_prof("bw_diss" , "Dissipation term in BW budget"      , "m2 s-4", "zh");
-        }
+void Budget_2::create_buoyancy_budget()
+{
+    if (advec.get_switch() != "0")
+    {
+        add_prof("b2_shear", "Shear production term in B2 budget", "m2 s-5", "z");
+        add_prof("b2_turb" , "Turbulent transport term in B2 budget", "m2 s-5", "z");
 
-        stats.add_prof("bw_rdstr", "Redistribution term in BW budget"     , "m2 s-4", "zh");
-        stats.add_prof("bw_buoy" , "Buoyancy term in BW budget"           , "m2 s-4", "zh");
-        stats.add_prof("bw_pres" , "Pressure transport term in BW budget" , "m2 s-4", "zh");
+        add_prof("bw_shear", "Shear production term in B2 budget",    "m2 s-4", "zh");
+        add_prof("bw_turb" , "Turbulent transport term in B2 budget", "m2 s-4", "zh");
     }
 
-    stats.add_prof("w2_pres" , "Pressure transport term in W2 budget" , "m2 s-3", "zh");
-    stats.add_prof("tke_pres", "Pressure transport term in TKE budget", "m2 s-3", "z" );
-    stats.add_prof("uw_pres" , "Pressure transport term in UW budget" , "m2 s-3", "zh");
-    stats.add_prof("vw_pres" , "Pressure transport term in VW budget" , "m2 s-3", "zh");
+    if (diff.get_switch() != "0")
+    {
+        add_prof("b2_visc" , "Viscous transport term in B2 budget", "m2 s-5", "z");
+        add_prof("b2_diss" , "Dissipation term in B2 budget"      , "m2 s-5", "z");
+        add_prof("bw_visc" , "Viscous transport term in BW budget", "m2 s-4", "zh");
+        add_prof("bw_diss" , "Dissipation term in BW budget"      , "m2 s-4", "zh");
+    }
 
-    stats.add_prof("u2_rdstr", "Pressure redistribution term in U2 budget", "m2 s-3", "z" );
-    stats.add_prof("v2_rdstr", "Pressure redistribution term in V2 budget", "m2 s-3", "z" );
-    stats.add_prof("w2_rdstr", "Pressure redistribution term in W2 budget", "m2 s-3", "zh");
-    stats.add_prof("uw_rdstr", "Pressure redistribution term in UW budget", "m2 s-3", "zh");
-    stats.add_prof("vw_rdstr", "Pressure redistribution term in VW budget", "m2 s-3", "zh");
+    add_prof("bw_rdstr", "Redistribution term in BW budget"     , "m2 s-4", "zh");
+    add_prof("bw_buoy" , "Buoyancy term in BW budget"           , "m2 s-4", "zh");
+    add_prof("bw_pres" , "Pressure transport term in BW budget" , "m2 s-4", "zh");
 }
 
 void Budget_2::exec_stats(Mask* m)
@@ -184,9 +199,19 @@ void Budget_2::exec_stats(Mask* m)
 
 
     // Calculate kinetic and turbulent kinetic energy
-    calc_kinetic_energy(m->profs["ke"].data, m->profs["tke"].data,
-                        fields.u->data, fields.v->data, fields.w->data, umodel, vmodel, grid.utrans, grid.vtrans);
+    if (has_budget("ke"))
+        calc_kinetic_energy(m->profs["ke"].data, m->profs["tke"].data,
+                            fields.u->data, fields.v->data, fields.w->data, umodel, vmodel, grid.utrans, grid.vtrans);
 
+    if (has_budget("tke"))
+        exec_tke_budget(m);
+
+    if (has_budget("buoy") && thermo.get_switch() != "0")
+        exec_buoyancy_budget(m);
+}
+
+void Budget_2::exec_tke_budget(Mask* m)
+{
     if(advec.get_switch() != "0")
     {
         // Calculate the shear production and turbulent transport terms
@@ -222,44 +247,15 @@ void Budget_2::exec_stats(Mask* m)
 
     if(thermo.get_switch() != "0")
     {
-        // Get the buoyancy diffusivity from the thermo class
-        const double diff_b = thermo.get_buoyancy_diffusivity();
-
         // Store the buoyancy in the tmp1 field
         thermo.get_thermo_field(fields.atmp["tmp1"], fields.atmp["tmp2"], "b", true);
-
-        // Calculate mean fields
         grid.calc_mean(fields.atmp["tmp1"]->datamean, fields.atmp["tmp1"]->data, grid.kcells);
-        grid.calc_mean(fields.sd["p"]->datamean, fields.sd["p"]->data, grid.kcells);
 
         // Calculate buoyancy terms
         calc_buoyancy_terms(m->profs["w2_buoy"].data, m->profs["tke_buoy"].data,
                             m->profs["uw_buoy"].data, m->profs["vw_buoy"].data,
                             fields.u->data, fields.v->data, fields.w->data, fields.atmp["tmp1"]->data,
                             umodel, vmodel, fields.atmp["tmp1"]->datamean);
-
-        // Buoyancy variance and flux budgets
-        calc_buoyancy_terms_scalar(m->profs["bw_buoy"].data,
-                                   fields.atmp["tmp1"]->data, fields.atmp["tmp1"]->data,
-                                   fields.atmp["tmp1"]->datamean, fields.atmp["tmp1"]->datamean);
-
-        if (advec.get_switch() != "0")
-            calc_advection_terms_scalar(m->profs["b2_shear"].data, m->profs["b2_turb"].data,
-                                        m->profs["bw_shear"].data, m->profs["bw_turb"].data,
-                                        fields.atmp["tmp1"]->data, fields.w->data, fields.atmp["tmp1"]->datamean,
-                                        grid.dzi, grid.dzhi);
-
-        if (diff.get_switch() == "2" || diff.get_switch() == "4")
-            calc_diffusion_terms_scalar_DNS(m->profs["b2_visc"].data, m->profs["b2_diss"].data,
-                                            m->profs["bw_visc"].data, m->profs["bw_diss"].data,
-                                            fields.atmp["tmp1"]->data, fields.w->data,
-                                            fields.atmp["tmp1"]->datamean,
-                                            grid.dzi, grid.dzhi, grid.dxi, grid.dyi, fields.visc, diff_b);
-
-        calc_pressure_terms_scalar(m->profs["bw_pres"].data,  m->profs["bw_rdstr"].data,
-                                   fields.atmp["tmp1"]->data, fields.sd["p"]->data,
-                                   fields.atmp["tmp1"]->datamean, fields.sd["p"]->datamean,
-                                   grid.dzi, grid.dzhi);
     }
 
     if(force.get_switch_lspres() == "geo")
@@ -280,6 +276,45 @@ void Budget_2::exec_stats(Mask* m)
                         grid.dzi, grid.dzhi, grid.dxi, grid.dyi);
 }
 
+void Budget_2::exec_buoyancy_budget(Mask* m)
+{
+    // Get the buoyancy diffusivity from the thermo class
+    const double diff_b = thermo.get_buoyancy_diffusivity();
+
+    // Store the buoyancy in the tmp1 field, unless the TKE budget has done so
+    if (!has_budget("tke"))
+    {
+        thermo.get_thermo_field(fields.atmp["tmp1"], fields.atmp["tmp2"], "b", true);
+        grid.calc_mean(fields.atmp["tmp1"]->datamean, fields.atmp["tmp1"]->data, grid.kcells);
+    }
+
+    // Calculate mean fields
+    grid.calc_mean(fields.sd["p"]->datamean, fields.sd["p"]->data, grid.kcells);
+
+    // Buoyancy variance and flux budgets
+    calc_buoyancy_terms_scalar(m->profs["bw_buoy"].data,
+                               fields.atmp["tmp1"]->data, fields.atmp["tmp1"]->data,
+                               fields.atmp["tmp1"]->datamean, fields.atmp["tmp1"]->datamean);
+
+    if (advec.get_switch() != "0")
+        calc_advection_terms_scalar(m->profs["b2_shear"].data, m->profs["b2_turb"].data,
+                                    m->profs["bw_shear"].data, m->profs["bw_turb"].data,
+                                    fields.atmp["tmp1"]->data, fields.w->data, fields.atmp["tmp1"]->datamean,
+                                    grid.dzi, grid.dzhi);
+
+    if (diff.get_switch() == "2" || diff.get_switch() == "4")
+        calc_diffusion_terms_scalar_DNS(m->profs["b2_visc"].data, m->profs["b2_diss"].data,
+                                        m->profs["bw_visc"].data, m->profs["bw_diss"].data,
+                                        fields.atmp["tmp1"]->data, fields.w->data,
+                                        fields.atmp["tmp1"]->datamean,
+                                        grid.dzi, grid.dzhi, grid.dxi, grid.dyi, fields.visc, diff_b);
+
+    calc_pressure_terms_scalar(m->profs["bw_pres"].data,  m->profs["bw_rdstr"].data,
+                               fields.atmp["tmp1"]->data, fields.sd["p"]->data,
+                               fields.atmp["tmp1"]->datamean, fields.sd["p"]->datamean,
+                               grid.dzi, grid.dzhi);
+}
+
 namespace
 {
     // Double linear interpolation
@@ -64,80 +64,89 @@ void Budget_4::init()
 void Budget_4::create()
 {
     // add the profiles for the kinetic energy to the statistics
-    stats.add_prof("ke" , "Kinetic energy" , "m2 s-2", "z");
-    stats.add_prof("tke", "Turbulent kinetic energy" , "m2 s-2", "z");
+    if (has_budget("ke"))
+    {
+        add_prof("ke" , "Kinetic energy" , "m2 s-2", "z");
+        add_prof("tke", "Turbulent kinetic energy" , "m2 s-2", "z");
+    }
 
     // add the profiles for the kinetic energy budget to the statistics
-    stats.add_prof("u2_shear" , "Shear production term in U2 budget" , "m2 s-3", "z" );
-    stats.add_prof("v2_shear" , "Shear production term in V2 budget" , "m2 s-3", "z" );
-    stats.add_prof("tke_shear", "Shear production term in TKE budget", "m2 s-3", "z" );
-    stats.add_prof("uw_shear" , "Shear production term in UW budget" , "m2 s-3", "zh");
-
-    stats.add_prof("u2_turb" , "Turbulent transport term in U2 budget" , "m2 s-3", "z" );
-    stats.add_prof("v2_turb" , "Turbulent transport term in V2 budget" , "m2 s-3", "z" );
-    stats.add_prof("w2_turb" , "Turbulent transport term in W2 budget" , "m2 s-3", "zh");
-    stats.add_prof("tke_turb", "Turbulent transport term in TKE budget", "m2 s-3", "z" );
-    stats.add_prof("uw_turb" , "Turbulent transport term in UW budget" , "m2 s-3", "zh");
-
-    stats.add_prof("u2_visc" , "Viscous transport term in U2 budget" , "m2 s-3", "z" );
-    stats.add_prof("v2_visc" , "Viscous transport term in V2 budget" , "m2 s-3", "z" );
-    stats.add_prof("w2_visc" , "Viscous transport term in W2 budget" , "m2 s-3", "zh");
-    stats.add_prof("tke_visc", "Viscous transport term in TKE budget", "m2 s-3", "z" );
-    stats.add_prof("uw_visc" , "Viscous transport term in UW budget" , "m2 s-3", "zh");
-
-    stats.add_prof("u2_diss" , "Dissipation term in U2 budget" , "m2 s-3", "z" );
-    stats.add_prof("v2_diss" , "Dissipation term in V2 budget" , "m2 s-3", "z" );
-    stats.add_prof("w2_diss" , "Dissipation term in W2 budget" , "m2 s-3", "zh");
-    stats.add_prof("tke_diss", "Dissipation term in TKE budget", "m2 s-3", "z" );
-    stats.add_prof("uw_diss" , "Dissipation term in UW budget" , "m2 s-3", "zh");
-
-    stats.add_prof("w2_pres" , "Pressure transport term in W2 budget" , "m2 s-3", "zh");
-    stats.add_prof("tke_pres", "Pressure transport term in TKE budget", "m2 s-3", "z" );
-    stats.add_prof("uw_pres" , "Pressure transport term in UW budget" , "m2 s-3", "zh");
-
-    stats.add_prof("u2_rdstr", "Pressure redistribution term in U2 budget", "m2 s-3", "z" );
-    stats.add_prof("v2_rdstr", "Pressure redistribution term in V2 budget", "m2 s-3", "z" );
-    stats.add_prof("w2_rdstr", "Pressure redistribution term in W2 budget", "m2 s-3", "zh");
-    stats.add_prof("uw_rdstr", "Pressure redistribution term in UW budget", "m2 s-3", "zh");
-
-    if (thermo.get_switch() != "0")
+    if (has_budget("tke"))
+    {
+        add_prof("u2_shear" , "Shear production term in U2 budget" , "m2 s-3", "z" );
+        add_prof("v2_shear" , "Shear production term in V2 budget" , "m2 s-3", "z" );
+        add_prof("tke_shear", "Shear production term in TKE budget", "m2 s-3", "z" );
+        add_prof("uw_shear" , "Shear production term in UW budget" , "m2 s-3", "zh");
+
+        add_prof("u2_turb" , "Turbulent transport term in U2 budget" , "m2 s-3", "z" );
+        add_prof("v2_turb" , "Turbulent transport term in V2 budget" , "m2 s-3", "z" );
+        add_prof("w2_turb" , "Turbulent transport term in W2 budget" , "m2 s-3", "zh");
+        add_prof("tke_turb", "Turbulent transport term in TKE budget", "m2 s-3", "z" );
+        add_prof("uw_turb" , "Turbulent transport term in UW budget" , "m2 s-3", "zh");
+
+        add_prof("u2_visc" , "Viscous transport term in U2 budget" , "m2 s-3", "z" );
+        add_prof("v2_visc" , "Viscous transport term in V2 budget" , "m2 s-3", "z" );
+        add_prof("w2_visc" , "Viscous transport term in W2 budget" , "m2 s-3", "zh");
+        add_prof("tke_visc", "Viscous transport term in TKE budget", "m2 s-3", "z" );
+        add_prof("uw_visc" , "Viscous transport term in UW budget" , "m2 s-3", "zh");
+
+        add_prof("u2_diss" , "Dissipation term in U2 budget" , "m2 s-3", "z" );
+        add_prof("v2_diss" , "Dissipation term in V2 budget" , "m2 s-3", "z" );
+        add_prof("w2_diss" , "Dissipation term in W2 budget" , "m2 s-3", "zh");
+        add_prof("tke_diss", "Dissipation term in TKE budget", "m2 s-3", "z" );
+        add_prof("uw_diss" , "Dissipation term in UW budget" , "m2 s-3", "zh");
+
+        add_prof("w2_pres" , "Pressure transport term in W2 budget" , "m2 s-3", "zh");
+        add_prof("tke_pres", "Pressure transport term in TKE budget", "m2 s-3", "z" );
+        add_prof("uw_pres" , "Pressure transport term in UW budget" , "m2 s-3", "zh");
+
+        add_prof("u2_rdstr", "Pressure redistribution term in U2 budget", "m2 s-3", "z" );
+        add_prof("v2_rdstr", "Pressure redistribution term in V2 budget", "m2 s-3", "z" );
+        add_prof("w2_rdstr", "Pressure redistribution term in W2 budget", "m2 s-3", "zh");
+        add_prof("uw_rdstr", "Pressure redistribution term in UW budget", "m2 s-3", "zh");
+
+        if (thermo.get_switch() != "0")
+        {
+            add_prof("w2_buoy" , "Buoyancy production/destruction term in W2 budget" , "m2 s-3", "zh");
+            add_prof("tke_buoy", "Buoyancy production/destruction term in TKE budget", "m2 s-3", "z" );
+            add_prof("uw_buoy" , "Buoyancy production/destruction term in UW budget" , "m2 s-3", "zh");
+        }
+    }
+
+    if (has_budget("buoy") && thermo.get_switch() != "0")
     {
-        stats.add_prof("w2_buoy" , "Buoyancy production/destruction term in W2 budget" , "m2 s-3", "zh");
-        stats.add_prof("tke_buoy", "Buoyancy production/destruction term in TKE budget", "m2 s-3", "z" );
-        stats.add_prof("uw_buoy" , "Buoyancy production/destruction term in UW budget" , "m2 s-3", "zh");
-
-        stats.add_prof("b2_shear", "Shear production term in B2 budget"   , "m2 s-5", "z");
-        stats.add_prof("b2_turb" , "Turbulent transport term in B2 budget", "m2 s-5", "z");
-        stats.add_prof("b2_visc" , "Viscous transport term in B2 budget"  , "m2 s-5", "z");
-        stats.add_prof("b2_diss" , "Dissipation term in B2 budget"        , "m2 s-5", "z");
-
-        stats.add_prof("bw_shear", "Shear production term in BW budget"   , "m2 s-4", "zh");
-        stats.add_prof("bw_turb" , "Turbulent transport term in BW budget", "m2 s-4", "zh");
-        stats.add_prof("bw_visc" , "Viscous transport term in BW budget"  , "m2 s-4", "zh");
-        stats.add_prof("bw_rdstr", "Redistribution term in BW budget"     , "m2 s-4", "zh");
-        stats.add_prof("bw_buoy" , "Buoyancy term in BW budget"           , "m2 s-4", "zh");
-        stats.add_prof("bw_diss" , "Dissipation term in BW budget"        , "m2 s-4", "zh");
-        stats.add_prof("bw_pres" , "Pressure transport term in BW budget" , "m2 s-4", "zh");
+        add_prof("b2_shear", "Shear production term in B2 budget"   , "m2 s-5", "z");
+        add_prof("b2_turb" , "Turbulent transport term in B2 budget", "m2 s-5", "z");
+        add_prof("b2_visc" , "Viscous transport term in B2 budget"  , "m2 s-5", "z");
+        add_prof("b2_diss" , "Dissipation term in B2 budget"        , "m2 s-5", "z");
+
+        add_prof("bw_shear", "Shear production term in BW budget"   , "m2 s-4", "zh");
+        add_prof("bw_turb" , "Turbulent transport term in BW budget", "m2 s-4", "zh");
+        add_prof("bw_visc" , "Viscous transport term in BW budget"  , "m2 s-4", "zh");
+        add_prof("bw_rdstr", "Redistribution term in BW budget"     , "m2 s-4", "zh");
+        add_prof("bw_buoy" , "Buoyancy term in BW budget"           , "m2 s-4", "zh");
+        add_prof("bw_diss" , "Dissipation term in BW budget"        , "m2 s-4", "zh");
+        add_prof("bw_pres" , "Pressure transport term in BW budget" , "m2 s-4", "zh");
     }
 
-    if (thermo.get_switch() != "0")
+    if (has_budget("pe") && thermo.get_switch() != "0")
     {
         // add the profiles for the potential energy budget to the statistics
-        stats.add_prof("bsort", "Sorted buoyancy", "m s-2", "z");
-        stats.add_prof("zsort", "Height diff buoyancy and sorted buoyancy", "m", "z");
-        stats.add_prof("pe"   , "Total potential energy", "m2 s-2", "z");
-        stats.add_prof("ape"  , "Available potential energy", "m2 s-2", "z");
-        stats.add_prof("bpe"  , "Background potential energy", "m2 s-2", "z");
+        add_prof("bsort", "Sorted buoyancy", "m s-2", "z");
+        add_prof("zsort", "Height diff buoyancy and sorted buoyancy", "m", "z");
+        add_prof("pe"   , "Total potential energy", "m2 s-2", "z");
+        add_prof("ape"  , "Available potential energy", "m2 s-2", "z");
+        add_prof("bpe"  , "Background potential energy", "m2 s-2", "z");
 
         // add the budget terms for the potential energy
-        stats.add_prof("pe_turb", "Turbulent transport term in potential energy budget", "m2 s-3", "z");
-        stats.add_prof("pe_visc", "Viscous transport term in potential energy budget", "m2 s-3", "z");
-        stats.add_prof("pe_bous", "Boussinesq term in potential energy budget", "m2 s-3", "z");
+        add_prof("pe_turb", "Turbulent transport term in potential energy budget", "m2 s-3", "z");
+        add_prof("pe_visc", "Viscous transport term in potential energy budget", "m2 s-3", "z");
+        add_prof("pe_bous", "Boussinesq term in potential energy budget", "m2 s-3", "z");
 
         // add the budget terms for the background potential energy
-        // stats.add_prof("bpe_turb", "Turbulent transport term in background potential energy budget", "m2 s-3", "z");
-        // stats.add_prof("bpe_visc", "Viscous transport term in background potential energy budget", "m2 s-3", "z");
-        // stats.add_prof("bpe_diss", "Dissipation term in background potential energy budget", "m2 s-3", "z");
+        // add_prof("bpe_turb", "Turbulent transport term in background potential energy budget", "m2 s-3", "z");
+        // add_prof("bpe_visc", "Viscous transport term in background potential energy budget", "m2 s-3", "z");
+        // add_prof("bpe_diss", "Dissipation term in background potential energy budget", "m2 s-3", "z");
     }
 }
 
@@ -149,41 +158,52 @@ void Budget_4::exec_stats(Mask* m)
 
     if (grid.swspatialorder == "4")
     {
-        // calculate the TKE budget
-        calc_ke(fields.u->data, fields.v->data, fields.w->data,
-                umodel, vmodel,
-                grid.utrans, grid.vtrans,
-                m->profs["ke"].data, m->profs["tke"].data);
-
-        calc_tke_budget_shear_turb(fields.u->data, fields.v->data, fields.w->data,
-                                   fields.atmp["tmp1"]->data, fields.atmp["tmp2"]->data,
-                                   umodel, vmodel,
-                                   m->profs["u2_shear"].data, m->profs["v2_shear"].data, m->profs["tke_shear"].data, m->profs["uw_shear"].data,
-                                   m->profs["u2_turb"].data, m->profs["v2_turb"].data, m->profs["w2_turb"].data, m->profs["tke_turb"].data, m->profs["uw_turb"].data,
-                                   grid.dzi4, grid.dzhi4);
-
-        calc_tke_budget(fields.u->data, fields.v->data, fields.w->data, fields.sd["p"]->data,
-                        fields.atmp["tmp1"]->data, fields.atmp["tmp2"]->data,
-                        umodel, vmodel,
-                        m->profs["u2_visc"].data, m->profs["v2_visc"].data, m->profs["w2_visc"].data, m->profs["tke_visc"].data, m->profs["uw_visc"].data,
-                        m->profs["u2_diss"].data, m->profs["v2_diss"].data, m->profs["w2_diss"].data, m->profs["tke_diss"].data, m->profs["uw_diss"].data,
-                        m->profs["w2_pres"].data, m->profs["tke_pres"].data, m->profs["uw_pres"].data,
-                        m->profs["u2_rdstr"].data, m->profs["v2_rdstr"].data, m->profs["w2_rdstr"].data, m->profs["uw_rdstr"].data,
-                        grid.dzi4, grid.dzhi4, fields.visc);
+        // calculate the kinetic energy
+        if (has_budget("ke"))
+            calc_ke(fields.u->data, fields.v->data, fields.w->data,
+                    umodel, vmodel,
+                    grid.utrans, grid.vtrans,
+                    m->profs["ke"].data, m->profs["tke"].data);
 
-        // calculate the buoyancy term of the TKE budget
-        if (thermo.get_switch() != "0")
+        // calculate the TKE budget
+        if (has_budget("tke"))
         {
-            // store the buoyancy in the tmp1 field
-            thermo.get_thermo_field(fields.atmp["tmp1"], fields.atmp["tmp2"], "b", true);
+            calc_tke_budget_shear_turb(fields.u->data, fields.v->data, fields.w->data,
+                                       fields.atmp["tmp1"]->data, fields.atmp["tmp2"]->data,
+                                       umodel, vmodel,
+                                       m->profs["u2_shear"].data, m->profs["v2_shear"].data, m->profs["tke_shear"].data, m->profs["uw_shear"].data,
+                                       m->profs["u2_turb"].data, m->profs["v2_turb"].data, m->profs["w2_turb"].data, m->profs["tke_turb"].data, m->profs["uw_turb"].data,
+                                       grid.dzi4, grid.dzhi4);
+
+            calc_tke_budget(fields.u->data, fields.v->data, fields.w->data, fields.sd["p"]->data,
+                            fields.atmp["tmp1"]->data, fields.atmp["tmp2"]->data,
+                            umodel, vmodel,
+                            m->profs["u2_visc"].data, m->profs["v2_visc"].data, m->profs["w2_visc"].data, m->profs["tke_visc"].data, m->profs["uw_visc"].data,
+                            m->profs["u2_diss"].data, m->profs["v2_diss"].data, m->profs["w2_diss"].data, m->profs["tke_diss"].data, m->profs["uw_diss"].data,
+                            m->profs["w2_pres"].data, m->profs["tke_pres"].data, m->profs["uw_pres"].data,
+                            m->profs["u2_rdstr"].data, m->profs["v2_rdstr"].data, m->profs["w2_rdstr"].data, m->profs["uw_rdstr"].data,
+                            grid.dzi4, grid.dzhi4, fields.visc);
+        }
+
+        // the remaining budgets need the buoyancy, which is computed only once
+        if (thermo.get_switch() == "0" || !(has_budget("tke") || has_budget("buoy") || has_budget("pe")))
+            return;
 
-            grid.calc_mean(fields.atmp["tmp1"]->datamean, fields.atmp["tmp1"]->data, grid.kcells);
-            grid.calc_mean(fields.sd["p"]->datamean, fields.sd["p"]->data, grid.kcells);
+        // store the buoyancy in the tmp1 field
+        thermo.get_thermo_field(fields.atmp["tmp1"], fields.atmp["tmp2"], "b", true);
 
+        grid.calc_mean(fields.atmp["tmp1"]->datamean, fields.atmp["tmp1"]->data, grid.kcells);
+        grid.calc_mean(fields.sd["p"]->datamean, fields.sd["p"]->data, grid.kcells);
+
+        // calculate the buoyancy term of the TKE budget
+        if (has_budget("tke"))
             calc_tke_budget_buoy(fields.u->data, fields.w->data, fields.atmp["tmp1"]->data,
                                  umodel, fields.atmp["tmp1"]->datamean,
                                  m->profs["w2_buoy"].data, m->profs["tke_buoy"].data, m->profs["uw_buoy"].data);
 
+        // calculate the buoyancy variance and flux budgets
+        if (has_budget("buoy"))
+        {
             calc_b2_budget(fields.w->data, fields.atmp["tmp1"]->data,
                            fields.atmp["tmp1"]->datamean,
                            m->profs["b2_shear"].data, m->profs["b2_turb"].data, m->profs["b2_visc"].data, m->profs["b2_diss"].data,
@@ -199,7 +219,7 @@ void Budget_4::exec_stats(Mask* m)
         }
 
         // calculate the potential energy budget
-        if (thermo.get_switch() != "0")
+        if (has_budget("pe"))
         {
             // calculate the sorted buoyancy profile, tmp1 still contains the buoyancy
             stats.calc_sorted_prof(fields.atmp["tmp1"]->data, fields.atmp["tmp2"]->data, m->profs["bsort"].data);
@@ -526,6 +546,7 @@ void Budget_4::calc_tke_budget_shear_turb(double* restrict u, double* restrict v
     for (int k=grid.kstart+1; k<grid.kend; ++k)
     {
         w2_turb[k] = 0.;
+        uw_turb[k] = 0.;
         for (int j=grid.jstart; j<grid.jend; ++j)
 #pragma ivdep
             for (int i=grid.istart; i<grid.iend; ++i)
@@ -546,6 +567,7 @@ void Budget_4::calc_tke_budget_shear_turb(double* restrict u, double* restrict v
 
     k = grid.kend;
     w2_turb[k] = 0.;
+    uw_turb[k] = 0.;
     for (int j=grid.jstart; j<grid.jend; ++j)
 #pragma ivdep
         for (int i=grid.istart; i<grid.iend; ++i)
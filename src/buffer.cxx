@@ -22,6 +22,7 @@
 
 #include <cstdio>
 #include <cmath>
+#include <algorithm>
 #include <stdlib.h>
 #include "master.h"
 #include "input.h"
@@ -79,6 +80,8 @@ void Buffer::init()
             // Allocate the buffer arrays.
             for (FieldMap::const_iterator it=fields->ap.begin(); it!=fields->ap.end(); ++it)
                 bufferprofs[it->first] = new double[grid->kcells];
+            for (FieldMap::const_iterator it=fields->sps.begin(); it!=fields->sps.end(); ++it)
+                bufferprofs[it->first] = new double[grid->kcells];
         }
     }
 }
@@ -130,6 +133,8 @@ void Buffer::create(Input* inputin)
 
             for (FieldMap::const_iterator it=fields->sp.begin(); it!=fields->sp.end(); ++it)
                 nerror += inputin->get_prof(&bufferprofs[it->first][grid->kstart], it->first, grid->kmax);
+            for (FieldMap::const_iterator it=fields->sps.begin(); it!=fields->sps.end(); ++it)
+                nerror += inputin->get_prof(&bufferprofs[it->first][grid->kstart], it->first, grid->kmax);
         }
     }
 
@@ -137,37 +142,61 @@ void Buffer::create(Input* inputin)
         throw 1;
 }
 
+void Buffer::shift_velocity(const double du, const double dv)
+{
+    // The runtime updated profiles follow the fields, only the profiles from the input have to be shifted.
+    if (swbuffer == "1" && swupdate == "0")
+    {
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            bufferprofs["u"][k] -= du;
+            bufferprofs["v"][k] -= dv;
+        }
+    }
+}
+
 #ifndef USECUDA
 void Buffer::exec()
 {
-    if (swbuffer == "1")
+    exec_block(grid->kstart, grid->kend);
+}
+#endif
+
+void Buffer::exec_block(const int kb, const int ke)
+{
+    if (swbuffer == "1" && ke > bufferkstart)
     {
         if (swupdate == "1")
         {
             // Calculate the buffer tendencies.
-            buffer(fields->mt["u"]->data, fields->mp["u"]->data, fields->mp["u"]->datamean, grid->z );
-            buffer(fields->mt["v"]->data, fields->mp["v"]->data, fields->mp["v"]->datamean, grid->z );
-            buffer(fields->mt["w"]->data, fields->mp["w"]->data, bufferprofs["w"]         , grid->zh);
+            buffer(fields->mt["u"]->data, fields->mp["u"]->data, fields->mp["u"]->datamean, grid->z , kb, ke);
+            buffer(fields->mt["v"]->data, fields->mp["v"]->data, fields->mp["v"]->datamean, grid->z , kb, ke);
+            buffer(fields->mt["w"]->data, fields->mp["w"]->data, bufferprofs["w"]         , grid->zh, kb, ke);
 
             for (FieldMap::const_iterator it=fields->sp.begin(); it!=fields->sp.end(); ++it)
-                buffer(fields->st[it->first]->data, it->second->data, it->second->datamean, grid->z);
+                buffer(fields->st[it->first]->data, it->second->data, it->second->datamean, grid->z, kb, ke);
+            for (FieldMap::const_iterator it=fields->sps.begin(); it!=fields->sps.end(); ++it)
+                buffer(fields->sts[it->first]->data, it->second->data_single, it->second->datamean, grid->z, kb, ke);
         }
         else
         {
             // Calculate the buffer tendencies.
-            buffer(fields->mt["u"]->data, fields->mp["u"]->data, bufferprofs["u"], grid->z );
-            buffer(fields->mt["v"]->data, fields->mp["v"]->data, bufferprofs["v"], grid->z );
-            buffer(fields->mt["w"]->data, fields->mp["w"]->data, bufferprofs["w"], grid->zh);
+            buffer(fields->mt["u"]->data, fields->mp["u"]->data, bufferprofs["u"], grid->z , kb, ke);
+            buffer(fields->mt["v"]->data, fields->mp["v"]->data, bufferprofs["v"], grid->z , kb, ke);
+            buffer(fields->mt["w"]->data, fields->mp["w"]->data, bufferprofs["w"], grid->zh, kb, ke);
 
             for (FieldMap::const_iterator it=fields->sp.begin(); it!=fields->sp.end(); ++it)
-                buffer(fields->st[it->first]->data, it->second->data, bufferprofs[it->first], grid->z);
+                buffer(fields->st[it->first]->data, it->second->data, bufferprofs[it->first], grid->z, kb, ke);
+            for (FieldMap::const_iterator it=fields->sps.begin(); it!=fields->sps.end(); ++it)
+                buffer(fields->sts[it->first]->data, it->second->data_single, bufferprofs[it->first], grid->z, kb, ke);
         }
     }
 }
-#endif
 
-void Buffer::buffer(double* const restrict at, const double* const restrict a, 
-                    const double* const restrict abuf, const double* const restrict z)
+template<typename T>
+void Buffer::buffer(double* const restrict at, const T* const restrict a, 
+                    const double* const restrict abuf, const double* const restrict z,
+                    const int kb, const int ke)
 { 
     const int jj = grid->icells;
     const int kk = grid->ijcells;
@@ -176,7 +205,7 @@ void Buffer::buffer(double* const restrict at, const double* const restrict a,
 
     double sigmaz;
 
-    for (int k=bufferkstart; k<grid->kend; ++k)
+    for (int k=std::max(kb, bufferkstart); k<ke; ++k)
     {
         sigmaz = this->sigma*std::pow((z[k]-this->zstart)/zsizebuf, this->beta);
         for (int j=grid->jstart; j<grid->jend; ++j)
@@ -0,0 +1,375 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2017 Chiel van Heerwaarden
+ * Copyright (c) 2011-2017 Thijs Heus
+ * Copyright (c) 2014-2017 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <netcdf.h>     // C, for sync() using older netCDF-C++ versions
+#include "master.h"
+#include "grid.h"
+#include "fields.h"
+#include "column.h"
+#include "model.h"
+#include "timeloop.h"
+#include "constants.h"
+#include "defines.h"
+
+using namespace netCDF::exceptions;
+
+Column::Column(Model* modelin, Input* inputin)
+{
+    model  = modelin;
+    grid   = model->grid;
+    fields = model->fields;
+    master = model->master;
+
+    dataFile = 0;
+    nsamples = 0;
+    nwritten = 0;
+
+    int nerror = 0;
+    nerror += inputin->get_item(&swcolumn, "column", "swcolumn", "", "0");
+
+    if (swcolumn == "1")
+    {
+        nerror += inputin->get_item(&sampletime, "column", "sampletime", "", 0.);
+        nerror += inputin->get_item(&nbuffer   , "column", "nbuffer"   , "", 100);
+        nerror += inputin->get_list(&xcol      , "column", "x"         , "");
+        nerror += inputin->get_list(&ycol      , "column", "y"         , "");
+        nerror += inputin->get_list(&columnlist, "column", "columnlist", "");
+    }
+
+    if (nerror)
+        throw 1;
+}
+
+Column::~Column()
+{
+    delete dataFile;
+}
+
+void Column::init(double ifactor)
+{
+    if (swcolumn == "0")
+        return;
+
+    int nerror = 0;
+
+    if (xcol.size() != ycol.size())
+    {
+        master->print_error("[column][x] and [column][y] need to have the same number of elements\n");
+        ++nerror;
+    }
+    if (nbuffer < 1)
+    {
+        master->print_error("[column][nbuffer] needs to be at least 1\n");
+        ++nerror;
+    }
+
+    if (nerror)
+        throw 1;
+
+    // A sample time of zero samples every full time step without limiting the time step.
+    isampletime = (unsigned long)(ifactor * sampletime);
+
+    // Find the columns that are owned by this process, the grid spacing is not set yet.
+    const double dx = grid->xsize / grid->itot;
+    const double dy = grid->ysize / grid->jtot;
+
+    colproc.resize(master->nprocs);
+
+    for (int n=0; n<static_cast<int>(xcol.size()); ++n)
+    {
+        if (xcol[n] < 0. || xcol[n] >= grid->xsize || ycol[n] < 0. || ycol[n] >= grid->ysize)
+        {
+            master->print_error("column at x=%f, y=%f is outside of the domain\n", xcol[n], ycol[n]);
+            ++nerror;
+            continue;
+        }
+
+        const int ig = (int) floor(xcol[n]/dx);
+        const int jg = (int) floor(ycol[n]/dy);
+
+        // Store the owner of each column to be able to sort the gathered columns on the master.
+        colproc[ig/grid->imax + (jg/grid->jmax)*master->npx].push_back(n);
+
+        if (ig / grid->imax == master->mpicoordx && jg / grid->jmax == master->mpicoordy)
+        {
+            ncol.push_back(n);
+            icol.push_back(ig % grid->imax + grid->istart);
+            jcol.push_back(jg % grid->jmax + grid->jstart);
+        }
+    }
+
+    if (nerror)
+        throw 1;
+
+    tbuf   .resize(nbuffer);
+    iterbuf.resize(nbuffer);
+
+#ifdef USECUDA
+    if (isampletime == 0)
+        master->print_warning("[column][sampletime] = 0 copies all fields from the GPU every full time step\n");
+#endif
+}
+
+void Column::create(int n)
+{
+    if (swcolumn == "0")
+        return;
+
+    int nerror = 0;
+
+    for (std::vector<std::string>::const_iterator it=columnlist.begin(); it!=columnlist.end(); ++it)
+    {
+        if (!fields->a.count(*it))
+        {
+            master->print_error("field %s in [column][columnlist] is illegal\n", it->c_str());
+            ++nerror;
+        }
+    }
+
+    if (nerror)
+        throw 1;
+
+    // Each process buffers only its own columns, the master also keeps space to sort all of them.
+    for (std::vector<std::string>::const_iterator it=columnlist.begin(); it!=columnlist.end(); ++it)
+        buffer[*it].resize(nbuffer*ncol.size()*get_nlevels(*it));
+
+    if (master->mpiid == 0)
+    {
+        recvbuf.resize(nbuffer*xcol.size()*(grid->kmax+1));
+        filebuf.resize(nbuffer*xcol.size()*(grid->kmax+1));
+    }
+
+    // Create a single NetCDF file for all columns.
+    if (master->mpiid == 0)
+    {
+        std::stringstream filename;
+        filename << master->simname << "." << "column" << "." << std::setfill('0') << std::setw(7) << n << ".nc";
+
+        try
+        {
+            dataFile = new NcFile(filename.str(), NcFile::newFile);
+        }
+        catch(NcException& e)
+        {
+            master->print_error("NetCDF exception: %s\n",e.what());
+            ++nerror;
+        }
+    }
+
+    // Crash on all processes in case the file could not be written
+    master->broadcast(&nerror, 1);
+    if (nerror)
+        throw 1;
+
+    if (master->mpiid == 0)
+    {
+        NcDim z_dim  = dataFile->addDim("z" , grid->kmax);
+        NcDim zh_dim = dataFile->addDim("zh", grid->kmax+1);
+        NcDim c_dim  = dataFile->addDim("column", xcol.size());
+        NcDim t_dim  = dataFile->addDim("t");
+
+        iter_var = dataFile->addVar("iter", ncInt, t_dim);
+        iter_var.putAtt("units", "-");
+        iter_var.putAtt("long_name", "Iteration number");
+
+        t_var = dataFile->addVar("t", ncDouble, t_dim);
+        t_var.putAtt("units", "s");
+        t_var.putAtt("long_name", "Time");
+
+        NcVar x_var = dataFile->addVar("x", ncDouble, c_dim);
+        x_var.putAtt("units", "m");
+        x_var.putAtt("long_name", "X-position of the column");
+
+        NcVar y_var = dataFile->addVar("y", ncDouble, c_dim);
+        y_var.putAtt("units", "m");
+        y_var.putAtt("long_name", "Y-position of the column");
+
+        NcVar z_var = dataFile->addVar("z", ncDouble, z_dim);
+        z_var.putAtt("units", "m");
+        z_var.putAtt("long_name", "Full level height");
+
+        NcVar zh_var = dataFile->addVar("zh", ncDouble, zh_dim);
+        zh_var.putAtt("units", "m");
+        zh_var.putAtt("long_name", "Half level height");
+
+        for (std::vector<std::string>::const_iterator it=columnlist.begin(); it!=columnlist.end(); ++it)
+        {
+            std::vector<NcDim> dim_vector = {t_dim, c_dim};
+            dim_vector.push_back(*it == "w" ? zh_dim : z_dim);
+
+            ncvars[*it] = dataFile->addVar(it->c_str(), ncDouble, dim_vector);
+            ncvars[*it].putAtt("units", fields->a[*it]->unit.c_str());
+            ncvars[*it].putAtt("long_name", fields->a[*it]->longname.c_str());
+        }
+
+        x_var .putVar(&xcol[0]);
+        y_var .putVar(&ycol[0]);
+        z_var .putVar(&grid->z [grid->kstart]);
+        zh_var.putVar(&grid->zh[grid->kstart]);
+
+        // Synchronize the NetCDF file
+        nc_sync(dataFile->getId());
+    }
+}
+
+unsigned long Column::get_time_limit(unsigned long itime)
+{
+    if (swcolumn == "0" || isampletime == 0)
+        return Constants::ulhuge;
+
+    return isampletime - itime % isampletime;
+}
+
+std::string Column::get_switch()
+{
+    return swcolumn;
+}
+
+bool Column::do_column()
+{
+    if (swcolumn == "0")
+        return false;
+
+    if (isampletime == 0 || model->timeloop->get_itime() % isampletime == 0)
+        return true;
+    else
+        return false;
+}
+
+int Column::get_nlevels(std::string name)
+{
+    // The vertical velocity is stored at the half levels, all other fields at the full levels.
+    return (name == "w") ? grid->kmax+1 : grid->kmax;
+}
+
+void Column::exec(int iteration, double time)
+{
+    const int ii = 1;
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+    const int nlocal = ncol.size();
+
+    tbuf   [nsamples] = time;
+    iterbuf[nsamples] = iteration;
+
+    // Only the processes that own a column extract it.
+    for (std::vector<std::string>::const_iterator it=columnlist.begin(); it!=columnlist.end(); ++it)
+    {
+        const Field3d* field = fields->a[*it];
+        const int nlev = get_nlevels(*it);
+
+        // Interpolate the horizontal velocities to the cell centers and add the transformation velocity.
+        int ioff = 0;
+        double offset = 0.;
+        if (*it == "u")
+        {
+            ioff = ii;
+            offset = grid->utrans;
+        }
+        else if (*it == "v")
+        {
+            ioff = jj;
+            offset = grid->vtrans;
+        }
+
+        for (int n=0; n<nlocal; ++n)
+        {
+            double* restrict col = &buffer[*it][(nsamples*nlocal + n)*nlev];
+            const int ij = icol[n] + jcol[n]*jj;
+
+            for (int k=0; k<nlev; ++k)
+            {
+                const int ijk = ij + (k+grid->kstart)*kk;
+                if (field->is_single)
+                    col[k] = 0.5*((double)field->data_single[ijk] + (double)field->data_single[ijk+ioff]) + offset;
+                else
+                    col[k] = 0.5*(field->data[ijk] + field->data[ijk+ioff]) + offset;
+            }
+        }
+    }
+
+    ++nsamples;
+
+    if (nsamples == nbuffer)
+        save();
+}
+
+void Column::save()
+{
+    if (swcolumn == "0" || nsamples == 0)
+        return;
+
+    const int ncols  = xcol.size();
+    const int nlocal = ncol.size();
+
+    if (master->mpiid == 0)
+    {
+        const std::vector<size_t> time_index = {static_cast<size_t>(nwritten)};
+        const std::vector<size_t> time_size  = {static_cast<size_t>(nsamples)};
+
+        t_var   .putVar(time_index, time_size, &tbuf[0]);
+        iter_var.putVar(time_index, time_size, &iterbuf[0]);
+    }
+
+    std::vector<int> recvsizes(master->nprocs);
+
+    for (std::vector<std::string>::const_iterator it=columnlist.begin(); it!=columnlist.end(); ++it)
+    {
+        const int nlev = get_nlevels(*it);
+
+        // Collect the owned columns on the master process, ordered by process.
+        for (int p=0; p<master->nprocs; ++p)
+            recvsizes[p] = nsamples*colproc[p].size()*nlev;
+
+        master->gather(buffer[*it].data(), nsamples*nlocal*nlev, recvbuf.data(), &recvsizes[0]);
+
+        if (master->mpiid == 0)
+        {
+            // Sort the columns into the order of the file.
+            int offset = 0;
+            for (int p=0; p<master->nprocs; ++p)
+                for (int n=0; n<nsamples; ++n)
+                    for (std::vector<int>::const_iterator itc=colproc[p].begin(); itc!=colproc[p].end(); ++itc)
+                    {
+                        std::copy(&recvbuf[offset], &recvbuf[offset+nlev], &filebuf[(n*ncols + *itc)*nlev]);
+                        offset += nlev;
+                    }
+
+            const std::vector<size_t> index = {static_cast<size_t>(nwritten), 0, 0};
+            const std::vector<size_t> size  = {static_cast<size_t>(nsamples), static_cast<size_t>(ncols),
+                                               static_cast<size_t>(nlev)};
+            ncvars[*it].putVar(index, size, &filebuf[0]);
+        }
+    }
+
+    // Synchronize the NetCDF file
+    if (master->mpiid == 0)
+        nc_sync(dataFile->getId());
+
+    nwritten += nsamples;
+    nsamples = 0;
+}
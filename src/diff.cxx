@@ -93,7 +93,29 @@ Diff* Diff::factory(Master* masterin, Input* inputin, Model* modelin, const std:
     }
 }
 
+double Diff::get_dnmul_local()
+{
+    // Schemes with a constant viscosity do not need a reduction.
+    return 0.;
+}
+
+unsigned long Diff::get_time_limit_reduced(const unsigned long idt, const double dt, const double dnmul)
+{
+    return get_time_limit(idt, dt);
+}
+
+void Diff::exec_block(const int kb, const int ke)
+{
+    master->print_error("swdiff=%s does not support the fused tendency sweep\n", swdiff.c_str());
+    throw 1;
+}
+
 std::string Diff::get_switch()
 {
     return swdiff;
 }
+
+void Diff::exec_implicit()
+{
+    // Schemes without implicit terms have nothing to do here.
+}
@@ -23,6 +23,7 @@
 #include <cstdio>
 #include <cmath>
 #include <algorithm>
+#include <vector>
 #include "grid.h"
 #include "fields.h"
 #include "master.h"
@@ -45,6 +46,8 @@ void Diff_2::set_values()
     double viscmax = fields->visc;
     for (FieldMap::iterator it = fields->sp.begin(); it!=fields->sp.end(); it++)
         viscmax = std::max(it->second->visc, viscmax);
+    for (FieldMap::iterator it = fields->sps.begin(); it!=fields->sps.end(); it++)
+        viscmax = std::max(it->second->visc, viscmax);
 
     dnmul = 0;
     for (int k=grid->kstart; k<grid->kend; k++)
@@ -64,41 +67,61 @@ double Diff_2::get_dn(const double dt)
 #ifndef USECUDA
 void Diff_2::exec()
 {
-    diff_c(fields->ut->data, fields->u->data, grid->dzi, grid->dzhi, fields->visc);
-    diff_c(fields->vt->data, fields->v->data, grid->dzi, grid->dzhi, fields->visc);
-    diff_w(fields->wt->data, fields->w->data, grid->dzi, grid->dzhi, fields->visc);
-
-    for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-        diff_c(it->second->data, fields->sp[it->first]->data, grid->dzi, grid->dzhi, fields->sp[it->first]->visc);
+    exec_block(grid->kstart, grid->kend);
 }
 #endif
 
-void Diff_2::diff_c(double* restrict at, double* restrict a, double* restrict dzi, double* restrict dzhi, double visc)
+void Diff_2::exec_block(const int kb, const int ke)
+{
+    diff_c(fields->ut->data, fields->u->data, 1, grid->dzi, grid->dzhi, &fields->visc, kb, ke);
+    diff_c(fields->vt->data, fields->v->data, 1, grid->dzi, grid->dzhi, &fields->visc, kb, ke);
+    diff_w(fields->wt->data, fields->w->data, grid->dzi, grid->dzhi, fields->visc, kb, ke);
+
+    // packed scalars
+    if (!fields->sp.empty())
+    {
+        std::vector<double> svisc;
+        for (FieldMap::const_iterator it = fields->sp.begin(); it!=fields->sp.end(); it++)
+            svisc.push_back(it->second->visc);
+        diff_c(fields->st_packed, fields->sp_packed, fields->sp.size(), grid->dzi, grid->dzhi, &svisc[0], kb, ke);
+    }
+
+    for (FieldMap::const_iterator it = fields->sts.begin(); it!=fields->sts.end(); it++)
+        diff_c(it->second->data, fields->sps[it->first]->data_single, 1, grid->dzi, grid->dzhi, &fields->sps[it->first]->visc, kb, ke);
+}
+
+template<typename T>
+void Diff_2::diff_c(double* restrict at, T* restrict a, const int ns, double* restrict dzi, double* restrict dzhi, const double* restrict visc,
+                    const int kb, const int ke)
 {
     const int ii = 1;
     const int jj = grid->icells;
     const int kk = grid->ijcells;
+    const long nn = grid->ncells;
 
     const double dxidxi = 1./(grid->dx * grid->dx);
     const double dyidyi = 1./(grid->dy * grid->dy);
 
-    for (int k=grid->kstart; k<grid->kend; k++)
+    for (int k=kb; k<ke; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
+            for (int n=0; n<ns; ++n)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                at[ijk] += visc * (
-                        + ( (a[ijk+ii] - a[ijk   ]) 
-                          - (a[ijk   ] - a[ijk-ii]) ) * dxidxi 
-                        + ( (a[ijk+jj] - a[ijk   ]) 
-                          - (a[ijk   ] - a[ijk-jj]) ) * dyidyi
-                        + ( (a[ijk+kk] - a[ijk   ]) * dzhi[k+1]
-                          - (a[ijk   ] - a[ijk-kk]) * dzhi[k]   ) * dzi[k] );
-            }
+                for (int i=grid->istart; i<grid->iend; i++)
+                {
+                    const int ijk  = i + j*jj + k*kk;
+                    const long ijkn = ijk + n*nn;
+                    at[ijkn] += visc[n] * (
+                             + ( (a[ijkn+ii] - a[ijkn   ]) 
+                               - (a[ijkn   ] - a[ijkn-ii]) ) * dxidxi 
+                             + ( (a[ijkn+jj] - a[ijkn   ]) 
+                               - (a[ijkn   ] - a[ijkn-jj]) ) * dyidyi
+                             + ( (a[ijkn+kk] - a[ijkn   ]) * dzhi[k+1]
+                               - (a[ijkn   ] - a[ijkn-kk]) * dzhi[k]   ) * dzi[k] );
+                }
 }
 
-void Diff_2::diff_w(double* restrict wt, double* restrict w, double* restrict dzi, double* restrict dzhi, double visc)
+void Diff_2::diff_w(double* restrict wt, double* restrict w, double* restrict dzi, double* restrict dzhi, double visc,
+                    const int kb, const int ke)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -107,7 +130,7 @@ void Diff_2::diff_w(double* restrict wt, double* restrict w, double* restrict dz
     const double dxidxi = 1./(grid->dx*grid->dx);
     const double dyidyi = 1./(grid->dy*grid->dy);
 
-    for (int k=grid->kstart+1; k<grid->kend; k++)
+    for (int k=std::max(kb, grid->kstart+1); k<ke; k++)
         for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; i++)
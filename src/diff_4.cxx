@@ -23,6 +23,7 @@
 #include <cstdio>
 #include <cmath>
 #include <algorithm>
+#include <vector>
 #include "grid.h"
 #include "fields.h"
 #include "master.h"
@@ -48,6 +49,8 @@ void Diff_4::set_values()
     double viscmax = fields->visc;
     for (FieldMap::iterator it = fields->sp.begin(); it!=fields->sp.end(); it++)
         viscmax = std::max(it->second->visc, viscmax);
+    for (FieldMap::iterator it = fields->sps.begin(); it!=fields->sps.end(); it++)
+        viscmax = std::max(it->second->visc, viscmax);
 
     dnmul = 0;
     for (int k=grid->kstart; k<grid->kend; k++)
@@ -67,30 +70,41 @@ double Diff_4::get_dn(double dt)
 #ifndef USECUDA
 void Diff_4::exec()
 {
+    // packed scalars
+    std::vector<double> svisc;
+    for (FieldMap::const_iterator it = fields->sp.begin(); it!=fields->sp.end(); it++)
+        svisc.push_back(it->second->visc);
+
     // In case of a two-dimensional run, strip v component out of all kernels and do 
     // not calculate v-diffusion tendency.
     if (grid->jtot == 1)
     {
-        diff_c<false>(fields->ut->data, fields->u->data, grid->dzi4, grid->dzhi4, fields->visc);
+        diff_c<false>(fields->ut->data, fields->u->data, 1, grid->dzi4, grid->dzhi4, &fields->visc);
         diff_w<false>(fields->wt->data, fields->w->data, grid->dzi4, grid->dzhi4, fields->visc);
 
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-            diff_c<false>(it->second->data, fields->sp[it->first]->data, grid->dzi4, grid->dzhi4, fields->sp[it->first]->visc);
+        if (!fields->sp.empty())
+            diff_c<false>(fields->st_packed, fields->sp_packed, fields->sp.size(), grid->dzi4, grid->dzhi4, &svisc[0]);
+
+        for (FieldMap::const_iterator it = fields->sts.begin(); it!=fields->sts.end(); it++)
+            diff_c<false>(it->second->data, fields->sps[it->first]->data_single, 1, grid->dzi4, grid->dzhi4, &fields->sps[it->first]->visc);
     }
     else
     {
-        diff_c<true>(fields->ut->data, fields->u->data, grid->dzi4, grid->dzhi4, fields->visc);
-        diff_c<true>(fields->vt->data, fields->v->data, grid->dzi4, grid->dzhi4, fields->visc);
+        diff_c<true>(fields->ut->data, fields->u->data, 1, grid->dzi4, grid->dzhi4, &fields->visc);
+        diff_c<true>(fields->vt->data, fields->v->data, 1, grid->dzi4, grid->dzhi4, &fields->visc);
         diff_w<true>(fields->wt->data, fields->w->data, grid->dzi4, grid->dzhi4, fields->visc);
 
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); it++)
-            diff_c<true>(it->second->data, fields->sp[it->first]->data, grid->dzi4, grid->dzhi4, fields->sp[it->first]->visc);
+        if (!fields->sp.empty())
+            diff_c<true>(fields->st_packed, fields->sp_packed, fields->sp.size(), grid->dzi4, grid->dzhi4, &svisc[0]);
+
+        for (FieldMap::const_iterator it = fields->sts.begin(); it!=fields->sts.end(); it++)
+            diff_c<true>(it->second->data, fields->sps[it->first]->data_single, 1, grid->dzi4, grid->dzhi4, &fields->sps[it->first]->visc);
     }
 }
 #endif
 
-template<bool dim3>
-void Diff_4::diff_c(double* restrict at, double* restrict a, double* restrict dzi4, double* restrict dzhi4, const double visc)
+template<bool dim3, typename T>
+void Diff_4::diff_c(double* restrict at, T* restrict a, const int ns, double* restrict dzi4, double* restrict dzhi4, const double* restrict visc)
 {
     const int ii1 = 1;
     const int ii2 = 2;
@@ -101,6 +115,7 @@ void Diff_4::diff_c(double* restrict at, double* restrict a, double* restrict dz
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
     const int kk3 = 3*grid->ijcells;
+    const long nn  = grid->ncells;
 
     const int kstart = grid->kstart;
     const int kend   = grid->kend;
@@ -110,51 +125,57 @@ void Diff_4::diff_c(double* restrict at, double* restrict a, double* restrict dz
 
     // bottom boundary
     for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
-        {
-            const int ijk = i + j*jj1 + kstart*kk1;
-            at[ijk] += visc * (cdg3*a[ijk-ii3] + cdg2*a[ijk-ii2] + cdg1*a[ijk-ii1] + cdg0*a[ijk] + cdg1*a[ijk+ii1] + cdg2*a[ijk+ii2] + cdg3*a[ijk+ii3])*dxidxi;
-            if (dim3)
-                at[ijk] += visc * (cdg3*a[ijk-jj3] + cdg2*a[ijk-jj2] + cdg1*a[ijk-jj1] + cdg0*a[ijk] + cdg1*a[ijk+jj1] + cdg2*a[ijk+jj2] + cdg3*a[ijk+jj3])*dyidyi;
-            at[ijk] += visc * ( cg0*(bg0*a[ijk-kk2] + bg1*a[ijk-kk1] + bg2*a[ijk    ] + bg3*a[ijk+kk1]) * dzhi4[kstart-1]
-                              + cg1*(cg0*a[ijk-kk2] + cg1*a[ijk-kk1] + cg2*a[ijk    ] + cg3*a[ijk+kk1]) * dzhi4[kstart  ]
-                              + cg2*(cg0*a[ijk-kk1] + cg1*a[ijk    ] + cg2*a[ijk+kk1] + cg3*a[ijk+kk2]) * dzhi4[kstart+1]
-                              + cg3*(cg0*a[ijk    ] + cg1*a[ijk+kk1] + cg2*a[ijk+kk2] + cg3*a[ijk+kk3]) * dzhi4[kstart+2] )
-                            * dzi4[kstart];
-        }
-
-    for (int k=grid->kstart+1; k<grid->kend-1; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
+        for (int n=0; n<ns; ++n)
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; i++)
             {
-                const int ijk = i + j*jj1 + k*kk1;
-                at[ijk] += visc * (cdg3*a[ijk-ii3] + cdg2*a[ijk-ii2] + cdg1*a[ijk-ii1] + cdg0*a[ijk] + cdg1*a[ijk+ii1] + cdg2*a[ijk+ii2] + cdg3*a[ijk+ii3])*dxidxi;
+                const int ijk  = i + j*jj1 + kstart*kk1;
+                const long ijkn = ijk + n*nn;
+                at[ijkn] += visc[n] * (cdg3*a[ijkn-ii3] + cdg2*a[ijkn-ii2] + cdg1*a[ijkn-ii1] + cdg0*a[ijkn] + cdg1*a[ijkn+ii1] + cdg2*a[ijkn+ii2] + cdg3*a[ijkn+ii3])*dxidxi;
                 if (dim3)
-                    at[ijk] += visc * (cdg3*a[ijk-jj3] + cdg2*a[ijk-jj2] + cdg1*a[ijk-jj1] + cdg0*a[ijk] + cdg1*a[ijk+jj1] + cdg2*a[ijk+jj2] + cdg3*a[ijk+jj3])*dyidyi;
-                at[ijk] += visc * ( cg0*(cg0*a[ijk-kk3] + cg1*a[ijk-kk2] + cg2*a[ijk-kk1] + cg3*a[ijk    ]) * dzhi4[k-1]
-                                  + cg1*(cg0*a[ijk-kk2] + cg1*a[ijk-kk1] + cg2*a[ijk    ] + cg3*a[ijk+kk1]) * dzhi4[k  ]
-                                  + cg2*(cg0*a[ijk-kk1] + cg1*a[ijk    ] + cg2*a[ijk+kk1] + cg3*a[ijk+kk2]) * dzhi4[k+1]
-                                  + cg3*(cg0*a[ijk    ] + cg1*a[ijk+kk1] + cg2*a[ijk+kk2] + cg3*a[ijk+kk3]) * dzhi4[k+2] )
-                                * dzi4[k];
+                    at[ijkn] += visc[n] * (cdg3*a[ijkn-jj3] + cdg2*a[ijkn-jj2] + cdg1*a[ijkn-jj1] + cdg0*a[ijkn] + cdg1*a[ijkn+jj1] + cdg2*a[ijkn+jj2] + cdg3*a[ijkn+jj3])*dyidyi;
+                at[ijkn] += visc[n] * ( cg0*(bg0*a[ijkn-kk2] + bg1*a[ijkn-kk1] + bg2*a[ijkn    ] + bg3*a[ijkn+kk1]) * dzhi4[kstart-1]
+                                   + cg1*(cg0*a[ijkn-kk2] + cg1*a[ijkn-kk1] + cg2*a[ijkn    ] + cg3*a[ijkn+kk1]) * dzhi4[kstart  ]
+                                   + cg2*(cg0*a[ijkn-kk1] + cg1*a[ijkn    ] + cg2*a[ijkn+kk1] + cg3*a[ijkn+kk2]) * dzhi4[kstart+1]
+                                   + cg3*(cg0*a[ijkn    ] + cg1*a[ijkn+kk1] + cg2*a[ijkn+kk2] + cg3*a[ijkn+kk3]) * dzhi4[kstart+2] )
+                                 * dzi4[kstart];
             }
 
+    for (int k=grid->kstart+1; k<grid->kend-1; k++)
+        for (int j=grid->jstart; j<grid->jend; j++)
+            for (int n=0; n<ns; ++n)
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; i++)
+                {
+                    const int ijk  = i + j*jj1 + k*kk1;
+                    const long ijkn = ijk + n*nn;
+                    at[ijkn] += visc[n] * (cdg3*a[ijkn-ii3] + cdg2*a[ijkn-ii2] + cdg1*a[ijkn-ii1] + cdg0*a[ijkn] + cdg1*a[ijkn+ii1] + cdg2*a[ijkn+ii2] + cdg3*a[ijkn+ii3])*dxidxi;
+                    if (dim3)
+                        at[ijkn] += visc[n] * (cdg3*a[ijkn-jj3] + cdg2*a[ijkn-jj2] + cdg1*a[ijkn-jj1] + cdg0*a[ijkn] + cdg1*a[ijkn+jj1] + cdg2*a[ijkn+jj2] + cdg3*a[ijkn+jj3])*dyidyi;
+                    at[ijkn] += visc[n] * ( cg0*(cg0*a[ijkn-kk3] + cg1*a[ijkn-kk2] + cg2*a[ijkn-kk1] + cg3*a[ijkn    ]) * dzhi4[k-1]
+                                       + cg1*(cg0*a[ijkn-kk2] + cg1*a[ijkn-kk1] + cg2*a[ijkn    ] + cg3*a[ijkn+kk1]) * dzhi4[k  ]
+                                       + cg2*(cg0*a[ijkn-kk1] + cg1*a[ijkn    ] + cg2*a[ijkn+kk1] + cg3*a[ijkn+kk2]) * dzhi4[k+1]
+                                       + cg3*(cg0*a[ijkn    ] + cg1*a[ijkn+kk1] + cg2*a[ijkn+kk2] + cg3*a[ijkn+kk3]) * dzhi4[k+2] )
+                                     * dzi4[k];
+                }
+
     // top boundary
     for (int j=grid->jstart; j<grid->jend; j++)
+        for (int n=0; n<ns; ++n)
 #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
-        {
-            const int ijk = i + j*jj1 + (kend-1)*kk1;
-            at[ijk] += visc * (cdg3*a[ijk-ii3] + cdg2*a[ijk-ii2] + cdg1*a[ijk-ii1] + cdg0*a[ijk] + cdg1*a[ijk+ii1] + cdg2*a[ijk+ii2] + cdg3*a[ijk+ii3])*dxidxi;
-            if (dim3)
-                at[ijk] += visc * (cdg3*a[ijk-jj3] + cdg2*a[ijk-jj2] + cdg1*a[ijk-jj1] + cdg0*a[ijk] + cdg1*a[ijk+jj1] + cdg2*a[ijk+jj2] + cdg3*a[ijk+jj3])*dyidyi;
-            at[ijk] += visc * ( cg0*(cg0*a[ijk-kk3] + cg1*a[ijk-kk2] + cg2*a[ijk-kk1] + cg3*a[ijk    ]) * dzhi4[kend-2]
-                              + cg1*(cg0*a[ijk-kk2] + cg1*a[ijk-kk1] + cg2*a[ijk    ] + cg3*a[ijk+kk1]) * dzhi4[kend-1]
-                              + cg2*(cg0*a[ijk-kk1] + cg1*a[ijk    ] + cg2*a[ijk+kk1] + cg3*a[ijk+kk2]) * dzhi4[kend  ]
-                              + cg3*(tg0*a[ijk-kk1] + tg1*a[ijk    ] + tg2*a[ijk+kk1] + tg3*a[ijk+kk2]) * dzhi4[kend+1] )
-                            * dzi4[kend-1];
-        }
+            for (int i=grid->istart; i<grid->iend; i++)
+            {
+                const int ijk  = i + j*jj1 + (kend-1)*kk1;
+                const long ijkn = ijk + n*nn;
+                at[ijkn] += visc[n] * (cdg3*a[ijkn-ii3] + cdg2*a[ijkn-ii2] + cdg1*a[ijkn-ii1] + cdg0*a[ijkn] + cdg1*a[ijkn+ii1] + cdg2*a[ijkn+ii2] + cdg3*a[ijkn+ii3])*dxidxi;
+                if (dim3)
+                    at[ijkn] += visc[n] * (cdg3*a[ijkn-jj3] + cdg2*a[ijkn-jj2] + cdg1*a[ijkn-jj1] + cdg0*a[ijkn] + cdg1*a[ijkn+jj1] + cdg2*a[ijkn+jj2] + cdg3*a[ijkn+jj3])*dyidyi;
+                at[ijkn] += visc[n] * ( cg0*(cg0*a[ijkn-kk3] + cg1*a[ijkn-kk2] + cg2*a[ijkn-kk1] + cg3*a[ijkn    ]) * dzhi4[kend-2]
+                                   + cg1*(cg0*a[ijkn-kk2] + cg1*a[ijkn-kk1] + cg2*a[ijkn    ] + cg3*a[ijkn+kk1]) * dzhi4[kend-1]
+                                   + cg2*(cg0*a[ijkn-kk1] + cg1*a[ijkn    ] + cg2*a[ijkn+kk1] + cg3*a[ijkn+kk2]) * dzhi4[kend  ]
+                                   + cg3*(tg0*a[ijkn-kk1] + tg1*a[ijkn    ] + tg2*a[ijkn+kk1] + tg3*a[ijkn+kk2]) * dzhi4[kend+1] )
+                                 * dzi4[kend-1];
+            }
 }
 
 template<bool dim3>
@@ -23,6 +23,7 @@
 #include <cstdio>
 #include <cmath>
 #include <algorithm>
+#include <vector>
 #include "grid.h"
 #include "fields.h"
 #include "master.h"
@@ -32,6 +33,7 @@
 #include "constants.h"
 #include "thermo.h"
 #include "model.h"
+#include "timeloop.h"
 #include "monin_obukhov.h"
 
 namespace
@@ -43,6 +45,8 @@ Diff_smag_2::Diff_smag_2(Model* modelin, Input* inputin) : Diff(modelin, inputin
 {
     swdiff = "smag2";
 
+    implicit_work = 0;
+
     #ifdef USECUDA
     mlen_g = 0;
     #endif
@@ -53,34 +57,73 @@ Diff_smag_2::Diff_smag_2(Model* modelin, Input* inputin) : Diff(modelin, inputin
     nerror += inputin->get_item(&dnmax, "diff", "dnmax", "", 0.5  );
     nerror += inputin->get_item(&cs   , "diff", "cs"   , "", 0.23 );
     nerror += inputin->get_item(&tPr  , "diff", "tPr"  , "", 1./3.);
+    nerror += inputin->get_item(&swimplicit, "diff", "swimplicit", "", "0");
 
     if (nerror)
         throw 1;
+
+    #ifdef USECUDA
+    if (swimplicit == "1")
+    {
+        master->print_error("swimplicit=1 is not supported on the GPU\n");
+        throw 1;
+    }
+    #endif
 }
 
 Diff_smag_2::~Diff_smag_2()
 {
+    delete[] implicit_work;
+
 #ifdef USECUDA
     clear_device();
 #endif
 }
 
+void Diff_smag_2::set_values()
+{
+    if (swimplicit == "1")
+    {
+        // The vertical fluxes at the wall are only explicit if they follow from the surface model.
+        if (model->boundary->get_switch() != "surface")
+        {
+            master->print_error("swimplicit=1 requires swboundary=surface\n");
+            throw 1;
+        }
+
+        implicit_work = new double[4*grid->icells*grid->kcells];
+    }
+}
+
 #ifndef USECUDA
 unsigned long Diff_smag_2::get_time_limit(const unsigned long idt, const double dt)
 {
     double dnmul = calc_dnmul(fields->sd["evisc"]->data, grid->dzi, this->tPr);
+    grid->get_max(&dnmul);
+
+    return get_time_limit_reduced(idt, dt, dnmul);
+}
+#endif
+
+double Diff_smag_2::get_dnmul_local()
+{
+    return calc_dnmul(fields->sd["evisc"]->data, grid->dzi, this->tPr);
+}
+
+unsigned long Diff_smag_2::get_time_limit_reduced(const unsigned long idt, const double dt, double dnmul)
+{
     // Avoid zero division.
     dnmul = std::max(Constants::dsmall, dnmul);
 
     return idt * dnmax/(dnmul*dt);
 }
-#endif
 
 #ifndef USECUDA
 double Diff_smag_2::get_dn(const double dt)
 {
     // calculate eddy viscosity
-    const double dnmul = calc_dnmul(fields->sd["evisc"]->data, grid->dzi, this->tPr);
+    double dnmul = calc_dnmul(fields->sd["evisc"]->data, grid->dzi, this->tPr);
+    grid->get_max(&dnmul);
 
     return dnmul*dt;
 }
@@ -146,35 +189,50 @@ void Diff_smag_2::exec_viscosity()
 #ifndef USECUDA
 void Diff_smag_2::exec()
 {
-    if(model->boundary->get_switch() == "surface")
+    exec_block(grid->kstart, grid->kend);
+}
+#endif
+
+void Diff_smag_2::exec_block(const int kb, const int ke)
+{
+    if (model->boundary->get_switch() == "surface")
     {
-        diff_u<false>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->u->datafluxbot, fields->u->datafluxtop, fields->rhoref, fields->rhorefh);
-        diff_v<false>(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->v->datafluxbot, fields->v->datafluxtop, fields->rhoref, fields->rhorefh);
-        diff_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->rhoref, fields->rhorefh);
-
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); ++it)
-            diff_c(it->second->data, fields->sp[it->first]->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-                   fields->sp[it->first]->datafluxbot, fields->sp[it->first]->datafluxtop, fields->rhoref, fields->rhorefh, this->tPr);
+        if (swimplicit == "1")
+            exec_block_kernels<false, true>(kb, ke);
+        else
+            exec_block_kernels<false, false>(kb, ke);
     }
     else
+        exec_block_kernels<true, false>(kb, ke);
+}
+
+template<bool resolved_wall, bool implicit_z>
+void Diff_smag_2::exec_block_kernels(const int kb, const int ke)
+{
+    // packed scalars
+    std::vector<double*> sfluxbot;
+    std::vector<double*> sfluxtop;
+    for (FieldMap::const_iterator it = fields->sp.begin(); it!=fields->sp.end(); ++it)
     {
-        diff_u<true>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->u->datafluxbot, fields->u->datafluxtop, fields->rhoref, fields->rhorefh);
-        diff_v<true>(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->v->datafluxbot, fields->v->datafluxtop, fields->rhoref, fields->rhorefh);
-        diff_w(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-               fields->rhoref, fields->rhorefh);
+        sfluxbot.push_back(it->second->datafluxbot);
+        sfluxtop.push_back(it->second->datafluxtop);
+    }
 
-        for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); ++it)
-            diff_c(it->second->data, fields->sp[it->first]->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
-                   fields->sp[it->first]->datafluxbot, fields->sp[it->first]->datafluxtop, fields->rhoref, fields->rhorefh, this->tPr);
+    diff_u<resolved_wall, implicit_z>(fields->ut->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                                      fields->u->datafluxbot, fields->u->datafluxtop, fields->rhoref, fields->rhorefh, kb, ke);
+    diff_v<resolved_wall, implicit_z>(fields->vt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                                      fields->v->datafluxbot, fields->v->datafluxtop, fields->rhoref, fields->rhorefh, kb, ke);
+    diff_w<implicit_z>(fields->wt->data, fields->u->data, fields->v->data, fields->w->data, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                       fields->rhoref, fields->rhorefh, kb, ke);
 
-    }
+    if (!fields->sp.empty())
+        diff_c<implicit_z>(fields->st_packed, fields->sp_packed, fields->sp.size(), grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                           &sfluxbot[0], &sfluxtop[0], fields->rhoref, fields->rhorefh, this->tPr, kb, ke);
+
+    for (FieldMap::const_iterator it = fields->sts.begin(); it!=fields->sts.end(); ++it)
+        diff_c<implicit_z>(it->second->data, fields->sps[it->first]->data_single, 1, grid->dzi, grid->dzhi, fields->sd["evisc"]->data,
+                           &fields->sps[it->first]->datafluxbot, &fields->sps[it->first]->datafluxtop, fields->rhoref, fields->rhorefh, this->tPr, kb, ke);
 }
-#endif
 
 template <bool resolved_wall> 
 void Diff_smag_2::calc_strain2(double* restrict strain2,
@@ -416,11 +474,12 @@ void Diff_smag_2::calc_evisc_neutral(double* restrict evisc,
 
 }
 
-template <bool resolved_wall>
+template <bool resolved_wall, bool implicit_z>
 void Diff_smag_2::diff_u(double* restrict ut, double* restrict u, double* restrict v, double* restrict w,
                          double* restrict dzi, double* restrict dzhi, double* restrict evisc,
                          double* restrict fluxbot, double* restrict fluxtop,
-                         double* restrict rhoref, double* restrict rhorefh)
+                         double* restrict rhoref, double* restrict rhorefh,
+                         const int kb, const int ke)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -438,54 +497,60 @@ void Diff_smag_2::diff_u(double* restrict ut, double* restrict u, double* restri
     if(!resolved_wall)
     {
         // bottom boundary
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ij  = i + j*jj;
-                const int ijk = i + j*jj + kstart*kk;
-                eviscn = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+jj] + evisc[ijk+jj]);
-                eviscs = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-jj] + evisc[ijk-ii   ] + evisc[ijk   ]);
-                evisct = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+kk] + evisc[ijk+kk]);
-                eviscb = 0.25*(evisc[ijk-ii-kk] + evisc[ijk-kk] + evisc[ijk-ii   ] + evisc[ijk   ]);
-
-                ut[ijk] +=
-                         // du/dx + du/dx
-                         + ( evisc[ijk   ]*(u[ijk+ii]-u[ijk   ])*dxi
-                           - evisc[ijk-ii]*(u[ijk   ]-u[ijk-ii])*dxi ) * 2.* dxi
-                         // du/dy + dv/dx
-                         + ( eviscn*((u[ijk+jj]-u[ijk   ])*dyi + (v[ijk+jj]-v[ijk-ii+jj])*dxi)
-                           - eviscs*((u[ijk   ]-u[ijk-jj])*dyi + (v[ijk   ]-v[ijk-ii   ])*dxi) ) * dyi
-                         // du/dz + dw/dx
-                         + ( rhorefh[kstart+1] * evisct*((u[ijk+kk]-u[ijk   ])* dzhi[kstart+1] + (w[ijk+kk]-w[ijk-ii+kk])*dxi)
-                           + rhorefh[kstart  ] * fluxbot[ij] ) / rhoref[kstart] * dzi[kstart];
-            }
+        if (kb == kstart)
+        {
+            for (int j=grid->jstart; j<grid->jend; ++j)
+                #pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ij  = i + j*jj;
+                    const int ijk = i + j*jj + kstart*kk;
+                    eviscn = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+jj] + evisc[ijk+jj]);
+                    eviscs = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-jj] + evisc[ijk-ii   ] + evisc[ijk   ]);
+                    evisct = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+kk] + evisc[ijk+kk]);
+                    eviscb = 0.25*(evisc[ijk-ii-kk] + evisc[ijk-kk] + evisc[ijk-ii   ] + evisc[ijk   ]);
+
+                    ut[ijk] +=
+                             // du/dx + du/dx
+                             + ( evisc[ijk   ]*(u[ijk+ii]-u[ijk   ])*dxi
+                               - evisc[ijk-ii]*(u[ijk   ]-u[ijk-ii])*dxi ) * 2.* dxi
+                             // du/dy + dv/dx
+                             + ( eviscn*((u[ijk+jj]-u[ijk   ])*dyi + (v[ijk+jj]-v[ijk-ii+jj])*dxi)
+                               - eviscs*((u[ijk   ]-u[ijk-jj])*dyi + (v[ijk   ]-v[ijk-ii   ])*dxi) ) * dyi
+                             // du/dz + dw/dx
+                             + ( rhorefh[kstart+1] * evisct*((implicit_z ? 0. : (u[ijk+kk]-u[ijk   ])* dzhi[kstart+1]) + (w[ijk+kk]-w[ijk-ii+kk])*dxi)
+                               + rhorefh[kstart  ] * fluxbot[ij] ) / rhoref[kstart] * dzi[kstart];
+                }
+        }
 
         // top boundary
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ij  = i + j*jj;
-                const int ijk = i + j*jj + (kend-1)*kk;
-                eviscn = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+jj] + evisc[ijk+jj]);
-                eviscs = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-jj] + evisc[ijk-ii   ] + evisc[ijk   ]);
-                evisct = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+kk] + evisc[ijk+kk]);
-                eviscb = 0.25*(evisc[ijk-ii-kk] + evisc[ijk-kk] + evisc[ijk-ii   ] + evisc[ijk   ]);
-                ut[ijk] +=
-                         // du/dx + du/dx
-                         + ( evisc[ijk   ]*(u[ijk+ii]-u[ijk   ])*dxi
-                           - evisc[ijk-ii]*(u[ijk   ]-u[ijk-ii])*dxi ) * 2.* dxi
-                         // du/dy + dv/dx
-                         + ( eviscn*((u[ijk+jj]-u[ijk   ])*dyi  + (v[ijk+jj]-v[ijk-ii+jj])*dxi)
-                           - eviscs*((u[ijk   ]-u[ijk-jj])*dyi  + (v[ijk   ]-v[ijk-ii   ])*dxi) ) * dyi
-                         // du/dz + dw/dx
-                         + (- rhorefh[kend  ] * fluxtop[ij]
-                            - rhorefh[kend-1] * eviscb*((u[ijk   ]-u[ijk-kk])* dzhi[kend-1] + (w[ijk   ]-w[ijk-ii   ])*dxi) ) / rhoref[kend-1] * dzi[kend-1];
-            }
+        if (ke == kend)
+        {
+            for (int j=grid->jstart; j<grid->jend; ++j)
+                #pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ij  = i + j*jj;
+                    const int ijk = i + j*jj + (kend-1)*kk;
+                    eviscn = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+jj] + evisc[ijk+jj]);
+                    eviscs = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-jj] + evisc[ijk-ii   ] + evisc[ijk   ]);
+                    evisct = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+kk] + evisc[ijk+kk]);
+                    eviscb = 0.25*(evisc[ijk-ii-kk] + evisc[ijk-kk] + evisc[ijk-ii   ] + evisc[ijk   ]);
+                    ut[ijk] +=
+                             // du/dx + du/dx
+                             + ( evisc[ijk   ]*(u[ijk+ii]-u[ijk   ])*dxi
+                               - evisc[ijk-ii]*(u[ijk   ]-u[ijk-ii])*dxi ) * 2.* dxi
+                             // du/dy + dv/dx
+                             + ( eviscn*((u[ijk+jj]-u[ijk   ])*dyi  + (v[ijk+jj]-v[ijk-ii+jj])*dxi)
+                               - eviscs*((u[ijk   ]-u[ijk-jj])*dyi  + (v[ijk   ]-v[ijk-ii   ])*dxi) ) * dyi
+                             // du/dz + dw/dx
+                             + (- rhorefh[kend  ] * fluxtop[ij]
+                                - rhorefh[kend-1] * eviscb*((implicit_z ? 0. : (u[ijk   ]-u[ijk-kk])* dzhi[kend-1]) + (w[ijk   ]-w[ijk-ii   ])*dxi) ) / rhoref[kend-1] * dzi[kend-1];
+                }
+        }
     }
 
-    for (int k=grid->kstart+k_offset; k<grid->kend-k_offset; ++k)
+    for (int k=std::max(kb, kstart+k_offset); k<std::min(ke, kend-k_offset); ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -503,16 +568,17 @@ void Diff_smag_2::diff_u(double* restrict ut, double* restrict u, double* restri
                          + ( eviscn*((u[ijk+jj]-u[ijk   ])*dyi  + (v[ijk+jj]-v[ijk-ii+jj])*dxi)
                            - eviscs*((u[ijk   ]-u[ijk-jj])*dyi  + (v[ijk   ]-v[ijk-ii   ])*dxi) ) * dyi
                          // du/dz + dw/dx
-                         + ( rhorefh[k+1] * evisct*((u[ijk+kk]-u[ijk   ])* dzhi[k+1] + (w[ijk+kk]-w[ijk-ii+kk])*dxi)
-                           - rhorefh[k  ] * eviscb*((u[ijk   ]-u[ijk-kk])* dzhi[k  ] + (w[ijk   ]-w[ijk-ii   ])*dxi) ) / rhoref[k] * dzi[k];
+                         + ( rhorefh[k+1] * evisct*((implicit_z ? 0. : (u[ijk+kk]-u[ijk   ])* dzhi[k+1]) + (w[ijk+kk]-w[ijk-ii+kk])*dxi)
+                           - rhorefh[k  ] * eviscb*((implicit_z ? 0. : (u[ijk   ]-u[ijk-kk])* dzhi[k  ]) + (w[ijk   ]-w[ijk-ii   ])*dxi) ) / rhoref[k] * dzi[k];
             }
 }
 
-template <bool resolved_wall>
+template <bool resolved_wall, bool implicit_z>
 void Diff_smag_2::diff_v(double* restrict vt, double* restrict u, double* restrict v, double* restrict w,
                          double* restrict dzi, double* restrict dzhi, double* restrict evisc,
                          double* restrict fluxbot, double* restrict fluxtop,
-                         double* restrict rhoref, double* restrict rhorefh)
+                         double* restrict rhoref, double* restrict rhorefh,
+                         const int kb, const int ke)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -530,53 +596,59 @@ void Diff_smag_2::diff_v(double* restrict vt, double* restrict u, double* restri
     if(!resolved_wall)
     {
         // bottom boundary
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ij  = i + j*jj;
-                const int ijk = i + j*jj + kstart*kk;
-                evisce = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+ii-jj] + evisc[ijk+ii]);
-                eviscw = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-ii] + evisc[ijk   -jj] + evisc[ijk   ]);
-                evisct = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+kk-jj] + evisc[ijk+kk]);
-                eviscb = 0.25*(evisc[ijk-kk-jj] + evisc[ijk-kk] + evisc[ijk   -jj] + evisc[ijk   ]);
-                vt[ijk] +=
-                         // dv/dx + du/dy
-                         + ( evisce*((v[ijk+ii]-v[ijk   ])*dxi + (u[ijk+ii]-u[ijk+ii-jj])*dyi)
-                           - eviscw*((v[ijk   ]-v[ijk-ii])*dxi + (u[ijk   ]-u[ijk   -jj])*dyi) ) * dxi
-                         // dv/dy + dv/dy
-                         + ( evisc[ijk   ]*(v[ijk+jj]-v[ijk   ])*dyi
-                           - evisc[ijk-jj]*(v[ijk   ]-v[ijk-jj])*dyi ) * 2.* dyi
-                         // dv/dz + dw/dy
-                         + ( rhorefh[kstart+1] * evisct*((v[ijk+kk]-v[ijk   ])*dzhi[kstart+1] + (w[ijk+kk]-w[ijk-jj+kk])*dyi)
-                           + rhorefh[kstart  ] * fluxbot[ij] ) / rhoref[kstart] * dzi[kstart];
-            }
+        if (kb == kstart)
+        {
+            for (int j=grid->jstart; j<grid->jend; ++j)
+                #pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ij  = i + j*jj;
+                    const int ijk = i + j*jj + kstart*kk;
+                    evisce = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+ii-jj] + evisc[ijk+ii]);
+                    eviscw = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-ii] + evisc[ijk   -jj] + evisc[ijk   ]);
+                    evisct = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+kk-jj] + evisc[ijk+kk]);
+                    eviscb = 0.25*(evisc[ijk-kk-jj] + evisc[ijk-kk] + evisc[ijk   -jj] + evisc[ijk   ]);
+                    vt[ijk] +=
+                             // dv/dx + du/dy
+                             + ( evisce*((v[ijk+ii]-v[ijk   ])*dxi + (u[ijk+ii]-u[ijk+ii-jj])*dyi)
+                               - eviscw*((v[ijk   ]-v[ijk-ii])*dxi + (u[ijk   ]-u[ijk   -jj])*dyi) ) * dxi
+                             // dv/dy + dv/dy
+                             + ( evisc[ijk   ]*(v[ijk+jj]-v[ijk   ])*dyi
+                               - evisc[ijk-jj]*(v[ijk   ]-v[ijk-jj])*dyi ) * 2.* dyi
+                             // dv/dz + dw/dy
+                             + ( rhorefh[kstart+1] * evisct*((implicit_z ? 0. : (v[ijk+kk]-v[ijk   ])*dzhi[kstart+1]) + (w[ijk+kk]-w[ijk-jj+kk])*dyi)
+                               + rhorefh[kstart  ] * fluxbot[ij] ) / rhoref[kstart] * dzi[kstart];
+                }
+        }
 
         // top boundary
-        for (int j=grid->jstart; j<grid->jend; ++j)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
-            {
-                const int ij  = i + j*jj;
-                const int ijk = i + j*jj + (kend-1)*kk;
-                evisce = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+ii-jj] + evisc[ijk+ii]);
-                eviscw = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-ii] + evisc[ijk   -jj] + evisc[ijk   ]);
-                evisct = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+kk-jj] + evisc[ijk+kk]);
-                eviscb = 0.25*(evisc[ijk-kk-jj] + evisc[ijk-kk] + evisc[ijk   -jj] + evisc[ijk   ]);
-                vt[ijk] +=
-                         // dv/dx + du/dy
-                         + ( evisce*((v[ijk+ii]-v[ijk   ])*dxi + (u[ijk+ii]-u[ijk+ii-jj])*dyi)
-                           - eviscw*((v[ijk   ]-v[ijk-ii])*dxi + (u[ijk   ]-u[ijk   -jj])*dyi) ) * dxi
-                         // dv/dy + dv/dy
-                         + ( evisc[ijk   ]*(v[ijk+jj]-v[ijk   ])*dyi
-                           - evisc[ijk-jj]*(v[ijk   ]-v[ijk-jj])*dyi ) * 2.* dyi
-                         // dv/dz + dw/dy
-                         + (- rhorefh[kend  ] * fluxtop[ij]
-                            - rhorefh[kend-1] * eviscb*((v[ijk   ]-v[ijk-kk])*dzhi[kend-1] + (w[ijk   ]-w[ijk-jj   ])*dyi) ) / rhoref[kend-1] * dzi[kend-1];
-            }
+        if (ke == kend)
+        {
+            for (int j=grid->jstart; j<grid->jend; ++j)
+                #pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ij  = i + j*jj;
+                    const int ijk = i + j*jj + (kend-1)*kk;
+                    evisce = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+ii-jj] + evisc[ijk+ii]);
+                    eviscw = 0.25*(evisc[ijk-ii-jj] + evisc[ijk-ii] + evisc[ijk   -jj] + evisc[ijk   ]);
+                    evisct = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+kk-jj] + evisc[ijk+kk]);
+                    eviscb = 0.25*(evisc[ijk-kk-jj] + evisc[ijk-kk] + evisc[ijk   -jj] + evisc[ijk   ]);
+                    vt[ijk] +=
+                             // dv/dx + du/dy
+                             + ( evisce*((v[ijk+ii]-v[ijk   ])*dxi + (u[ijk+ii]-u[ijk+ii-jj])*dyi)
+                               - eviscw*((v[ijk   ]-v[ijk-ii])*dxi + (u[ijk   ]-u[ijk   -jj])*dyi) ) * dxi
+                             // dv/dy + dv/dy
+                             + ( evisc[ijk   ]*(v[ijk+jj]-v[ijk   ])*dyi
+                               - evisc[ijk-jj]*(v[ijk   ]-v[ijk-jj])*dyi ) * 2.* dyi
+                             // dv/dz + dw/dy
+                             + (- rhorefh[kend  ] * fluxtop[ij]
+                                - rhorefh[kend-1] * eviscb*((implicit_z ? 0. : (v[ijk   ]-v[ijk-kk])*dzhi[kend-1]) + (w[ijk   ]-w[ijk-jj   ])*dyi) ) / rhoref[kend-1] * dzi[kend-1];
+                }
+        }
     }
 
-    for (int k=grid->kstart+k_offset; k<grid->kend-k_offset; ++k)
+    for (int k=std::max(kb, kstart+k_offset); k<std::min(ke, kend-k_offset); ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -594,14 +666,16 @@ void Diff_smag_2::diff_v(double* restrict vt, double* restrict u, double* restri
                          + ( evisc[ijk   ]*(v[ijk+jj]-v[ijk   ])*dyi
                            - evisc[ijk-jj]*(v[ijk   ]-v[ijk-jj])*dyi ) * 2.* dyi
                          // dv/dz + dw/dy
-                         + ( rhorefh[k+1] * evisct*((v[ijk+kk]-v[ijk   ])*dzhi[k+1] + (w[ijk+kk]-w[ijk-jj+kk])*dyi)
-                           - rhorefh[k  ] * eviscb*((v[ijk   ]-v[ijk-kk])*dzhi[k  ] + (w[ijk   ]-w[ijk-jj   ])*dyi) ) / rhoref[k] * dzi[k];
+                         + ( rhorefh[k+1] * evisct*((implicit_z ? 0. : (v[ijk+kk]-v[ijk   ])*dzhi[k+1]) + (w[ijk+kk]-w[ijk-jj+kk])*dyi)
+                           - rhorefh[k  ] * eviscb*((implicit_z ? 0. : (v[ijk   ]-v[ijk-kk])*dzhi[k  ]) + (w[ijk   ]-w[ijk-jj   ])*dyi) ) / rhoref[k] * dzi[k];
             }
 }
 
+template<bool implicit_z>
 void Diff_smag_2::diff_w(double* restrict wt, double* restrict u, double* restrict v, double* restrict w,
                          double* restrict dzi, double* restrict dzhi, double* restrict evisc,
-                         double* restrict rhoref, double* restrict rhorefh)
+                         double* restrict rhoref, double* restrict rhorefh,
+                         const int kb, const int ke)
 {
     const int ii = 1;
     const int jj = grid->icells;
@@ -612,7 +686,7 @@ void Diff_smag_2::diff_w(double* restrict wt, double* restrict u, double* restri
 
     double evisce, eviscw, eviscn, eviscs;
 
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
+    for (int k=std::max(kb, grid->kstart+1); k<ke; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -630,19 +704,23 @@ void Diff_smag_2::diff_w(double* restrict wt, double* restrict u, double* restri
                          + ( eviscn*((w[ijk+jj]-w[ijk   ])*dyi + (v[ijk+jj]-v[ijk+jj-kk])*dzhi[k])
                            - eviscs*((w[ijk   ]-w[ijk-jj])*dyi + (v[ijk   ]-v[ijk+  -kk])*dzhi[k]) ) * dyi
                          // dw/dz + dw/dz
-                         + ( rhoref[k  ] * evisc[ijk   ]*(w[ijk+kk]-w[ijk   ])*dzi[k  ]
-                           - rhoref[k-1] * evisc[ijk-kk]*(w[ijk   ]-w[ijk-kk])*dzi[k-1] ) / rhorefh[k] * 2.* dzhi[k];
+                         + ( implicit_z ? 0. :
+                           ( rhoref[k  ] * evisc[ijk   ]*(w[ijk+kk]-w[ijk   ])*dzi[k  ]
+                           - rhoref[k-1] * evisc[ijk-kk]*(w[ijk   ]-w[ijk-kk])*dzi[k-1] ) / rhorefh[k] * 2.* dzhi[k] );
             }
 }
 
-void Diff_smag_2::diff_c(double* restrict at, double* restrict a,
+template<bool implicit_z, typename T>
+void Diff_smag_2::diff_c(double* restrict at, T* restrict a, const int ns,
                          double* restrict dzi, double* restrict dzhi, double* restrict evisc,
-                         double* restrict fluxbot, double* restrict fluxtop, 
-                         double* restrict rhoref, double* restrict rhorefh, double tPr)
+                         double* const* fluxbot, double* const* fluxtop, 
+                         double* restrict rhoref, double* restrict rhorefh, double tPr,
+                         const int kb, const int ke)
 {
     const int ii = 1;
     const int jj = grid->icells;
     const int kk = grid->ijcells;
+    const long nn = grid->ncells;
     const int kstart = grid->kstart;
     const int kend   = grid->kend;
 
@@ -652,71 +730,255 @@ void Diff_smag_2::diff_c(double* restrict at, double* restrict a,
     double evisce,eviscw,eviscn,eviscs,evisct,eviscb;
 
     // bottom boundary
-    for (int j=grid->jstart; j<grid->jend; ++j)
+    if (kb == kstart)
+    {
+        for (int j=grid->jstart; j<grid->jend; ++j)
+            for (int n=0; n<ns; ++n)
+                #pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ij  = i + j*jj;
+                    const int ijk  = i + j*jj + kstart*kk;
+                    const long ijkn = ijk + n*nn;
+                    evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
+                    eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
+                    eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
+                    eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
+                    evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
+                    eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
+
+                    at[ijkn] +=
+                             + ( evisce*(a[ijkn+ii]-a[ijkn   ]) 
+                               - eviscw*(a[ijkn   ]-a[ijkn-ii]) ) * dxidxi 
+                             + ( eviscn*(a[ijkn+jj]-a[ijkn   ]) 
+                               - eviscs*(a[ijkn   ]-a[ijkn-jj]) ) * dyidyi
+                             + ( (implicit_z ? 0. : rhorefh[kstart+1] * evisct*(a[ijkn+kk]-a[ijkn   ])*dzhi[kstart+1])
+                               + rhorefh[kstart  ] * fluxbot[n][ij] ) / rhoref[kstart] * dzi[kstart];
+                }
+    }
+
+    for (int k=std::max(kb, kstart+1); k<std::min(ke, kend-1); ++k)
+        for (int j=grid->jstart; j<grid->jend; ++j)
+            for (int n=0; n<ns; ++n)
+                #pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk  = i + j*jj + k*kk;
+                    const long ijkn = ijk + n*nn;
+                    evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
+                    eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
+                    eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
+                    eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
+                    evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
+                    eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
+
+                    at[ijkn] +=
+                             + ( evisce*(a[ijkn+ii]-a[ijkn   ]) 
+                               - eviscw*(a[ijkn   ]-a[ijkn-ii]) ) * dxidxi 
+                             + ( eviscn*(a[ijkn+jj]-a[ijkn   ]) 
+                               - eviscs*(a[ijkn   ]-a[ijkn-jj]) ) * dyidyi
+                             + ( implicit_z ? 0. :
+                               ( rhorefh[k+1] * evisct*(a[ijkn+kk]-a[ijkn   ])*dzhi[k+1]
+                               - rhorefh[k  ] * eviscb*(a[ijkn   ]-a[ijkn-kk])*dzhi[k]  ) / rhoref[k] * dzi[k] );
+                }
+
+    // top boundary
+    if (ke == kend)
+    {
+        for (int j=grid->jstart; j<grid->jend; ++j)
+            for (int n=0; n<ns; ++n)
+                #pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ij  = i + j*jj;
+                    const int ijk  = i + j*jj + (kend-1)*kk;
+                    const long ijkn = ijk + n*nn;
+                    evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
+                    eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
+                    eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
+                    eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
+                    evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
+                    eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
+
+                    at[ijkn] +=
+                             + ( evisce*(a[ijkn+ii]-a[ijkn   ]) 
+                               - eviscw*(a[ijkn   ]-a[ijkn-ii]) ) * dxidxi 
+                             + ( eviscn*(a[ijkn+jj]-a[ijkn   ]) 
+                               - eviscs*(a[ijkn   ]-a[ijkn-jj]) ) * dyidyi
+                             + (-rhorefh[kend  ] * fluxtop[n][ij]
+                               - (implicit_z ? 0. : rhorefh[kend-1] * eviscb*(a[ijkn   ]-a[ijkn-kk])*dzhi[kend-1]) ) / rhoref[kend-1] * dzi[kend-1];
+                }
+    }
+}
+
+namespace
+{
+    // Factorize the tridiagonal systems of all columns of an xz-slice, in which the diagonal follows from
+    // the conservation of the diffusion as 1-lo-up. The modified upper diagonal is stored in up, and the
+    // inverse of the pivots in m.
+    void factorize_tridiag_slice(const double* const restrict lo, double* const restrict up, double* const restrict m,
+                                 const int istart, const int iend, const int kb, const int ke, const int jj)
+    {
         #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+        for (int i=istart; i<iend; ++i)
         {
-            const int ij  = i + j*jj;
-            const int ijk = i + j*jj + kstart*kk;
-            evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
-            eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
-            eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
-            eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
-            evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
-            eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
-
-            at[ijk] +=
-                     + ( evisce*(a[ijk+ii]-a[ijk   ]) 
-                       - eviscw*(a[ijk   ]-a[ijk-ii]) ) * dxidxi 
-                     + ( eviscn*(a[ijk+jj]-a[ijk   ]) 
-                       - eviscs*(a[ijk   ]-a[ijk-jj]) ) * dyidyi
-                     + ( rhorefh[kstart+1] * evisct*(a[ijk+kk]-a[ijk   ])*dzhi[kstart+1]
-                       + rhorefh[kstart  ] * fluxbot[ij] ) / rhoref[kstart] * dzi[kstart];
+            const int ik = i + kb*jj;
+            m [ik] = 1./(1. - lo[ik] - up[ik]);
+            up[ik] *= m[ik];
         }
 
-    for (int k=grid->kstart+1; k<grid->kend-1; ++k)
-        for (int j=grid->jstart; j<grid->jend; ++j)
+        for (int k=kb+1; k<ke; ++k)
             #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+            for (int i=istart; i<iend; ++i)
             {
-                const int ijk = i + j*jj + k*kk;
-                evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
-                eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
-                eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
-                eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
-                evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
-                eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
-
-                at[ijk] +=
-                         + ( evisce*(a[ijk+ii]-a[ijk   ]) 
-                           - eviscw*(a[ijk   ]-a[ijk-ii]) ) * dxidxi 
-                         + ( eviscn*(a[ijk+jj]-a[ijk   ]) 
-                           - eviscs*(a[ijk   ]-a[ijk-jj]) ) * dyidyi
-                         + ( rhorefh[k+1] * evisct*(a[ijk+kk]-a[ijk   ])*dzhi[k+1]
-                           - rhorefh[k  ] * eviscb*(a[ijk   ]-a[ijk-kk])*dzhi[k]  ) / rhoref[k] * dzi[k];
+                const int ik = i + k*jj;
+                m [ik] = 1./(1. - lo[ik] - up[ik] - lo[ik]*up[ik-jj]);
+                up[ik] *= m[ik];
             }
+    }
+}
 
-    // top boundary
+void Diff_smag_2::exec_implicit()
+{
+    if (swimplicit != "1")
+        return;
+
+    const int kstart = grid->kstart;
+    const int kend   = grid->kend;
+    const int ncells = grid->ncells;
+    const int nslice = grid->icells*grid->kcells;
+
+    double* restrict lo = &implicit_work[0*nslice];
+    double* restrict up = &implicit_work[1*nslice];
+    double* restrict m  = &implicit_work[2*nslice];
+    double* restrict x  = &implicit_work[3*nslice];
+
+    double* restrict evisc = fields->sd["evisc"]->data;
+
+    // The implicit step spans the time interval of the substep that has just been integrated.
+    const double dt = model->timeloop->get_stage_time_step();
+
+    // Solve the vertical diffusion per xz-slice, with the columns of the slice solved simultaneously.
     for (int j=grid->jstart; j<grid->jend; ++j)
+    {
+        calc_implicit_coef<U_type>(lo, up, m, evisc, grid->dzi, grid->dzhi, fields->rhoref, fields->rhorefh, tPr, j, dt);
+        diff_implicit(fields->u->data, lo, up, m, x, j, kstart, kend);
+
+        calc_implicit_coef<V_type>(lo, up, m, evisc, grid->dzi, grid->dzhi, fields->rhoref, fields->rhorefh, tPr, j, dt);
+        diff_implicit(fields->v->data, lo, up, m, x, j, kstart, kend);
+
+        calc_implicit_coef<W_type>(lo, up, m, evisc, grid->dzi, grid->dzhi, fields->rhoref, fields->rhorefh, tPr, j, dt);
+        diff_implicit(fields->w->data, lo, up, m, x, j, kstart+1, kend);
+
+        // All scalars share the same coefficients.
+        calc_implicit_coef<Scalar_type>(lo, up, m, evisc, grid->dzi, grid->dzhi, fields->rhoref, fields->rhorefh, tPr, j, dt);
+
+        for (int n=0; n<static_cast<int>(fields->sp.size()); ++n)
+            diff_implicit(&fields->sp_packed[static_cast<long>(n)*ncells], lo, up, m, x, j, kstart, kend);
+
+        for (FieldMap::const_iterator it = fields->sps.begin(); it!=fields->sps.end(); ++it)
+            diff_implicit(it->second->data_single, lo, up, m, x, j, kstart, kend);
+    }
+}
+
+template<int loc>
+void Diff_smag_2::calc_implicit_coef(double* restrict lo, double* restrict up, double* restrict m,
+                                     double* restrict evisc, double* restrict dzi, double* restrict dzhi,
+                                     double* restrict rhoref, double* restrict rhorefh, const double tPr,
+                                     const int j, const double dt)
+{
+    const int ii = 1;
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+    const int kstart = grid->kstart;
+    const int kend   = grid->kend;
+
+    // The vertical velocity vanishes at the walls, for the other variables the
+    // fluxes at the walls follow from the surface model and remain explicit.
+    const int kb = (loc == W_type) ? kstart+1 : kstart;
+
+    for (int k=kb; k<kend; ++k)
         #pragma ivdep
         for (int i=grid->istart; i<grid->iend; ++i)
         {
-            const int ij  = i + j*jj;
-            const int ijk = i + j*jj + (kend-1)*kk;
-            evisce = 0.5*(evisc[ijk   ]+evisc[ijk+ii])/tPr;
-            eviscw = 0.5*(evisc[ijk-ii]+evisc[ijk   ])/tPr;
-            eviscn = 0.5*(evisc[ijk   ]+evisc[ijk+jj])/tPr;
-            eviscs = 0.5*(evisc[ijk-jj]+evisc[ijk   ])/tPr;
-            evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
-            eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
-
-            at[ijk] +=
-                     + ( evisce*(a[ijk+ii]-a[ijk   ]) 
-                       - eviscw*(a[ijk   ]-a[ijk-ii]) ) * dxidxi 
-                     + ( eviscn*(a[ijk+jj]-a[ijk   ]) 
-                       - eviscs*(a[ijk   ]-a[ijk-jj]) ) * dyidyi
-                     + (-rhorefh[kend  ] * fluxtop[ij]
-                       - rhorefh[kend-1] * eviscb*(a[ijk   ]-a[ijk-kk])*dzhi[kend-1] ) / rhoref[kend-1] * dzi[kend-1];
+            const int ik  = i + k*jj;
+            const int ijk = i + j*jj + k*kk;
+
+            if (loc == W_type)
+            {
+                lo[ik] = -dt * rhoref[k-1] * evisc[ijk-kk]*dzi[k-1] / rhorefh[k] * 2.*dzhi[k];
+                up[ik] = -dt * rhoref[k  ] * evisc[ijk   ]*dzi[k  ] / rhorefh[k] * 2.*dzhi[k];
+            }
+            else
+            {
+                double eviscb, evisct;
+                if (loc == U_type)
+                {
+                    eviscb = 0.25*(evisc[ijk-ii-kk] + evisc[ijk-kk] + evisc[ijk-ii   ] + evisc[ijk   ]);
+                    evisct = 0.25*(evisc[ijk-ii   ] + evisc[ijk   ] + evisc[ijk-ii+kk] + evisc[ijk+kk]);
+                }
+                else if (loc == V_type)
+                {
+                    eviscb = 0.25*(evisc[ijk-kk-jj] + evisc[ijk-kk] + evisc[ijk   -jj] + evisc[ijk   ]);
+                    evisct = 0.25*(evisc[ijk   -jj] + evisc[ijk   ] + evisc[ijk+kk-jj] + evisc[ijk+kk]);
+                }
+                else
+                {
+                    eviscb = 0.5*(evisc[ijk-kk]+evisc[ijk   ])/tPr;
+                    evisct = 0.5*(evisc[ijk   ]+evisc[ijk+kk])/tPr;
+                }
+
+                lo[ik] = (k == kstart ) ? 0. : -dt * rhorefh[k  ] * eviscb*dzhi[k  ] / rhoref[k] * dzi[k];
+                up[ik] = (k == kend-1) ? 0. : -dt * rhorefh[k+1] * evisct*dzhi[k+1] / rhoref[k] * dzi[k];
+            }
+        }
+
+    factorize_tridiag_slice(lo, up, m, grid->istart, grid->iend, kb, kend, jj);
+}
+
+template<typename T>
+void Diff_smag_2::diff_implicit(T* restrict a,
+                                double* restrict lo, double* restrict up, double* restrict m, double* restrict x,
+                                const int j, const int kb, const int ke)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    // Forward sweep.
+    #pragma ivdep
+    for (int i=grid->istart; i<grid->iend; ++i)
+    {
+        const int ik  = i + kb*jj;
+        const int ijk = i + j*jj + kb*kk;
+        x[ik] = a[ijk]*m[ik];
+    }
+
+    for (int k=kb+1; k<ke; ++k)
+        #pragma ivdep
+        for (int i=grid->istart; i<grid->iend; ++i)
+        {
+            const int ik  = i + k*jj;
+            const int ijk = i + j*jj + k*kk;
+            x[ik] = (a[ijk] - lo[ik]*x[ik-jj])*m[ik];
+        }
+
+    // Backward substitution.
+    for (int k=ke-2; k>=kb; --k)
+        #pragma ivdep
+        for (int i=grid->istart; i<grid->iend; ++i)
+        {
+            const int ik = i + k*jj;
+            x[ik] -= up[ik]*x[ik+jj];
+        }
+
+    // Replace the field by the implicitly diffused state.
+    for (int k=kb; k<ke; ++k)
+        #pragma ivdep
+        for (int i=grid->istart; i<grid->iend; ++i)
+        {
+            const int ik  = i + k*jj;
+            const int ijk = i + j*jj + k*kk;
+            a[ijk] = x[ik];
         }
 }
 
@@ -731,6 +993,10 @@ double Diff_smag_2::calc_dnmul(double* restrict evisc, double* restrict dzi, dou
     const double tPrfac = std::min(1., tPr);
     double dnmul = 0;
 
+    // The vertical diffusion does not limit the time step if it is solved implicitly, because the
+    // backward Euler split step damps every mode for any time step.
+    const double dzfac = (swimplicit == "1") ? 0. : 1.;
+
     // get the maximum time step for diffusion
     for (int k=grid->kstart; k<grid->kend; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
@@ -738,10 +1004,8 @@ double Diff_smag_2::calc_dnmul(double* restrict evisc, double* restrict dzi, dou
             for (int i=grid->istart; i<grid->iend; ++i)
             {
                 const int ijk = i + j*jj + k*kk;
-                dnmul = std::max(dnmul, std::abs(tPrfac*evisc[ijk]*(dxidxi + dyidyi + dzi[k]*dzi[k])));
+                dnmul = std::max(dnmul, std::abs(tPrfac*evisc[ijk]*(dxidxi + dyidyi + dzfac*dzi[k]*dzi[k])));
             }
 
-    grid->get_max(&dnmul);
-
     return dnmul;
 }
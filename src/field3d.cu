@@ -38,7 +38,8 @@ Field3d::~Field3d()
     cuda_safe_call(cudaFreeHost(datamean));
 }
 
-int Field3d::init()
+// The packed scalar storage is not used at the GPU, the fields always allocate their own pinned memory.
+int Field3d::init(double* data_packed)
 {
     const int ijksize = grid->ncells *sizeof(double);
     const int ijsize  = grid->ijcells*sizeof(double);
@@ -28,7 +28,7 @@
 #include "field3d.h"
 #include "defines.h"
 
-Field3d::Field3d(Grid* gridin, Master* masterin, std::string namein, std::string longnamein, std::string unitin)
+Field3d::Field3d(Grid* gridin, Master* masterin, std::string namein, std::string longnamein, std::string unitin, bool is_singlein)
 {
     grid     = gridin;
     name     = namein;
@@ -36,8 +36,12 @@ Field3d::Field3d(Grid* gridin, Master* masterin, std::string namein, std::string
     unit     = unitin;
     master   = masterin;
 
+    is_single = is_singlein;
+    is_packed = false;
+
     // initialize the pointer at 0
     data = 0;
+    data_single = 0;
     databot = 0;
     datatop = 0;
     datamean = 0;
@@ -60,7 +64,9 @@ Field3d::Field3d(Grid* gridin, Master* masterin, std::string namein, std::string
 #ifndef USECUDA
 Field3d::~Field3d()
 {
-    delete[] data;
+    if (!is_packed)
+        delete[] data;
+    delete[] data_single;
     delete[] databot;
     delete[] datatop;
     delete[] datamean;
@@ -70,10 +76,11 @@ Field3d::~Field3d()
     delete[] datafluxtop;
 }
 
-int Field3d::init()
+int Field3d::init(double* data_packed)
 {
     // Calculate the total field memory size
-    const long fieldMemorySize = (grid->ncells + 6*grid->ijcells + grid->kcells)*sizeof(double);
+    const long fieldMemorySize = is_single ? grid->ncells*sizeof(float) + (6*grid->ijcells + grid->kcells)*sizeof(double)
+                                           : (grid->ncells + 6*grid->ijcells + grid->kcells)*sizeof(double);
 
     // Keep track of the total memory in fields
     static long totalMemorySize = 0;
@@ -81,7 +88,15 @@ int Field3d::init()
     {
         totalMemorySize += fieldMemorySize;
         // Allocate all fields belonging to the 3d field
-        data = new double[grid->ncells];
+        if (is_single)
+            data_single = new float[grid->ncells];
+        else if (data_packed)
+        {
+            data = data_packed;
+            is_packed = true;
+        }
+        else
+            data = new double[grid->ncells];
         databot = new double[grid->ijcells];
         datatop = new double[grid->ijcells];
         datamean = new double[grid->kcells];
@@ -97,8 +112,16 @@ int Field3d::init()
     }
 
     // set all values to zero
-    for (int n=0; n<grid->ncells; ++n)
-        data[n] = 0.;
+    if (is_single)
+    {
+        for (int n=0; n<grid->ncells; ++n)
+            data_single[n] = 0.f;
+    }
+    else
+    {
+        for (int n=0; n<grid->ncells; ++n)
+            data[n] = 0.;
+    }
 
     for (int n=0; n<grid->kcells; ++n)
         datamean[n] = 0.;
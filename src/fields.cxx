@@ -47,8 +47,9 @@ Fields::Fields(Model *modelin, Input *inputin)
     // Initialize the pointers.
     rhoref  = 0;
     rhorefh = 0;
-    umodel  = 0;
-    vmodel  = 0;
+
+    sp_packed = 0;
+    st_packed = 0;
 
     // Initialize GPU pointers
     rhoref_g  = 0;
@@ -64,12 +65,36 @@ Fields::Fields(Model *modelin, Input *inputin)
     std::vector<std::string> slist;
     nerror += inputin->get_list(&slist, "fields", "slist", "");
 
-    // initialize the scalars
+    // initialize the scalars, passive scalars can optionally be stored in single precision
     for (std::vector<std::string>::const_iterator it=slist.begin(); it!=slist.end(); ++it)
     {
-        init_prognostic_field(*it, *it, "-");
-        nerror += inputin->get_item(&sp[*it]->visc, "fields", "svisc", *it);
+        std::string sprecision;
+        nerror += inputin->get_item(&sprecision, "fields", "sprecision", *it, "double");
+
+        if (sprecision == "double")
+        {
+            init_prognostic_field(*it, *it, "-");
+            nerror += inputin->get_item(&sp[*it]->visc, "fields", "svisc", *it);
+        }
+        else if (sprecision == "single")
+        {
+            init_prognostic_single_field(*it, *it, "-");
+            nerror += inputin->get_item(&sps[*it]->visc, "fields", "svisc", *it);
+        }
+        else
+        {
+            master->print_error("\"%s\" is an illegal value for sprecision[%s]\n", sprecision.c_str(), it->c_str());
+            ++nerror;
+        }
+    }
+
+#ifdef USECUDA
+    if (!sps.empty())
+    {
+        master->print_error("sprecision = \"single\" not (yet) implemented in CUDA\n");
+        ++nerror;
     }
+#endif
 
     if (nerror)
         throw 1;
@@ -117,6 +142,13 @@ Fields::~Fields()
     for (FieldMap::iterator it=st.begin(); it!=st.end(); ++it)
         delete it->second;
 
+    // deallocate the single precision scalars and their tendencies
+    for (FieldMap::iterator it=sps.begin(); it!=sps.end(); ++it)
+        delete it->second;
+
+    for (FieldMap::iterator it=sts.begin(); it!=sts.end(); ++it)
+        delete it->second;
+
     // deallocate the diagnostic scalars
     for (FieldMap::iterator it=sd.begin(); it!=sd.end(); ++it)
         delete it->second;
@@ -126,10 +158,10 @@ Fields::~Fields()
         delete it->second;
 
     // delete the arrays
+    delete[] sp_packed;
+    delete[] st_packed;
     delete[] rhoref;
     delete[] rhorefh;
-    delete[] umodel;
-    delete[] vmodel;
 
 #ifdef USECUDA
     clear_device();
@@ -152,13 +184,45 @@ void Fields::init()
     for (FieldMap::iterator it=mt.begin(); it!=mt.end(); ++it)
         nerror += it->second->init();
 
-    // allocate the prognostic scalar fields
+#ifndef USECUDA
+    // allocate the prognostic scalar fields and their tendencies in two packed 4d arrays, this
+    // allows the advection and diffusion kernels to process all scalars in a single sweep;
+    // the sizes and offsets of the packed arrays are long, because they can exceed the range of int
+    const long nscalars = sp.size();
+    if (nscalars > 0)
+    {
+        try
+        {
+            sp_packed = new double[nscalars*grid->ncells];
+            st_packed = new double[nscalars*grid->ncells];
+        }
+        catch (std::exception &e)
+        {
+            master->print_error("Packed scalar fields cannot be allocated\n");
+            throw;
+        }
+    }
+
+    long n = 0;
+    for (FieldMap::iterator it=sp.begin(); it!=sp.end(); ++it, ++n)
+    {
+        nerror += it->second->init(&sp_packed[n*grid->ncells]);
+        nerror += st[it->first]->init(&st_packed[n*grid->ncells]);
+    }
+#else
     for (FieldMap::iterator it=sp.begin(); it!=sp.end(); ++it)
         nerror += it->second->init();
 
-    // allocate the scalar tendency fields
     for (FieldMap::iterator it=st.begin(); it!=st.end(); ++it)
         nerror += it->second->init();
+#endif
+
+    // allocate the single precision scalars and their tendencies
+    for (FieldMap::iterator it=sps.begin(); it!=sps.end(); ++it)
+        nerror += it->second->init();
+
+    for (FieldMap::iterator it=sts.begin(); it!=sts.end(); ++it)
+        nerror += it->second->init();
 
     // allocate the diagnostic scalars
     for (FieldMap::iterator it=sd.begin(); it!=sd.end(); ++it)
@@ -192,17 +256,6 @@ void Fields::init()
         rhorefh[k] = 1.; 
     }
 
-    // allocate help arrays for statistics;
-    umodel = new double[grid->kcells];
-    vmodel = new double[grid->kcells];
-
-    // Initialize at zero
-    for (int k=0; k<grid->kcells; ++k)
-    {
-        umodel[k] = 0.;
-        vmodel[k] = 0.; 
-    }
-
     // Get global cross-list from cross.cxx
     std::vector<std::string> *crosslist_global = model->cross->get_crosslist(); 
 
@@ -217,6 +270,16 @@ void Fields::init()
         check_added_cross(it->first, "fluxtop", crosslist_global, &crossfluxtop);
     }
 
+    for (FieldMap::const_iterator it=sps.begin(); it!=sps.end(); ++it)
+    {
+        check_added_cross(it->first, "",        crosslist_global, &crosssimple);
+        check_added_cross(it->first, "lngrad",  crosslist_global, &crosslngrad);
+        check_added_cross(it->first, "bot",     crosslist_global, &crossbot);
+        check_added_cross(it->first, "top",     crosslist_global, &crosstop);
+        check_added_cross(it->first, "fluxbot", crosslist_global, &crossfluxbot);
+        check_added_cross(it->first, "fluxtop", crosslist_global, &crossfluxtop);
+    }
+
     for (FieldMap::const_iterator it=sd.begin(); it!=sd.end(); ++it)
     {
         check_added_cross(it->first, "",        crosslist_global, &crosssimple);
@@ -265,137 +328,172 @@ void Fields::exec()
     {
         for (FieldMap::iterator it=ap.begin(); it!=ap.end(); ++it)
             grid->calc_mean(it->second->datamean, it->second->data, grid->kcells);
+
+        for (FieldMap::iterator it=sps.begin(); it!=sps.end(); ++it)
+            grid->calc_mean(it->second->datamean, it->second->data_single, grid->kcells);
     }
 }
 #endif
 
-void Fields::get_mask(Field3d *mfield, Field3d *mfieldh, Mask *m)
+void Fields::get_double_field(double* restrict data, const Field3d* const fld)
 {
-    if (m->name == "wplus")
-        calc_mask_wplus(mfield->data, mfieldh->data, mfieldh->databot, 
-                        stats->nmask, stats->nmaskh, &stats->nmaskbot, w->data);
-    else if (m->name == "wmin")                                                  
-        calc_mask_wmin(mfield->data, mfieldh->data, mfieldh->databot,
-                       stats->nmask, stats->nmaskh, &stats->nmaskbot, w->data);
+    if (!fld->is_single)
+    {
+        for (int n=0; n<grid->ncells; ++n)
+            data[n] = fld->data[n];
+    }
+    else
+    {
+        const float* restrict data_single = fld->data_single;
+        for (int n=0; n<grid->ncells; ++n)
+            data[n] = data_single[n];
+    }
 }
 
-void Fields::calc_mask_wplus(double* restrict mask, double* restrict maskh, double* restrict maskbot,
-        int* restrict nmask, int* restrict nmaskh, int* restrict nmaskbot,
-        double* restrict w)
+void Fields::set_single_field(Field3d* const fld, const double* restrict data)
 {
-    int ijk,ij,jj,kk,kstart;
+    float* restrict data_single = fld->data_single;
+    for (int n=0; n<grid->ncells; ++n)
+        data_single[n] = static_cast<float>(data[n]);
+}
 
-    jj = grid->icells;
-    kk = grid->ijcells;
-    kstart = grid->kstart;
+void Fields::get_layer_mean_velocity(double* const um, double* const vm, const double zmin, const double zmax)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
 
-    int ntmp;
+    double usum  = 0.;
+    double vsum  = 0.;
+    double dzsum = 0.;
 
-    for (int k=grid->kstart; k<grid->kend; k++)
+    for (int k=grid->kstart; k<grid->kend; ++k)
     {
-        nmask[k] = 0;
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+        if (grid->z[k] < zmin || grid->z[k] > zmax)
+            continue;
+
+        for (int j=grid->jstart; j<grid->jend; ++j)
+            #pragma ivdep
+            for (int i=grid->istart; i<grid->iend; ++i)
             {
-                ijk = i + j*jj + k*kk;
-                ntmp = (w[ijk] + w[ijk+kk]) > 0.;
-                nmask[k] += ntmp;
-                mask[ijk] = (double)ntmp;
+                const int ijk = i + j*jj + k*kk;
+                usum += u->data[ijk]*grid->dz[k];
+                vsum += v->data[ijk]*grid->dz[k];
             }
+
+        dzsum += grid->dz[k];
     }
 
-    for (int k=grid->kstart; k<grid->kend+1; k++)
+    if (dzsum == 0.)
     {
-        nmaskh[k] = 0;
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+        master->print_error("there are no levels between transzmin and transzmax\n");
+        throw 1;
+    }
+
+    grid->get_sum(&usum);
+    grid->get_sum(&vsum);
+
+    *um = usum / (grid->itot*grid->jtot*dzsum);
+    *vm = vsum / (grid->itot*grid->jtot*dzsum);
+}
+
+void Fields::shift_velocity(const double du, const double dv)
+{
+    // Shift the ghost cells and the boundary values as well, so that the fields remain consistent.
+    for (int n=0; n<grid->ncells; ++n)
+    {
+        u->data[n] -= du;
+        v->data[n] -= dv;
+    }
+
+    for (int n=0; n<grid->ijcells; ++n)
+    {
+        u->databot[n] -= du;
+        u->datatop[n] -= du;
+        v->databot[n] -= dv;
+        v->datatop[n] -= dv;
+    }
+}
+
+void Fields::get_mask(Mask *m)
+{
+    if (m->name == "wplus")
+        calc_mask_wplus(m->mfield, m->mfieldh, m->mfieldbot, w->data);
+    else if (m->name == "wmin")
+        calc_mask_wmin(m->mfield, m->mfieldh, m->mfieldbot, w->data);
+}
+
+// The masks are set in the ghost cells as well, the ghost cells of w are valid.
+void Fields::calc_mask_wplus(uint64_t* restrict mask, uint64_t* restrict maskh, uint64_t* restrict maskbot,
+                             double* restrict w)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+    const int kstart = grid->kstart;
+
+    for (int k=grid->kstart; k<grid->kend; k++)
+        for (int j=0; j<grid->jcells; j++)
+            for (int i=0; i<grid->icells; i++)
             {
-                ijk = i + j*jj + k*kk;
-                ntmp = w[ijk] > 0.;
-                nmaskh[k] += ntmp;
-                maskh[ijk] = (double)ntmp;
+                const int ijk = i + j*jj + k*kk;
+                if ((w[ijk] + w[ijk+kk]) > 0.)
+                    stats->set_mask_bit(mask, i, j, k);
+            }
+
+    for (int k=grid->kstart; k<grid->kend+1; k++)
+        for (int j=0; j<grid->jcells; j++)
+            for (int i=0; i<grid->icells; i++)
+            {
+                const int ijk = i + j*jj + k*kk;
+                if (w[ijk] > 0.)
+                    stats->set_mask_bit(maskh, i, j, k);
             }
-    }
 
     // Set the mask for surface projected quantities
     // In this case: velocity at surface, so zero
-    for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
+    for (int j=0; j<grid->jcells; j++)
+        for (int i=0; i<grid->icells; i++)
         {
-            ij  = i + j*jj;
-            ijk = i + j*jj + kstart*kk;
-            maskbot[ij] = maskh[ijk];
+            if (stats->get_mask_bit(maskh, i, j, kstart))
+                stats->set_mask_bit(maskbot, i, j, 0);
         }
-
-    grid->boundary_cyclic(mask);
-    grid->boundary_cyclic(maskh);
-    grid->boundary_cyclic_2d(maskbot);
-
-    master->sum(nmask , grid->kcells);
-    master->sum(nmaskh, grid->kcells);
-    *nmaskbot = nmaskh[grid->kstart];
 }
 
-void Fields::calc_mask_wmin(double* restrict mask, double* restrict maskh, double* restrict maskbot,
-        int* restrict nmask, int* restrict nmaskh, int* restrict nmaskbot,
-        double* restrict w)
+void Fields::calc_mask_wmin(uint64_t* restrict mask, uint64_t* restrict maskh, uint64_t* restrict maskbot,
+                            double* restrict w)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
     const int kstart = grid->kstart;
 
     for (int k=grid->kstart; k<grid->kend; k++)
-    {
-        nmask[k] = 0;
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+        for (int j=0; j<grid->jcells; j++)
+            for (int i=0; i<grid->icells; i++)
             {
                 const int ijk = i + j*jj + k*kk;
-                const int ntmp = (w[ijk] + w[ijk+kk]) <= 0.;
-                nmask[k] += ntmp;
-                mask[ijk] = (double)ntmp;
+                if ((w[ijk] + w[ijk+kk]) <= 0.)
+                    stats->set_mask_bit(mask, i, j, k);
             }
-    }
 
     for (int k=grid->kstart; k<grid->kend+1; k++)
-    {
-        nmaskh[k] = 0;
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+        for (int j=0; j<grid->jcells; j++)
+            for (int i=0; i<grid->icells; i++)
             {
                 const int ijk = i + j*jj + k*kk;
-                const int ntmp = w[ijk] <= 0.;
-                nmaskh[k] += ntmp;
-                maskh[ijk] = (double)ntmp;
+                if (w[ijk] <= 0.)
+                    stats->set_mask_bit(maskh, i, j, k);
             }
-    }
 
     // Set the mask for surface projected quantities
     // In this case: velocity at surface, so zero
-    for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
+    for (int j=0; j<grid->jcells; j++)
+        for (int i=0; i<grid->icells; i++)
         {
-            const int ij  = i + j*jj;
-            const int ijk = i + j*jj + kstart*kk;
-            maskbot[ij] = maskh[ijk];
+            if (stats->get_mask_bit(maskh, i, j, kstart))
+                stats->set_mask_bit(maskbot, i, j, 0);
         }
-
-    grid->boundary_cyclic(mask);
-    grid->boundary_cyclic(maskh);
-    grid->boundary_cyclic_2d(maskbot);
-
-    master->sum(nmask , grid->kcells);
-    master->sum(nmaskh, grid->kcells);
-    *nmaskbot = nmaskh[grid->kstart];
 }
 
-void Fields::exec_stats(Mask *m)
+void Fields::exec_stats()
 {
     // define locations
     const int uloc[] = {1,0,0};
@@ -403,179 +501,127 @@ void Fields::exec_stats(Mask *m)
     const int wloc[] = {0,0,1};
     const int sloc[] = {0,0,0};
 
-    const int uwloc[] = {1,0,1};
-    const int vwloc[] = {0,1,1};
-
     const double NoOffset = 0.;
 
     // save the area coverage of the mask
-    stats->calc_area(m->profs["area" ].data, sloc, stats->nmask );
-    stats->calc_area(m->profs["areah"].data, wloc, stats->nmaskh);
+    stats->calc_area("area" , sloc);
+    stats->calc_area("areah", wloc);
 
     // start with the stats on the w location, to make the wmean known for the flux calculations
-    stats->calc_mean(m->profs["w"].data, w->data, NoOffset, wloc, atmp["tmp4"]->data, stats->nmaskh);
-    for (int n=2; n<5; ++n)
-    {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(w->data, m->profs["w"].data, m->profs["w"+sn].data, n, wloc,
-                          atmp["tmp4"]->data, stats->nmaskh);
-    }
+    stats->calc_mean("w", w->data, NoOffset, wloc);
+    stats->calc_moments(w->data, "w", "w", wloc);
 
     // calculate the stats on the u location
-    // interpolate the mask horizontally onto the u coordinate
-    grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp3"]->data, sloc, uloc);
-    stats->calc_mean(m->profs["u"].data, u->data, grid->utrans, uloc, atmp["tmp1"]->data, stats->nmask);
-    stats->calc_mean(umodel            , u->data, NoOffset   , uloc, atmp["tmp1"]->data, stats->nmask);
-    for (int n=2; n<5; ++n)
-    {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(u->data, umodel, m->profs["u"+sn].data, n, uloc,
-                          atmp["tmp1"]->data, stats->nmask);
-    }
+    stats->calc_mean("u"     , u->data, grid->utrans, uloc);
+    stats->calc_mean("umodel", u->data, NoOffset    , uloc);
+    stats->calc_moments(u->data, "umodel", "u", uloc);
 
-    // interpolate the mask on half level horizontally onto the u coordinate
-    grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp4"]->data, wloc, uwloc);
     if (grid->swspatialorder == "2")
     {
-        stats->calc_grad_2nd(u->data, m->profs["ugrad"].data, grid->dzhi, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_2nd(u->data, umodel, w->data, m->profs["w"].data,
-                            m->profs["uw"].data, atmp["tmp2"]->data, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
+        stats->calc_grad_2nd(u->data, "ugrad", grid->dzhi, uloc);
+        stats->calc_flux_2nd(u->data, "umodel", w->data, "w", "uw", atmp["tmp2"]->data, uloc);
         if (model->diff->get_switch() == "smag2")
             stats->calc_diff_2nd(u->data, w->data, sd["evisc"]->data,
-                                m->profs["udiff"].data, grid->dzhi,
-                                u->datafluxbot, u->datafluxtop, 1., uloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
+                                 "udiff", grid->dzhi,
+                                 u->datafluxbot, u->datafluxtop, 1., uloc);
         else
-            stats->calc_diff_2nd(u->data, m->profs["udiff"].data, grid->dzhi, visc, uloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
+            stats->calc_diff_2nd(u->data, "udiff", grid->dzhi, visc, uloc);
 
     }
     else if (grid->swspatialorder == "4")
     {
-        stats->calc_grad_4th(u->data, m->profs["ugrad"].data, grid->dzhi4, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_4th(u->data, w->data, m->profs["uw"].data, atmp["tmp2"]->data, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_diff_4th(u->data, m->profs["udiff"].data, grid->dzhi4, visc, uloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
+        stats->calc_grad_4th(u->data, "ugrad", grid->dzhi4, uloc);
+        stats->calc_flux_4th(u->data, w->data, "uw", atmp["tmp2"]->data, uloc);
+        stats->calc_diff_4th(u->data, "udiff", grid->dzhi4, visc, uloc);
     }
 
     // calculate the stats on the v location
-    grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp3"]->data, sloc, vloc);
-    stats->calc_mean(m->profs["v"].data, v->data, grid->vtrans, vloc, atmp["tmp1"]->data, stats->nmask);
-    stats->calc_mean(vmodel            , v->data, NoOffset   , vloc, atmp["tmp1"]->data, stats->nmask);
-    for (int n=2; n<5; ++n)
-    {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(v->data, vmodel, m->profs["v"+sn].data, n, vloc,
-                          atmp["tmp1"]->data, stats->nmask);
-    }
+    stats->calc_mean("v"     , v->data, grid->vtrans, vloc);
+    stats->calc_mean("vmodel", v->data, NoOffset    , vloc);
+    stats->calc_moments(v->data, "vmodel", "v", vloc);
 
-    // interpolate the mask on half level horizontally onto the u coordinate
-    grid->interpolate_2nd(atmp["tmp1"]->data, atmp["tmp4"]->data, wloc, vwloc);
     if (grid->swspatialorder == "2")
     {
-        stats->calc_grad_2nd(v->data, m->profs["vgrad"].data, grid->dzhi, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_2nd(v->data, vmodel, w->data, m->profs["w"].data,
-                            m->profs["vw"].data, atmp["tmp2"]->data, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
+        stats->calc_grad_2nd(v->data, "vgrad", grid->dzhi, vloc);
+        stats->calc_flux_2nd(v->data, "vmodel", w->data, "w", "vw", atmp["tmp2"]->data, vloc);
         if (model->diff->get_switch() == "smag2")
             stats->calc_diff_2nd(v->data, w->data, sd["evisc"]->data,
-                                m->profs["vdiff"].data, grid->dzhi,
-                                v->datafluxbot, v->datafluxtop, 1., vloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
+                                 "vdiff", grid->dzhi,
+                                 v->datafluxbot, v->datafluxtop, 1., vloc);
         else
-            stats->calc_diff_2nd(v->data, m->profs["vdiff"].data, grid->dzhi, visc, vloc,
-                                atmp["tmp1"]->data, stats->nmaskh);
+            stats->calc_diff_2nd(v->data, "vdiff", grid->dzhi, visc, vloc);
 
     }
     else if (grid->swspatialorder == "4")
     {
-        stats->calc_grad_4th(v->data, m->profs["vgrad"].data, grid->dzhi4, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_flux_4th(v->data, w->data, m->profs["vw"].data, atmp["tmp2"]->data, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
-        stats->calc_diff_4th(v->data, m->profs["vdiff"].data, grid->dzhi4, visc, vloc,
-                            atmp["tmp1"]->data, stats->nmaskh);
+        stats->calc_grad_4th(v->data, "vgrad", grid->dzhi4, vloc);
+        stats->calc_flux_4th(v->data, w->data, "vw", atmp["tmp2"]->data, vloc);
+        stats->calc_diff_4th(v->data, "vdiff", grid->dzhi4, visc, vloc);
     }
 
     // calculate stats for the prognostic scalars
-    Diff_smag_2 *diffptr = static_cast<Diff_smag_2 *>(model->diff);
     for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
+        calc_scalar_stats(it->second, it->second->data);
+
+    // the single precision scalars are expanded into tmp2 before calculating their statistics
+    for (FieldMap::const_iterator it=sps.begin(); it!=sps.end(); ++it)
     {
-        stats->calc_mean(m->profs[it->first].data, it->second->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
-        for (int n=2; n<5; ++n)
-        {
-            std::stringstream ss;
-            ss << n;
-            std::string sn = ss.str();
-            stats->calc_moment(it->second->data, m->profs[it->first].data, m->profs[it->first+sn].data, n, sloc,
-                    atmp["tmp3"]->data, stats->nmask);
-        }
-        if (grid->swspatialorder == "2")
-        {
-            stats->calc_grad_2nd(it->second->data, m->profs[it->first+"grad"].data, grid->dzhi, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-            stats->calc_flux_2nd(it->second->data, m->profs[it->first].data, w->data, m->profs["w"].data,
-                                m->profs[it->first+"w"].data, atmp["tmp1"]->data, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-            if (model->diff->get_switch() == "smag2")
-                stats->calc_diff_2nd(it->second->data, w->data, sd["evisc"]->data,
-                                    m->profs[it->first+"diff"].data, grid->dzhi,
-                                    it->second->datafluxbot, it->second->datafluxtop, diffptr->tPr, sloc,
-                                    atmp["tmp4"]->data, stats->nmaskh);
-            else
-                stats->calc_diff_2nd(it->second->data, m->profs[it->first+"diff"].data, grid->dzhi, it->second->visc, sloc,
-                                    atmp["tmp4"]->data, stats->nmaskh);
-        }
-        else if (grid->swspatialorder == "4")
-        {
-            stats->calc_grad_4th(it->second->data, m->profs[it->first+"grad"].data, grid->dzhi4, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-            stats->calc_flux_4th(it->second->data, w->data, m->profs[it->first+"w"].data, atmp["tmp1"]->data, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-            stats->calc_diff_4th(it->second->data, m->profs[it->first+"diff"].data, grid->dzhi4, it->second->visc, sloc,
-                                atmp["tmp4"]->data, stats->nmaskh);
-        }
+        get_double_field(atmp["tmp2"]->data, it->second);
+        calc_scalar_stats(it->second, atmp["tmp2"]->data);
     }
 
     // Calculate pressure statistics
-    stats->calc_mean(m->profs["p"].data, sd["p"]->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
-    stats->calc_moment(sd["p"]->data, m->profs["p"].data, m->profs["p2"].data, 2, sloc,
-                      atmp["tmp1"]->data, stats->nmask);
+    stats->calc_mean("p", sd["p"]->data, NoOffset, sloc);
+    stats->calc_moment(sd["p"]->data, "p", "p2", 2, sloc);
     if (grid->swspatialorder == "2")
     {
-        stats->calc_grad_2nd(sd["p"]->data, m->profs["pgrad"].data, grid->dzhi, sloc,
-                             atmp["tmp4"]->data, stats->nmaskh);
-        stats->calc_flux_2nd(sd["p"]->data, m->profs["p"].data, w->data, m->profs["w"].data,
-                            m->profs["pw"].data, atmp["tmp1"]->data, sloc,
-                            atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_grad_2nd(sd["p"]->data, "pgrad", grid->dzhi, sloc);
+        stats->calc_flux_2nd(sd["p"]->data, "p", w->data, "w", "pw", atmp["tmp1"]->data, sloc);
     }
     else if (grid->swspatialorder == "4")
     {
-        stats->calc_grad_4th(sd["p"]->data, m->profs["pgrad"].data, grid->dzhi4, sloc,
-                             atmp["tmp4"]->data, stats->nmaskh);
-        stats->calc_flux_4th(sd["p"]->data, w->data, m->profs["pw"].data, atmp["tmp1"]->data, sloc,
-                             atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_grad_4th(sd["p"]->data, "pgrad", grid->dzhi4, sloc);
+        stats->calc_flux_4th(sd["p"]->data, w->data, "pw", atmp["tmp1"]->data, sloc);
     }
 
     // calculate the total fluxes
-    stats->add_fluxes(m->profs["uflux"].data, m->profs["uw"].data, m->profs["udiff"].data);
-    stats->add_fluxes(m->profs["vflux"].data, m->profs["vw"].data, m->profs["vdiff"].data);
+    stats->add_fluxes("uflux", "uw", "udiff");
+    stats->add_fluxes("vflux", "vw", "vdiff");
     for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
-        stats->add_fluxes(m->profs[it->first+"flux"].data, m->profs[it->first+"w"].data, m->profs[it->first+"diff"].data);
+        stats->add_fluxes(it->first+"flux", it->first+"w", it->first+"diff");
+    for (FieldMap::const_iterator it=sps.begin(); it!=sps.end(); ++it)
+        stats->add_fluxes(it->first+"flux", it->first+"w", it->first+"diff");
 
     if (model->diff->get_switch() == "smag2")
-        stats->calc_mean(m->profs["evisc"].data, sd["evisc"]->data, NoOffset, sloc, atmp["tmp3"]->data, stats->nmask);
+        stats->calc_mean("evisc", sd["evisc"]->data, NoOffset, sloc);
+}
+
+void Fields::calc_scalar_stats(Field3d* fld, double* data)
+{
+    const int sloc[] = {0,0,0};
+    const double NoOffset = 0.;
+
+    Diff_smag_2 *diffptr = static_cast<Diff_smag_2 *>(model->diff);
+
+    stats->calc_mean(fld->name, data, NoOffset, sloc);
+    stats->calc_moments(data, fld->name, fld->name, sloc);
+    if (grid->swspatialorder == "2")
+    {
+        stats->calc_grad_2nd(data, fld->name+"grad", grid->dzhi, sloc);
+        stats->calc_flux_2nd(data, fld->name, w->data, "w", fld->name+"w", atmp["tmp1"]->data, sloc);
+        if (model->diff->get_switch() == "smag2")
+            stats->calc_diff_2nd(data, w->data, sd["evisc"]->data,
+                                 fld->name+"diff", grid->dzhi,
+                                 fld->datafluxbot, fld->datafluxtop, diffptr->tPr, sloc);
+        else
+            stats->calc_diff_2nd(data, fld->name+"diff", grid->dzhi, fld->visc, sloc);
+    }
+    else if (grid->swspatialorder == "4")
+    {
+        stats->calc_grad_4th(data, fld->name+"grad", grid->dzhi4, sloc);
+        stats->calc_flux_4th(data, w->data, fld->name+"w", atmp["tmp1"]->data, sloc);
+        stats->calc_diff_4th(data, fld->name+"diff", grid->dzhi4, fld->visc, sloc);
+    }
 }
 
 void Fields::set_calc_mean_profs(bool sw)
@@ -618,7 +664,7 @@ void Fields::init_momentum_field(Field3d*& fld, Field3d*& fldt, std::string fldn
 
 void Fields::init_prognostic_field(std::string fldname, std::string longname, std::string unit)
 {
-    if (sp.find(fldname)!=sp.end())
+    if (sp.find(fldname)!=sp.end() || sps.find(fldname)!=sps.end())
     {
         master->print_error("\"%s\" already exists\n", fldname.c_str());
         throw 1;
@@ -638,6 +684,32 @@ void Fields::init_prognostic_field(std::string fldname, std::string longname, st
     a [fldname] = sp[fldname];
     ap[fldname] = sp[fldname];
     at[fldname] = st[fldname];
+
+    spall[fldname] = sp[fldname];
+}
+
+void Fields::init_prognostic_single_field(std::string fldname, std::string longname, std::string unit)
+{
+    if (sp.find(fldname)!=sp.end() || sps.find(fldname)!=sps.end())
+    {
+        master->print_error("\"%s\" already exists\n", fldname.c_str());
+        throw 1;
+    }
+
+    // add a new single precision scalar variable
+    sps[fldname] = new Field3d(grid, master, fldname, longname, unit, true);
+
+    // the tendency is kept in double precision
+    std::string fldtname  = fldname + "t";
+    std::string tlongname = "Tendency of " + longname;
+    std::string tunit     = unit + "s-1";
+    sts[fldname] = new Field3d(grid, master, fldtname, tlongname, tunit);
+
+    // only add the scalar to the collection of all fields, the loops over the
+    // prognostic fields and tendencies assume double precision
+    a[fldname] = sps[fldname];
+
+    spall[fldname] = sps[fldname];
 }
 
 void Fields::init_diagnostic_field(std::string fldname,std::string longname, std::string unit)
@@ -678,6 +750,15 @@ void Fields::create(Input *inputin)
     for (FieldMap::iterator it=sp.begin(); it!=sp.end(); ++it)
         nerror += randomize(inputin, it->first, it->second->data);
 
+    // Randomize the single precision scalars and add their mean profiles in double precision in tmp1
+    for (FieldMap::iterator it=sps.begin(); it!=sps.end(); ++it)
+    {
+        get_double_field(atmp["tmp1"]->data, it->second);
+        nerror += randomize(inputin, it->first, atmp["tmp1"]->data);
+        nerror += add_mean_prof(inputin, it->first, atmp["tmp1"]->data, 0.);
+        set_single_field(it->second, atmp["tmp1"]->data);
+    }
+
     // Add Vortices
     nerror += add_vortex_pair(inputin);
 
@@ -836,6 +917,24 @@ void Fields::load(int n)
         }  
     }
 
+    // the single precision scalars are stored in double precision on disk, which keeps the restart files interchangeable
+    for (FieldMap::const_iterator it=sps.begin(); it!=sps.end(); ++it)
+    {
+        char filename[256];
+        std::sprintf(filename, "%s.%07d", it->second->name.c_str(), n);
+        master->print_message("Loading \"%s\" ... ", filename);
+        if (grid->load_field3d(atmp["tmp3"]->data, atmp["tmp1"]->data, atmp["tmp2"]->data, filename, NoOffset))
+        {
+            master->print_message("FAILED\n");
+            ++nerror;
+        }
+        else
+        {
+            set_single_field(it->second, atmp["tmp3"]->data);
+            master->print_message("OK\n");
+        }
+    }
+
     if (nerror)
         throw 1;
 }
@@ -852,7 +951,12 @@ void Fields::create_stats()
         stats->add_prof(v->name, v->longname, v->unit, "z" );
         stats->add_prof(w->name, w->longname, w->unit, "zh" );
 
-        for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
+        // the means of the velocities without the Galilean transformation, for the moments and fluxes
+        stats->add_tmp_prof("umodel");
+        stats->add_tmp_prof("vmodel");
+
+        // the statistics of the single precision scalars are identical to those of the other scalars
+        for (FieldMap::const_iterator it=spall.begin(); it!=spall.end(); ++it)
             stats->add_prof(it->first,it->second->longname, it->second->unit, "z");
 
         stats->add_prof(sd["p"]->name, sd["p"]->longname, sd["p"]->unit, "z");
@@ -874,32 +978,32 @@ void Fields::create_stats()
             stats->add_prof(u->name + sn,"Moment "+ sn + " of the " + u->longname,"(" + u->unit + ")"+sn, "z" );
             stats->add_prof(v->name + sn,"Moment "+ sn + " of the " + v->longname,"(" + v->unit + ")"+sn, "z" );
             stats->add_prof(w->name + sn,"Moment "+ sn + " of the " + w->longname,"(" + w->unit + ")"+sn, "zh" );
-            for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
+            for (FieldMap::const_iterator it=spall.begin(); it!=spall.end(); ++it)
                 stats->add_prof(it->first + sn,"Moment "+ sn + " of the " + it->second->longname,"(" + it->second->unit + ")"+sn, "z" );
         }
 
         // gradients
         stats->add_prof(u->name + "grad", "Gradient of the " + u->longname,"s-1","zh");
         stats->add_prof(v->name + "grad", "Gradient of the " + v->longname,"s-1","zh");
-        for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
+        for (FieldMap::const_iterator it=spall.begin(); it!=spall.end(); ++it)
             stats->add_prof(it->first+"grad", "Gradient of the " + it->second->longname, it->second->unit + " m-1", "zh");
 
         // turbulent fluxes
         stats->add_prof("uw", "Turbulent flux of the " + u->longname, "m2 s-2", "zh");
         stats->add_prof("vw", "Turbulent flux of the " + v->longname, "m2 s-2", "zh");
-        for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
+        for (FieldMap::const_iterator it=spall.begin(); it!=spall.end(); ++it)
             stats->add_prof(it->first+"w", "Turbulent flux of the " + it->second->longname, it->second->unit + " m s-1", "zh");
 
         // Diffusive fluxes
         stats->add_prof("udiff", "Diffusive flux of the " + u->longname, "m2 s-2", "zh");
         stats->add_prof("vdiff", "Diffusive flux of the " + v->longname, "m2 s-2", "zh");
-        for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
+        for (FieldMap::const_iterator it=spall.begin(); it!=spall.end(); ++it)
             stats->add_prof(it->first+"diff", "Diffusive flux of the " + it->second->longname, it->second->unit + " m s-1", "zh");
 
         //Total fluxes
         stats->add_prof("uflux", "Total flux of the " + u->longname, "m2 s-2", "zh");
         stats->add_prof("vflux", "Total flux of the " + v->longname, "m2 s-2", "zh");
-        for (FieldMap::const_iterator it=sp.begin(); it!=sp.end(); ++it)
+        for (FieldMap::const_iterator it=spall.begin(); it!=spall.end(); ++it)
             stats->add_prof(it->first+"flux", "Total flux of the " + it->second->longname, it->second->unit + " m s-1", "zh");
     }
 
@@ -930,6 +1034,24 @@ void Fields::save(int n)
         }
     }
 
+    for (FieldMap::const_iterator it=sps.begin(); it!=sps.end(); ++it)
+    {
+        char filename[256];
+        std::sprintf(filename, "%s.%07d", it->second->name.c_str(), n);
+        master->print_message("Saving \"%s\" ... ", filename);
+
+        get_double_field(atmp["tmp3"]->data, it->second);
+        if (grid->save_field3d(atmp["tmp3"]->data, atmp["tmp1"]->data, atmp["tmp2"]->data, filename, NoOffset))
+        {
+            master->print_message("FAILED\n");
+            ++nerror;
+        }
+        else
+        {
+            master->print_message("OK\n");
+        }
+    }
+
     if (nerror)
         throw 1;
 }
@@ -1044,11 +1166,28 @@ void Fields::exec_cross()
 
     Cross* cross = model->cross;
 
+    // single precision fields are expanded into tmp3 before taking the cross section
     for (std::vector<std::string>::const_iterator it=crosssimple.begin(); it<crosssimple.end(); ++it)
-        nerror += cross->cross_simple(a[*it]->data, atmp["tmp1"]->data, a[*it]->name);
+    {
+        double* data = a[*it]->data;
+        if (a[*it]->is_single)
+        {
+            get_double_field(atmp["tmp3"]->data, a[*it]);
+            data = atmp["tmp3"]->data;
+        }
+        nerror += cross->cross_simple(data, atmp["tmp1"]->data, a[*it]->name);
+    }
 
     for (std::vector<std::string>::const_iterator it=crosslngrad.begin(); it<crosslngrad.end(); ++it)
-        nerror += cross->cross_lngrad(a[*it]->data, atmp["tmp1"]->data, atmp["tmp2"]->data, grid->dzi4, a[*it]->name + "lngrad");
+    {
+        double* data = a[*it]->data;
+        if (a[*it]->is_single)
+        {
+            get_double_field(atmp["tmp3"]->data, a[*it]);
+            data = atmp["tmp3"]->data;
+        }
+        nerror += cross->cross_lngrad(data, atmp["tmp1"]->data, atmp["tmp2"]->data, grid->dzi4, a[*it]->name + "lngrad");
+    }
 
     for (std::vector<std::string>::const_iterator it=crossfluxbot.begin(); it<crossfluxbot.end(); ++it)
         nerror += cross->cross_plane(a[*it]->datafluxbot, atmp["tmp1"]->data, a[*it]->name + "fluxbot");
@@ -209,9 +209,11 @@ void Force::prepare_device()
         cuda_safe_call(cudaMemcpy(wls_g, wls, nmemsize, cudaMemcpyHostToDevice));
     }
 
-    if (swtimedep == "1")
+    if (swtimedep != "0")
     {
-        int nmemsize2 = grid->kmax*timedeptime.size()*sizeof(double);
+        // In case of NetCDF input only the resident window of time records is stored.
+        const int nrecords = (swtimedep == "nc") ? timedepwindow : timedeptime.size();
+        int nmemsize2 = grid->kmax*nrecords*sizeof(double);
         for (std::map<std::string, double *>::const_iterator it=timedepdata.begin(); it!=timedepdata.end(); ++it)
         {
             cuda_safe_call(cudaMalloc(&timedepdata_g[it->first], nmemsize2));
@@ -237,13 +239,20 @@ void Force::clear_device()
     if (swwls == "1")
         cuda_safe_call(cudaFree(wls_g));
 
-    if (swtimedep == "1")
+    if (swtimedep != "0")
     {
         for (std::map<std::string, double *>::const_iterator it=timedepdata.begin(); it!=timedepdata.end(); ++it)
             cuda_safe_call(cudaFree(timedepdata_g[it->first]));
     }
 }
 
+void Force::update_time_dependent_window_g()
+{
+    const int nmemsize = grid->kmax*timedepwindow*sizeof(double);
+    for (std::map<std::string, double *>::const_iterator it=timedepdata.begin(); it!=timedepdata.end(); ++it)
+        cuda_safe_call(cudaMemcpy(timedepdata_g[it->first], it->second, nmemsize, cudaMemcpyHostToDevice));
+}
+
 #ifdef USECUDA
 void Force::exec(double dt)
 {
@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <iostream>
 #include <math.h>
+#include <netcdf>
 #include "master.h"
 #include "grid.h"
 #include "fields.h"
@@ -35,6 +36,8 @@
 #include "boundary.h"
 
 using namespace Finite_difference::O2;
+using namespace netCDF;
+using namespace netCDF::exceptions;
 
 Force::Force(Model* modelin, Input* inputin)
 {
@@ -51,6 +54,9 @@ Force::Force(Model* modelin, Input* inputin)
     vg_g  = 0;
     wls_g = 0;
 
+    timedepwindow = 2;
+    timedepstart  = 0;
+
     int nerror = 0;
     nerror += inputin->get_item(&swlspres, "force", "swlspres", "", "0");
     nerror += inputin->get_item(&swls    , "force", "swls"    , "", "0");
@@ -89,6 +95,21 @@ Force::Force(Model* modelin, Input* inputin)
     nerror += inputin->get_item(&swtimedep  , "force", "swtimedep"  , "", "0");
     nerror += inputin->get_list(&timedeplist, "force", "timedeplist", "");
 
+    if (swtimedep == "nc")
+    {
+        nerror += inputin->get_item(&timedepwindow, "force", "timedepwindow", "", 2);
+        if (timedepwindow < 2)
+        {
+            ++nerror;
+            master->print_error("timedepwindow should be at least 2\n");
+        }
+    }
+    else if (swtimedep != "0" && swtimedep != "1")
+    {
+        ++nerror;
+        master->print_error("\"%s\" is an illegal option for swtimedep\n", swtimedep.c_str());
+    }
+
     if (nerror)
         throw 1;
 }
@@ -146,7 +167,7 @@ void Force::create(Input *inputin)
     {
         // check whether the fields in the list exist in the prognostic fields
         for (std::vector<std::string>::const_iterator it=lslist.begin(); it!=lslist.end(); ++it)
-            if (!fields->ap.count(*it))
+            if (!fields->ap.count(*it) && !fields->sps.count(*it))
             {
                 master->print_error("field %s in [force][lslist] is illegal\n", it->c_str());
                 ++nerror;
@@ -187,11 +208,142 @@ void Force::create(Input *inputin)
         for (std::vector<std::string>::const_iterator ittmp=tmplist.begin(); ittmp!=tmplist.end(); ++ittmp)
             master->print_warning("%s is not supported (yet) as a time dependent parameter\n", ittmp->c_str());
     }
+    else if (swtimedep == "nc")
+        nerror += create_time_dependent_nc();
 
     if (nerror)
         throw 1;
 }
 
+int Force::create_time_dependent_nc()
+{
+    int nerror = 0;
+    const int kmax = grid->kmax;
+    const std::string filename = master->simname + ".timeprof.nc";
+
+    // Collect the large scale forcings that are time dependent.
+    std::vector<std::string> tmplist = timedeplist;
+    std::vector<std::string> names;
+    for (std::vector<std::string>::const_iterator it=lslist.begin(); it!=lslist.end(); ++it)
+    {
+        std::vector<std::string>::iterator ittmp = std::find(tmplist.begin(), tmplist.end(), *it);
+        if (ittmp != tmplist.end())
+        {
+            names.push_back(*it + "ls");
+            tmplist.erase(ittmp);
+        }
+    }
+
+    for (std::vector<std::string>::const_iterator ittmp=tmplist.begin(); ittmp!=tmplist.end(); ++ittmp)
+        master->print_warning("%s is not supported (yet) as a time dependent parameter\n", ittmp->c_str());
+
+    // Read the time axis on the master, the profiles are read later in windows.
+    int ntime = 0;
+    if (master->mpiid == 0)
+    {
+        std::printf("Processing NetCDF file \"%s\"\n", filename.c_str());
+        try
+        {
+            NcFile dataFile(filename, NcFile::read);
+
+            NcDim t_dim = dataFile.getDim("t");
+            NcDim z_dim = dataFile.getDim("z");
+            NcVar t_var = dataFile.getVar("t");
+
+            if (t_dim.isNull() || z_dim.isNull() || t_var.isNull())
+            {
+                master->print_error("\"%s\" should contain the dimensions \"t\" and \"z\" and the variable \"t\"\n", filename.c_str());
+                ++nerror;
+            }
+            else
+            {
+                ntime = t_dim.getSize();
+                timedeptime.resize(ntime);
+                if (ntime > 0)
+                    t_var.getVar(&timedeptime[0]);
+
+                const int nz = z_dim.getSize();
+                if (nz < kmax)
+                {
+                    master->print_error("only %d of %d levels can be read from \"%s\"\n", nz, kmax, filename.c_str());
+                    ++nerror;
+                }
+
+                for (std::vector<std::string>::const_iterator it=names.begin(); it!=names.end(); ++it)
+                    if (dataFile.getVar(*it).isNull())
+                    {
+                        master->print_error("no time dependent profile \"%s\" found in \"%s\"\n", it->c_str(), filename.c_str());
+                        ++nerror;
+                    }
+            }
+        }
+        catch(NcException& e)
+        {
+            master->print_error("NetCDF exception: %s\n", e.what());
+            ++nerror;
+        }
+
+        if (ntime == 0 && nerror == 0)
+        {
+            master->print_error("\"%s\" contains no time records\n", filename.c_str());
+            ++nerror;
+        }
+    }
+
+    master->broadcast(&nerror, 1);
+    if (nerror)
+        return nerror;
+
+    master->broadcast(&ntime, 1);
+    timedeptime.resize(ntime);
+    master->broadcast(&timedeptime[0], ntime);
+
+    // Allocate the window and fill it with the first records.
+    timedepwindow = std::min(timedepwindow, ntime);
+    for (std::vector<std::string>::const_iterator it=names.begin(); it!=names.end(); ++it)
+        timedepdata[*it] = new double[timedepwindow*kmax];
+
+    read_time_dependent_window(0);
+
+    return 0;
+}
+
+void Force::read_time_dependent_window(const int start)
+{
+    const int kmax  = grid->kmax;
+    const int ntime = timedeptime.size();
+
+    // Keep the window within the time axis, such that it is always completely filled.
+    timedepstart = std::min(start, ntime-timedepwindow);
+
+    int nerror = 0;
+    if (master->mpiid == 0)
+    {
+        try
+        {
+            NcFile dataFile(master->simname + ".timeprof.nc", NcFile::read);
+
+            std::vector<size_t> index = {static_cast<size_t>(timedepstart), 0};
+            std::vector<size_t> count = {static_cast<size_t>(timedepwindow), static_cast<size_t>(kmax)};
+
+            for (std::map<std::string, double*>::const_iterator it=timedepdata.begin(); it!=timedepdata.end(); ++it)
+                dataFile.getVar(it->first).getVar(index, count, it->second);
+        }
+        catch(NcException& e)
+        {
+            master->print_error("NetCDF exception: %s\n", e.what());
+            ++nerror;
+        }
+    }
+
+    master->broadcast(&nerror, 1);
+    if (nerror)
+        throw 1;
+
+    for (std::map<std::string, double*>::const_iterator it=timedepdata.begin(); it!=timedepdata.end(); ++it)
+        master->broadcast(it->second, timedepwindow*kmax);
+}
+
 #ifndef USECUDA
 void Force::exec(double dt)
 {
@@ -209,13 +361,19 @@ void Force::exec(double dt)
     if (swls == "1")
     {
         for (std::vector<std::string>::const_iterator it=lslist.begin(); it!=lslist.end(); ++it)
-            calc_large_scale_source(fields->st[*it]->data, lsprofs[*it]);
+        {
+            // The tendencies of the single precision scalars are stored in a separate map.
+            Field3d* fldt = fields->sts.count(*it) ? fields->sts[*it] : fields->st[*it];
+            calc_large_scale_source(fldt->data, lsprofs[*it]);
+        }
     }
 
     if (swwls == "1")
     {
         for (FieldMap::const_iterator it = fields->st.begin(); it!=fields->st.end(); ++it)
             advec_wls_2nd(it->second->data, fields->sp[it->first]->datamean, wls, grid->dzhi);
+        for (FieldMap::const_iterator it = fields->sts.begin(); it!=fields->sts.end(); ++it)
+            advec_wls_2nd(it->second->data, fields->sps[it->first]->datamean, wls, grid->dzhi);
     }
 }
 #endif
@@ -225,16 +383,10 @@ void Force::update_time_dependent()
     if (swtimedep == "0")
         return;
 
-    // first find the index for the time entries
+    // first find the index for the time entries with a binary search on the sorted times
     unsigned int index0 = 0;
-    unsigned int index1 = 0;
-    for (std::vector<double>::const_iterator it=timedeptime.begin(); it!=timedeptime.end(); ++it)
-    {
-        if (model->timeloop->get_time() < *it)
-            break;
-        else
-            ++index1;
-    }
+    unsigned int index1 = std::upper_bound(timedeptime.begin(), timedeptime.end(), model->timeloop->get_time())
+                        - timedeptime.begin();
 
     // second, calculate the weighting factor
     double fac0, fac1;
@@ -262,6 +414,21 @@ void Force::update_time_dependent()
         fac1 = (model->timeloop->get_time() - timedeptime[index0]) / timestep;
     }
 
+    // Move the window of the NetCDF input in case the bracketing records are not resident. The window
+    // starts at the lower record, such that the upcoming records are read ahead in the same access.
+    if (swtimedep == "nc")
+    {
+        if (static_cast<int>(index0) < timedepstart || static_cast<int>(index1) >= timedepstart+timedepwindow)
+        {
+            read_time_dependent_window(index0);
+#ifdef USECUDA
+            update_time_dependent_window_g();
+#endif
+        }
+        index0 -= timedepstart;
+        index1 -= timedepstart;
+    }
+
     update_time_dependent_profs(fac0, fac1, index0, index1);
 }
 
@@ -86,11 +86,43 @@ Grid::Grid(Model *modelin, Input *inputin)
     nerror += inputin->get_item(&utrans, "grid", "utrans", "", 0.);
     nerror += inputin->get_item(&vtrans, "grid", "vtrans", "", 0.);
 
+    nerror += inputin->get_item(&swtrans, "grid", "swtrans", "", "0");
+    if (swtrans == "1")
+    {
+        nerror += inputin->get_item(&transtime, "grid", "transtime", "");
+        nerror += inputin->get_item(&transzmin, "grid", "transzmin", "", 0.);
+        nerror += inputin->get_item(&transzmax, "grid", "transzmax", "", zsize);
+    }
+
     nerror += inputin->get_item(&swspatialorder, "grid", "swspatialorder", "");
 
     if (nerror)
         throw 1;
 
+    if (!(swtrans == "0" || swtrans == "1"))
+    {
+        master->print_error("\"%s\" is an illegal value for swtrans\n", swtrans.c_str());
+        throw 1;
+    }
+    if (swtrans == "1")
+    {
+        #ifdef USECUDA
+        master->print_error("swtrans=1 is not supported on the GPU\n");
+        throw 1;
+        #endif
+
+        if (transtime <= 0.)
+        {
+            master->print_error("transtime has to be larger than zero\n");
+            throw 1;
+        }
+        if (transzmax <= transzmin)
+        {
+            master->print_error("transzmax has to be larger than transzmin\n");
+            throw 1;
+        }
+    }
+
     if (!(swspatialorder == "2" || swspatialorder == "4"))
     {
         master->print_error("\"%s\" is an illegal value for swspatialorder\n", swspatialorder.c_str());
@@ -400,6 +432,86 @@ void Grid::calculate()
     }
 }
 
+/**
+ * This function saves the Galilean transformation velocity, which changes in time in case swtrans=1.
+ * @param iotime Time in the name of the file.
+ */
+void Grid::save_trans(const int iotime)
+{
+    int nerror = 0;
+
+    if (master->mpiid == 0)
+    {
+        char filename[256];
+        std::sprintf(filename, "trans.%07d", iotime);
+
+        master->print_message("Saving \"%s\" ... ", filename);
+
+        FILE *pFile;
+        pFile = fopen(filename, "wbx");
+
+        if (pFile == NULL)
+        {
+            master->print_message("FAILED\n", filename);
+            ++nerror;
+        }
+        else
+        {
+            fwrite(&utrans, sizeof(double), 1, pFile);
+            fwrite(&vtrans, sizeof(double), 1, pFile);
+
+            fclose(pFile);
+            master->print_message("OK\n");
+        }
+    }
+
+    // Broadcast the error code to prevent deadlocks in case of error.
+    master->broadcast(&nerror, 1);
+    if (nerror)
+        throw 1;
+}
+
+/**
+ * This function loads the Galilean transformation velocity that belongs to the fields of a restart.
+ * @param iotime Time in the name of the file.
+ */
+void Grid::load_trans(const int iotime)
+{
+    int nerror = 0;
+
+    if (master->mpiid == 0)
+    {
+        char filename[256];
+        std::sprintf(filename, "trans.%07d", iotime);
+
+        master->print_message("Loading \"%s\" ... ", filename);
+
+        FILE *pFile;
+        pFile = fopen(filename, "rb");
+
+        if (pFile == NULL)
+        {
+            master->print_error("\"%s\" does not exist\n", filename);
+            ++nerror;
+        }
+        else
+        {
+            fread(&utrans, sizeof(double), 1, pFile);
+            fread(&vtrans, sizeof(double), 1, pFile);
+
+            fclose(pFile);
+            master->print_message("OK\n");
+        }
+    }
+
+    master->broadcast(&nerror, 1);
+    if (nerror)
+        throw 1;
+
+    master->broadcast(&utrans, 1);
+    master->broadcast(&vtrans, 1);
+}
+
 /**
  * This function checks whether the number of ghost cells does not exceed the slice thickness.
  */
@@ -507,6 +619,17 @@ void Grid::interpolate_4th(double* restrict out, double* restrict in, const int
 }
 
 void Grid::calc_mean(double* restrict prof, const double* restrict data, const int krange)
+{
+    calc_mean_kernel(prof, data, krange);
+}
+
+void Grid::calc_mean(double* restrict prof, const float* restrict data, const int krange)
+{
+    calc_mean_kernel(prof, data, krange);
+}
+
+template<typename T>
+void Grid::calc_mean_kernel(double* restrict prof, const T* restrict data, const int krange)
 {
     const int jj = icells;
     const int kk = ijcells;
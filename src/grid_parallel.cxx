@@ -23,6 +23,7 @@
 #ifdef USEMPI
 #include <fftw3.h>
 #include <cstdio>
+#include <type_traits>
 #include "master.h"
 #include "grid.h"
 #include "defines.h"
@@ -47,6 +48,20 @@ void Grid::init_mpi()
     MPI_Type_vector(datacount, datablock, datastride, MPI_DOUBLE, &northsouthedge);
     MPI_Type_commit(&northsouthedge);
 
+    // east west single precision
+    datacount  = jcells*kcells;
+    datablock  = igc;
+    datastride = icells;
+    MPI_Type_vector(datacount, datablock, datastride, MPI_FLOAT, &eastwestedge_single);
+    MPI_Type_commit(&eastwestedge_single);
+
+    // north south single precision
+    datacount  = kcells;
+    datablock  = icells*jgc;
+    datastride = icells*jcells;
+    MPI_Type_vector(datacount, datablock, datastride, MPI_FLOAT, &northsouthedge_single);
+    MPI_Type_commit(&northsouthedge_single);
+
     // east west 2d
     datacount  = jcells;
     datablock  = igc;
@@ -157,6 +172,8 @@ void Grid::exit_mpi()
         MPI_Type_free(&northsouthedge);
         MPI_Type_free(&eastwestedge2d);
         MPI_Type_free(&northsouthedge2d);
+        MPI_Type_free(&eastwestedge_single);
+        MPI_Type_free(&northsouthedge_single);
         MPI_Type_free(&transposez);
         MPI_Type_free(&transposez2);
         MPI_Type_free(&transposex);
@@ -175,9 +192,24 @@ void Grid::exit_mpi()
 }
 
 void Grid::boundary_cyclic(double* restrict data, Edge edge)
+{
+    boundary_cyclic_kernel(data, edge);
+}
+
+void Grid::boundary_cyclic(float* restrict data, Edge edge)
+{
+    boundary_cyclic_kernel(data, edge);
+}
+
+template<typename T>
+void Grid::boundary_cyclic_kernel(T* restrict data, Edge edge)
 {
     const int ncount = 1;
 
+    // Select the MPI datatypes that match the precision of the field.
+    MPI_Datatype eastwestedge   = std::is_same<T, float>::value ? this->eastwestedge_single   : this->eastwestedge;
+    MPI_Datatype northsouthedge = std::is_same<T, float>::value ? this->northsouthedge_single : this->northsouthedge;
+
     if (edge == East_west_edge || edge == Both_edges)
     {
         // Communicate east-west edges.
@@ -447,6 +479,11 @@ void Grid::get_max(double *var)
     MPI_Allreduce(&varl, var, 1, MPI_DOUBLE, MPI_MAX, master->commxy);
 }
 
+void Grid::get_max(double *var, const int n)
+{
+    MPI_Allreduce(MPI_IN_PLACE, var, n, MPI_DOUBLE, MPI_MAX, master->commxy);
+}
+
 void Grid::get_max(int *var)
 {
     int varl = *var;
@@ -38,6 +38,17 @@ void Grid::exit_mpi()
 }
 
 void Grid::boundary_cyclic(double* restrict data, Edge edge)
+{
+    boundary_cyclic_kernel(data, edge);
+}
+
+void Grid::boundary_cyclic(float* restrict data, Edge edge)
+{
+    boundary_cyclic_kernel(data, edge);
+}
+
+template<typename T>
+void Grid::boundary_cyclic_kernel(T* restrict data, Edge edge)
 {
     const int jj = icells;
     const int kk = icells*jcells;
@@ -265,6 +276,10 @@ void Grid::get_max(double *var)
 {
 }
 
+void Grid::get_max(double *var, const int n)
+{
+}
+
 void Grid::get_max(int *var)
 {
 }
@@ -87,28 +87,20 @@ int Input::read_ini_file()
     int n;
     bool blockset = false;
     int nerrors = 0;
-    int nlines  = 0;
     int nline;
 
     if (master->mpiid == 0)
-    {
         std::printf("Processing ini file \"%s\"\n", inputfilename.c_str());
-        while (std::fgets(inputline, 256, inputfile) != NULL)
-            nlines++;
-        rewind(inputfile);
-    }
-    master->broadcast(&nlines, 1);
+
+    std::vector<std::string> lines;
+    read_lines(&lines, inputfile);
+    const int nlines = lines.size();
 
     // check the cases: comments, empty line, block, value, rubbish
     for (int nn=0; nn<nlines; nn++)
     {
         nline = nn+1;
-        if (master->mpiid == 0)
-        {
-            // fetch a line and broadcast it
-            std::fgets(inputline, 256, inputfile);
-        }
-        master->broadcast(inputline, 256);
+        std::strcpy(inputline, lines[nn].c_str());
 
         // check for empty line
         n = std::sscanf(inputline, " %s ", temp1);
@@ -189,10 +181,40 @@ int Input::read_ini_file()
         }
     }
 
+    return nerrors;
+}
+
+void Input::read_lines(std::vector<std::string>* lines, FILE* inputfile)
+{
+    // Read the complete file on the master, such that it can be broadcast in a single message.
+    std::string contents;
     if (master->mpiid == 0)
+    {
+        char buffer[4096];
+        size_t nread;
+        while ((nread = std::fread(buffer, 1, sizeof(buffer), inputfile)) > 0)
+            contents.append(buffer, nread);
         fclose(inputfile);
+    }
 
-    return nerrors;
+    int size = contents.size();
+    master->broadcast(&size, 1);
+    contents.resize(size);
+    if (size > 0)
+        master->broadcast(&contents[0], size);
+
+    // Split the lines as std::fgets with a buffer of 256 characters would return them.
+    const size_t maxlength = 255;
+    size_t start = 0;
+    while (start < contents.size())
+    {
+        size_t end = contents.find('\n', start);
+        end = (end == std::string::npos) ? contents.size() : end+1;
+        end = std::min(end, start+maxlength);
+
+        lines->push_back(contents.substr(start, end-start));
+        start = end;
+    }
 }
 
 int Input::read_data_file(Data_map* series, std::string inputname, bool optional)
@@ -230,19 +252,16 @@ int Input::read_data_file(Data_map* series, std::string inputname, bool optional
     if (doreturn)
         return 0;
 
-    int nlines = 0;
     int nline;
     int nvar = 0;
     std::vector<std::string> varnames;
 
     if (master->mpiid == 0)
-    {
         std::printf("Processing data file \"%s\"\n", inputfilename.c_str());
-        while (std::fgets(inputline, 256, inputfile) != NULL)
-            nlines++;
-        rewind(inputfile);
-    }
-    master->broadcast(&nlines, 1);
+
+    std::vector<std::string> lines;
+    read_lines(&lines, inputfile);
+    const int nlines = lines.size();
 
     int nn;
 
@@ -250,12 +269,7 @@ int Input::read_data_file(Data_map* series, std::string inputname, bool optional
     for (nn=0; nn<nlines; nn++)
     {
         nline = nn+1;
-        if (master->mpiid == 0)
-        {
-            // fetch a line and broadcast it
-            std::fgets(inputline, 256, inputfile);
-        }
-        master->broadcast(inputline, 256);
+        std::strcpy(inputline, lines[nn].c_str());
 
         // check for empty line
         n = std::sscanf(inputline, " %s ", temp1);
@@ -297,10 +311,7 @@ int Input::read_data_file(Data_map* series, std::string inputname, bool optional
         if (nvar == 0)
         {
             if (master->mpiid == 0)
-            {
                 std::printf("ERROR no variable names in header\n");
-                fclose(inputfile);
-            }
             return 1;
         }
 
@@ -319,12 +330,7 @@ int Input::read_data_file(Data_map* series, std::string inputname, bool optional
     for (nn++; nn<nlines; nn++)
     {
         nline = nn+1;
-        if (master->mpiid == 0)
-        {
-            // fetch a line and broadcast it
-            std::fgets(inputline, 256, inputfile);
-        }
-        master->broadcast(inputline, 256);
+        std::strcpy(inputline, lines[nn].c_str());
 
         // check for empty line
         n = std::sscanf(inputline, " %s ", temp1);
@@ -351,10 +357,7 @@ int Input::read_data_file(Data_map* series, std::string inputname, bool optional
             if (n != 1)
             {
                 if (master->mpiid == 0)
-                {
                     std::printf("ERROR line %d: \"%s\" is not a correct data value\n", nline, substring);
-                    fclose(inputfile);
-                }
                 return 1;
             }
 
@@ -368,10 +371,7 @@ int Input::read_data_file(Data_map* series, std::string inputname, bool optional
         if (ncols != nvar)
         {
             if (master->mpiid == 0)
-            {
                 std::printf("ERROR line %d: %d data columns, but %d defined variables\n", nline, ncols, nvar);
-                fclose(inputfile);
-            }
             return 1;
         }
 
@@ -380,9 +380,6 @@ int Input::read_data_file(Data_map* series, std::string inputname, bool optional
             (*series)[varnames[n]].push_back(varvalues[n]);
     }
 
-    if (master->mpiid == 0)
-        fclose(inputfile);
-
     return 0;
 }
 
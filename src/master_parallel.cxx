@@ -23,6 +23,7 @@
 #ifdef USEMPI
 #include <mpi.h>
 #include <stdexcept>
+#include <vector>
 #include "grid.h"
 #include "defines.h"
 #include "master.h"
@@ -248,6 +249,17 @@ void Master::sum(double *var, int datasize)
     MPI_Allreduce(MPI_IN_PLACE, var, datasize, MPI_DOUBLE, MPI_SUM, commxy);
 }
 
+void Master::gather(double *sendbuf, int sendsize, double *recvbuf, int *recvsizes)
+{
+    // The sizes per process are only needed on the master, where the data is stored in the order of the processes.
+    std::vector<int> displs(nprocs, 0);
+    if (mpiid == 0)
+        for (int n=1; n<nprocs; ++n)
+            displs[n] = displs[n-1] + recvsizes[n-1];
+
+    MPI_Gatherv(sendbuf, sendsize, MPI_DOUBLE, recvbuf, recvsizes, &displs[0], MPI_DOUBLE, 0, commxy);
+}
+
 void Master::max(double *var, int datasize)
 {
     MPI_Allreduce(MPI_IN_PLACE, var, datasize, MPI_DOUBLE, MPI_MAX, commxy);
@@ -139,6 +139,12 @@ void Master::sum(double *var, int datasize)
 {
 }
 
+void Master::gather(double *sendbuf, int sendsize, double *recvbuf, int *recvsizes)
+{
+    for (int n=0; n<sendsize; ++n)
+        recvbuf[n] = sendbuf[n];
+}
+
 void Master::max(double *var, int datasize)
 {
 }
@@ -35,10 +35,12 @@
 #include "thermo.h"
 #include "boundary.h"
 #include "buffer.h"
+#include "tendency.h"
 #include "force.h"
 #include "stats.h"
 #include "cross.h"
 #include "dump.h"
+#include "column.h"
 #include "budget.h"
 
 #ifdef USECUDA
@@ -60,12 +62,16 @@ Model::Model(Master *masterin, Input *inputin)
     timeloop = 0;
     force    = 0;
     buffer   = 0;
+    tendency = 0;
 
     stats  = 0;
     cross  = 0;
     dump   = 0;
+    column = 0;
     budget = 0;
 
+    itransnext = 0;
+
     try
     {
         // Create an instance of the Grid class.
@@ -84,11 +90,13 @@ Model::Model(Master *masterin, Input *inputin)
         timeloop = new Timeloop(this, input);
         force    = new Force   (this, input);
         buffer   = new Buffer  (this, input);
+        tendency = new Tendency(this, input);
 
         // Create instances of the statistics classes. First create stats as it is required for init of derived stats.
         stats  = new Stats (this, input);
         cross  = new Cross (this, input);
         dump   = new Dump  (this, input);
+        column = new Column(this, input);
 
         budget = Budget::factory(input, master, grid, fields, thermo, diff, advec, force, stats);
 
@@ -130,9 +138,11 @@ void Model::delete_objects()
 {
     // Delete the components in reversed order.
     delete budget;
+    delete column;
     delete dump;
     delete cross;
     delete stats;
+    delete tendency;
     delete buffer;
     delete force;
     delete pres;
@@ -170,6 +180,7 @@ void Model::init()
     stats ->init(timeloop->get_ifactor());
     cross ->init(timeloop->get_ifactor());
     dump  ->init(timeloop->get_ifactor());
+    column->init(timeloop->get_ifactor());
     budget->init();
 }
 
@@ -179,11 +190,14 @@ void Model::load()
     // First load the grid and time to make their information available.
     grid    ->load();
     timeloop->load(timeloop->get_iotime());
+    if (grid->swtrans == "1")
+        grid->load_trans(timeloop->get_iotime());
 
     // Initialize the statistics file to open the possiblity to add profiles.
     stats->create(timeloop->get_iotime());
     cross->create();
     dump ->create();
+    column->create(timeloop->get_iotime());
 
     fields->load(timeloop->get_iotime());
     fields->create_stats();
@@ -214,6 +228,8 @@ void Model::save()
     grid    ->save();
     fields  ->save(timeloop->get_iotime());
     timeloop->save(timeloop->get_iotime());
+    if (grid->swtrans == "1")
+        grid->save_trans(timeloop->get_iotime());
 }
 
 void Model::exec()
@@ -250,27 +266,53 @@ void Model::exec()
     // Set the time step.
     set_time_step();
 
+    // Find the first time at which the Galilean transformation is updated.
+    if (grid->swtrans == "1")
+    {
+        const unsigned long itrans = static_cast<unsigned long>(timeloop->get_ifactor()*grid->transtime);
+        itransnext = (timeloop->get_itime()/itrans + 1)*itrans;
+    }
+
     // Print the initial status information.
     print_status();
 
     // start the time loop
     while (true)
     {
-        // Determine the time step.
-        set_time_step();
+        // Determine the time step. If the CFL number is computed in the advection,
+        // the time step is determined directly after the advection tendency.
+        if (!advec->has_fused_cfl())
+            set_time_step();
 
-        // Calculate the advection tendency.
-        boundary->set_ghost_cells_w(Boundary::Conservation_type);
-        advec->exec();
-        boundary->set_ghost_cells_w(Boundary::Normal_type);
+        // Calculate the advection, diffusion, buoyancy and buffer tendencies in a single blocked sweep.
+        if (tendency->get_switch() == "1")
+        {
+            tendency->exec();
+
+            if (advec->has_fused_cfl())
+                set_time_step();
+
+            // Complete the thermodynamics with the operations that need the time step.
+            thermo->finish_block_sweep();
+        }
+        else
+        {
+            // Calculate the advection tendency.
+            boundary->set_ghost_cells_w(Boundary::Conservation_type);
+            advec->exec();
+            boundary->set_ghost_cells_w(Boundary::Normal_type);
 
-        // Calculate the diffusion tendency.
-        diff->exec();
+            if (advec->has_fused_cfl())
+                set_time_step();
 
-        // Calculate the thermodynamics and the buoyancy tendency.
-        thermo->exec();
-        // Calculate the tendency due to damping in the buffer layer.
-        buffer->exec();
+            // Calculate the diffusion tendency.
+            diff->exec();
+
+            // Calculate the thermodynamics and the buoyancy tendency.
+            thermo->exec();
+            // Calculate the tendency due to damping in the buffer layer.
+            buffer->exec();
+        }
 
         // Apply the large scale forcings. Keep this one always right before the pressure.
         force->exec(timeloop->get_sub_time_step());
@@ -284,8 +326,8 @@ void Model::exec()
         if (timeloop->is_stats_step())
         {
             #ifdef USECUDA
-            // Copy fields from device to host
-            if (stats->doStats() || cross->do_cross() || dump->do_dump())
+            // Copy fields from device to host, the columns need this at every sample time.
+            if (stats->doStats() || cross->do_cross() || dump->do_dump() || column->do_column())
             {
                 fields  ->backward_device();
                 boundary->backward_device();
@@ -295,30 +337,28 @@ void Model::exec()
             // Do the statistics.
             if (stats->doStats())
             {
+                // Compute all masks first, every mask sets its own bit in the mask fields.
+                stats->reset_masks();
+
                 // Always process the default mask (the full field)
-                stats->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks["default"]);
-                calc_stats("default");
+                stats->get_mask(&stats->masks["default"]);
 
                 // Work through the potential masks for the statistics.
                 for (std::vector<std::string>::const_iterator it=masklist.begin(); it!=masklist.end(); ++it)
                 {
                     if (*it == "wplus" || *it == "wmin")
-                    {
-                        fields->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks[*it]);
-                        calc_stats(*it);
-                    }
+                        fields->get_mask(&stats->masks[*it]);
                     else if (*it == "ql" || *it == "qlcore")
-                    {
-                        thermo->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks[*it]);
-                        calc_stats(*it);
-                    }
+                        thermo->get_mask(&stats->masks[*it]);
                     else if (*it == "patch_high" || *it == "patch_low")
-                    {
-                        boundary->get_mask(fields->atmp["tmp3"], fields->atmp["tmp4"], &stats->masks[*it]);
-                        calc_stats(*it);
-                    }
+                        boundary->get_mask(&stats->masks[*it]);
                 }
 
+                stats->count_masks();
+
+                // Calculate the statistics of all masks in a single pass over the fields.
+                calc_stats();
+
                 // Store the stats data.
                 stats->exec(timeloop->get_iteration(), timeloop->get_time(), timeloop->get_itime());
             }
@@ -337,6 +377,10 @@ void Model::exec()
                 fields->exec_dump();
                 thermo->exec_dump();
             }
+
+            // Add the columns to the buffer, which is written to disk once it is full.
+            if (column->do_column())
+                column->exec(timeloop->get_iteration(), timeloop->get_time());
         }
 
         // Exit the simulation when the runtime has been hit.
@@ -349,9 +393,15 @@ void Model::exec()
             // Integrate in time.
             timeloop->exec();
 
+            // Solve the implicit part of the diffusion as a split step on the integrated fields.
+            diff->exec_implicit();
+
             // Increase the time with the time step.
             timeloop->step_time();
 
+            // Update the Galilean transformation velocity before the fields are saved.
+            update_trans();
+
             // Save the data for restarts.
             if (timeloop->do_save())
             {
@@ -363,6 +413,8 @@ void Model::exec()
                 // Save data to disk.
                 timeloop->save(timeloop->get_iotime());
                 fields  ->save(timeloop->get_iotime());
+                if (grid->swtrans == "1")
+                    grid->save_trans(timeloop->get_iotime());
             }
         }
 
@@ -379,6 +431,8 @@ void Model::exec()
             // Load the data from disk.
             timeloop->load(timeloop->get_iotime());
             fields  ->load(timeloop->get_iotime());
+            if (grid->swtrans == "1")
+                grid->load_trans(timeloop->get_iotime());
         }
 
         // Update the time dependent parameters.
@@ -399,6 +453,9 @@ void Model::exec()
 
     } // End time loop.
 
+    // Write the columns that remain in the buffer.
+    column->save();
+
     #ifdef USECUDA
     // At the end of the run, copy the data back from the GPU.
     fields  ->backward_device();
@@ -406,6 +463,28 @@ void Model::exec()
     #endif
 }
 
+void Model::update_trans()
+{
+    // Only update the transformation after a full time step, when the tendencies have been used.
+    if (grid->swtrans != "1" || timeloop->in_substep() || timeloop->get_itime() < itransnext)
+        return;
+
+    const unsigned long itrans = static_cast<unsigned long>(timeloop->get_ifactor()*grid->transtime);
+    itransnext = (timeloop->get_itime()/itrans + 1)*itrans;
+
+    // The mean wind in the layer relative to the grid is the change of the transformation velocity.
+    double du, dv;
+    fields->get_layer_mean_velocity(&du, &dv, grid->transzmin, grid->transzmax);
+
+    // Subtract the change from all velocities that are defined relative to the grid, which leaves the
+    // physical solution unchanged. The forcings that depend on the transformation read it from the grid.
+    fields->shift_velocity(du, dv);
+    buffer->shift_velocity(du, dv);
+
+    grid->utrans += du;
+    grid->vtrans += dv;
+}
+
 void Model::set_time_step()
 {
     // Only set the time step if the model is not in a substep.
@@ -414,24 +493,48 @@ void Model::set_time_step()
 
     // Retrieve the maximum allowed time step per class.
     timeloop->set_time_step_limit();
-    timeloop->set_time_step_limit(advec ->get_time_limit(timeloop->get_idt(), timeloop->get_dt()));
-    timeloop->set_time_step_limit(diff  ->get_time_limit(timeloop->get_idt(), timeloop->get_dt()));
+    if (advec->has_fused_cfl())
+    {
+        // Reduce the CFL number and the diffusion number in a single communication.
+        double nums[2] = {advec->get_cfl_max_local(), diff->get_dnmul_local()};
+        grid->get_max(nums, 2);
+        timeloop->set_time_step_limit(advec->get_time_limit_reduced(timeloop->get_idt(), timeloop->get_dt(), nums[0]));
+        timeloop->set_time_step_limit(diff ->get_time_limit_reduced(timeloop->get_idt(), timeloop->get_dt(), nums[1]));
+    }
+    else
+    {
+        timeloop->set_time_step_limit(advec ->get_time_limit(timeloop->get_idt(), timeloop->get_dt()));
+        timeloop->set_time_step_limit(diff  ->get_time_limit(timeloop->get_idt(), timeloop->get_dt()));
+    }
     timeloop->set_time_step_limit(thermo->get_time_limit(timeloop->get_idt(), timeloop->get_dt()));
     timeloop->set_time_step_limit(stats ->get_time_limit(timeloop->get_itime()));
     timeloop->set_time_step_limit(cross ->get_time_limit(timeloop->get_itime()));
     timeloop->set_time_step_limit(dump  ->get_time_limit(timeloop->get_itime()));
+    timeloop->set_time_step_limit(column->get_time_limit(timeloop->get_itime()));
 
     // Set the time step.
     timeloop->set_time_step();
 }
 
 // Calculate the statistics for all classes that have a statistics function.
-void Model::calc_stats(std::string maskname)
+void Model::calc_stats()
 {
-    fields  ->exec_stats(&stats->masks[maskname]);
-    thermo  ->exec_stats(&stats->masks[maskname]);
-    budget  ->exec_stats(&stats->masks[maskname]);
-    boundary->exec_stats(&stats->masks[maskname]);
+    fields  ->exec_stats();
+    thermo  ->exec_stats();
+
+    // The budgets are not conditionally sampled, thus they are only calculated for the default mask.
+    budget->exec_stats(&stats->masks["default"]);
+    for (Mask_map::iterator it=stats->masks.begin(); it!=stats->masks.end(); ++it)
+        if (it->first != "default")
+            budget->copy_stats(&it->second, &stats->masks["default"]);
+
+    boundary->exec_stats();
+
+    // Add the sample to the histograms, all masks are processed at once.
+    stats->calc_hists();
+
+    // Add the sample to the horizontal autocorrelations of the full domain.
+    stats->calc_corrs();
 }
 
 // Print the status information to the .out file.
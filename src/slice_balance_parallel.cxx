@@ -0,0 +1,268 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2017 Chiel van Heerwaarden
+ * Copyright (c) 2011-2017 Thijs Heus
+ * Copyright (c) 2014-2017 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef USEMPI
+#include <mpi.h>
+#include <vector>
+#include "master.h"
+#include "grid.h"
+#include "slice_balance.h"
+
+Slice_balance::Slice_balance(Master* masterin, Grid* gridin)
+{
+    master = masterin;
+    grid   = gridin;
+
+    cost      = 0;
+    exported  = 0;
+    sendbuf   = 0;
+    retbuf    = 0;
+    importbuf = 0;
+
+    commnode = MPI_COMM_NULL;
+}
+
+Slice_balance::~Slice_balance()
+{
+    delete[] cost;
+    delete[] exported;
+    delete[] sendbuf;
+    delete[] retbuf;
+    delete[] importbuf;
+
+    if (commnode != MPI_COMM_NULL)
+        MPI_Comm_free(&commnode);
+}
+
+void Slice_balance::init(const int ninin, const int noutin)
+{
+    nin    = ninin;
+    nout   = noutin;
+    nslice = grid->icells*grid->kcells;
+
+    cost     = new double[grid->jmax];
+    exported = new bool[grid->jmax];
+
+    for (int j=0; j<grid->jmax; ++j)
+    {
+        cost[j]     = 0.;
+        exported[j] = false;
+    }
+
+    // Slices are only exchanged within a node, where the communication is cheap.
+    MPI_Comm_split_type(master->commxy, MPI_COMM_TYPE_SHARED, master->mpiid, MPI_INFO_NULL, &commnode);
+    MPI_Comm_rank(commnode, &nodeid);
+    MPI_Comm_size(commnode, &nnode);
+}
+
+void Slice_balance::add_cost(const int j, const double c)
+{
+    cost[j-grid->jstart] += c;
+}
+
+void Slice_balance::update_plan()
+{
+    const int jmax = grid->jmax;
+
+    // Gather the cost of all slices of the node.
+    std::vector<double> allcost(nnode*jmax);
+    MPI_Allgather(cost, jmax, MPI_DOUBLE, &allcost[0], jmax, MPI_DOUBLE, commnode);
+
+    std::vector<double> load(nnode, 0.);
+    for (int n=0; n<nnode; ++n)
+        for (int j=0; j<jmax; ++j)
+            load[n] += allcost[n*jmax+j];
+
+    // Move slices from the process with the highest load to the one with the lowest load, as long as
+    // this reduces the highest load of the two. Every process makes the same plan from the same data.
+    std::vector<int> dest(nnode*jmax, -1);
+    while (true)
+    {
+        int nmax = 0;
+        int nmin = 0;
+        for (int n=1; n<nnode; ++n)
+        {
+            if (load[n] > load[nmax])
+                nmax = n;
+            if (load[n] < load[nmin])
+                nmin = n;
+        }
+
+        const double gap = load[nmax] - load[nmin];
+
+        int jbest = -1;
+        double cbest = 0.;
+        for (int j=0; j<jmax; ++j)
+        {
+            const double c = allcost[nmax*jmax+j];
+            if (dest[nmax*jmax+j] == -1 && c > cbest && c < gap)
+            {
+                jbest = j;
+                cbest = c;
+            }
+        }
+
+        if (jbest == -1)
+            break;
+
+        dest[nmax*jmax+jbest] = nmin;
+        load[nmax] -= cbest;
+        load[nmin] += cbest;
+    }
+
+    // Store the slices that this process exports and imports.
+    export_j.clear();
+    export_dest.clear();
+    import_j.clear();
+    import_src.clear();
+
+    for (int j=0; j<jmax; ++j)
+    {
+        exported[j] = (dest[nodeid*jmax+j] != -1);
+        if (exported[j])
+        {
+            export_j.push_back(j+grid->jstart);
+            export_dest.push_back(dest[nodeid*jmax+j]);
+        }
+    }
+
+    for (int n=0; n<nnode; ++n)
+        for (int j=0; j<jmax; ++j)
+            if (dest[n*jmax+j] == nodeid)
+            {
+                import_j.push_back(j+grid->jstart);
+                import_src.push_back(n);
+            }
+
+    // Start measuring the cost of the new distribution.
+    for (int j=0; j<jmax; ++j)
+        cost[j] = 0.;
+
+    delete[] sendbuf;
+    delete[] retbuf;
+    delete[] importbuf;
+
+    sendbuf   = new double[export_j.size()*(1+nin *nslice)];
+    retbuf    = new double[export_j.size()*(1+nout*nslice)];
+    importbuf = new double[import_j.size()*(1+nin *nslice)];
+
+    sendreqs  .resize(export_j.size());
+    resultreqs.resize(export_j.size());
+    importreqs.resize(import_j.size());
+    returnreqs.resize(import_j.size());
+}
+
+bool Slice_balance::is_exported(const int j)
+{
+    return exported[j-grid->jstart];
+}
+
+int Slice_balance::get_nimported()
+{
+    return import_j.size();
+}
+
+double* Slice_balance::get_imported_field(const int n, const int f)
+{
+    return &importbuf[n*(1+nin*nslice) + 1 + f*nslice];
+}
+
+void Slice_balance::set_imported_cost(const int n, const double c)
+{
+    importbuf[n*(1+nin*nslice)] = c;
+}
+
+void Slice_balance::send_slices(double* const* fields)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    // The first value of a block is reserved for the cost, so that it is returned with the results.
+    const int nblock  = 1 + nin *nslice;
+    const int nresult = 1 + nout*nslice;
+
+    // The results use tags that cannot be used by the slices that are sent.
+    const int tagoffset = grid->jcells;
+
+    for (int n=0; n<static_cast<int>(import_j.size()); ++n)
+        MPI_Irecv(&importbuf[n*nblock], nblock, MPI_DOUBLE, import_src[n], import_j[n], commnode, &importreqs[n]);
+
+    for (int e=0; e<static_cast<int>(export_j.size()); ++e)
+    {
+        const int j = export_j[e];
+        double* block = &sendbuf[e*nblock];
+
+        block[0] = 0.;
+        for (int f=0; f<nin; ++f)
+            for (int k=0; k<grid->kcells; ++k)
+                for (int i=0; i<grid->icells; ++i)
+                    block[1 + f*nslice + i + k*jj] = fields[f][i + j*jj + k*kk];
+
+        MPI_Irecv(&retbuf[e*nresult], nresult, MPI_DOUBLE, export_dest[e], j+tagoffset, commnode, &resultreqs[e]);
+        MPI_Isend(block, nblock, MPI_DOUBLE, export_dest[e], j, commnode, &sendreqs[e]);
+    }
+}
+
+void Slice_balance::wait_imported()
+{
+    if (!importreqs.empty())
+        MPI_Waitall(importreqs.size(), &importreqs[0], MPI_STATUSES_IGNORE);
+}
+
+void Slice_balance::return_slices()
+{
+    const int nblock  = 1 + nin *nslice;
+    const int nresult = 1 + nout*nslice;
+    const int tagoffset = grid->jcells;
+
+    for (int n=0; n<static_cast<int>(import_j.size()); ++n)
+        MPI_Isend(&importbuf[n*nblock], nresult, MPI_DOUBLE, import_src[n], import_j[n]+tagoffset, commnode, &returnreqs[n]);
+}
+
+void Slice_balance::receive_slices(double* const* fields)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+    const int nresult = 1 + nout*nslice;
+
+    if (!resultreqs.empty())
+        MPI_Waitall(resultreqs.size(), &resultreqs[0], MPI_STATUSES_IGNORE);
+
+    for (int e=0; e<static_cast<int>(export_j.size()); ++e)
+    {
+        const int j = export_j[e];
+        const double* block = &retbuf[e*nresult];
+
+        add_cost(j, block[0]);
+        for (int f=0; f<nout; ++f)
+            for (int k=0; k<grid->kcells; ++k)
+                for (int i=0; i<grid->icells; ++i)
+                    fields[f][i + j*jj + k*kk] = block[1 + f*nslice + i + k*jj];
+    }
+
+    // Release the buffers for the next exchange.
+    if (!sendreqs.empty())
+        MPI_Waitall(sendreqs.size(), &sendreqs[0], MPI_STATUSES_IGNORE);
+    if (!returnreqs.empty())
+        MPI_Waitall(returnreqs.size(), &returnreqs[0], MPI_STATUSES_IGNORE);
+}
+#endif
@@ -0,0 +1,94 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2017 Chiel van Heerwaarden
+ * Copyright (c) 2011-2017 Thijs Heus
+ * Copyright (c) 2014-2017 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef USEMPI
+#include "master.h"
+#include "grid.h"
+#include "slice_balance.h"
+
+// Without MPI there is only one process, so all slices are computed locally.
+Slice_balance::Slice_balance(Master* masterin, Grid* gridin)
+{
+    master = masterin;
+    grid   = gridin;
+
+    cost      = 0;
+    exported  = 0;
+    sendbuf   = 0;
+    retbuf    = 0;
+    importbuf = 0;
+}
+
+Slice_balance::~Slice_balance()
+{
+}
+
+void Slice_balance::init(const int ninin, const int noutin)
+{
+    nin    = ninin;
+    nout   = noutin;
+    nslice = grid->icells*grid->kcells;
+}
+
+void Slice_balance::update_plan()
+{
+}
+
+void Slice_balance::add_cost(const int j, const double c)
+{
+}
+
+void Slice_balance::set_imported_cost(const int n, const double c)
+{
+}
+
+bool Slice_balance::is_exported(const int j)
+{
+    return false;
+}
+
+int Slice_balance::get_nimported()
+{
+    return 0;
+}
+
+double* Slice_balance::get_imported_field(const int n, const int f)
+{
+    return 0;
+}
+
+void Slice_balance::send_slices(double* const* fields)
+{
+}
+
+void Slice_balance::wait_imported()
+{
+}
+
+void Slice_balance::return_slices()
+{
+}
+
+void Slice_balance::receive_slices(double* const* fields)
+{
+}
+#endif
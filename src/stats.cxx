@@ -25,6 +25,7 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <bitset>
 #include "master.h"
 #include "grid.h"
 #include "fields.h"
@@ -48,14 +49,62 @@ Stats::Stats(Model* modelin, Input* inputin)
     master = model->master;
 
     // set the pointers to zero
-    nmask  = 0;
-    nmaskh = 0;
+    mfield    = 0;
+    mfieldh   = 0;
+    mfieldbot = 0;
+
+    ncorrsamples = 0;
 
     int nerror = 0;
     nerror += inputin->get_item(&swstats, "stats", "swstats", "", "0");
 
     if (swstats == "1")
-        nerror += inputin->get_item(&sampletime, "stats", "sampletime", "");
+    {
+        nerror += inputin->get_item(&sampletime , "stats", "sampletime" , "");
+        nerror += inputin->get_item(&averagetime, "stats", "averagetime", "", sampletime);
+        nerror += inputin->get_list(&histlist   , "stats", "histlist"   , "");
+        nerror += inputin->get_list(&corrlist   , "stats", "corrlist"   , "");
+    }
+
+    // Read the bins of all variables of the histograms, a joint histogram is given as "var1:var2".
+    for (std::vector<std::string>::const_iterator it=histlist.begin(); it!=histlist.end(); ++it)
+    {
+        std::vector<std::string> vars;
+        std::stringstream ss(*it);
+        std::string var;
+        while (std::getline(ss, var, ':'))
+            vars.push_back(var);
+
+        if (vars.size() < 1 || vars.size() > 2)
+        {
+            ++nerror;
+            master->print_error("\"%s\" in [stats][histlist] is not a histogram of one or two variables\n", it->c_str());
+            continue;
+        }
+
+        for (std::vector<std::string>::const_iterator itv=vars.begin(); itv!=vars.end(); ++itv)
+        {
+            if (histbins.count(*itv))
+                continue;
+
+            Hist_bins* b = &histbins[*itv];
+            nerror += inputin->get_item(&b->min  , "stats", "histmin"  , *itv);
+            nerror += inputin->get_item(&b->max  , "stats", "histmax"  , *itv);
+            nerror += inputin->get_item(&b->nbins, "stats", "histnbins", *itv, 20);
+            nerror += inputin->get_item(&b->type , "stats", "histtype" , *itv, "value");
+
+            if (b->max <= b->min || b->nbins < 1)
+            {
+                ++nerror;
+                master->print_error("illegal bins for histogram variable %s\n", itv->c_str());
+            }
+            if (!(b->type == "value" || b->type == "deviation"))
+            {
+                ++nerror;
+                master->print_error("\"%s\" is an illegal value for histtype[%s]\n", b->type.c_str(), itv->c_str());
+            }
+        }
+    }
 
     if (!(swstats == "0" || swstats == "1"))
     {
@@ -69,15 +118,37 @@ Stats::Stats(Model* modelin, Input* inputin)
 
 Stats::~Stats()
 {
-    delete[] nmask;
-    delete[] nmaskh;
+    delete[] mfield;
+    delete[] mfieldh;
+    delete[] mfieldbot;
 
     // delete the profiles
     for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
     {
         delete it->second.dataFile;
+        delete[] it->second.nmask;
+        delete[] it->second.nmaskh;
         for (Prof_map::const_iterator it2=it->second.profs.begin(); it2!=it->second.profs.end(); ++it2)
+        {
+            delete[] it2->second.data;
+            delete[] it2->second.sum;
+            delete[] it2->second.nsamples;
+        }
+        for (Prof_map::const_iterator it2=it->second.tmp_profs.begin(); it2!=it->second.tmp_profs.end(); ++it2)
+            delete[] it2->second.data;
+        for (Hist_map::const_iterator it2=it->second.hists.begin(); it2!=it->second.hists.end(); ++it2)
+        {
             delete[] it2->second.data;
+            delete[] it2->second.nsum;
+        }
+    }
+
+    for (std::map<std::string, Corr_var>::const_iterator it=corrs.begin(); it!=corrs.end(); ++it)
+    {
+        delete[] it->second.covx;
+        delete[] it->second.covy;
+        delete[] it->second.lx;
+        delete[] it->second.ly;
     }
 }
 
@@ -93,8 +164,46 @@ void Stats::init(double ifactor)
 
     isampletime = (unsigned long)(ifactor * sampletime);
 
-    nmask  = new int[grid->kcells];
-    nmaskh = new int[grid->kcells];
+    // The samples between two outputs are averaged in case the averaging time exceeds the sampling time.
+    doaverage = false;
+    if (swstats == "1")
+    {
+        iaveragetime = (unsigned long)(ifactor * averagetime);
+        if (iaveragetime % isampletime != 0)
+        {
+            master->print_error("averagetime = %f is not a multiple of sampletime = %f\n", averagetime, sampletime);
+            throw 1;
+        }
+        doaverage = (iaveragetime != isampletime);
+    }
+
+    // The masks are packed with one bit per grid cell, such that all masks can
+    // be computed before the statistics are calculated in a single pass.
+    const int nmasks = masks.size();
+    mwords  = (grid->icells+63)/64;
+    mjcells = grid->jcells;
+    msize   = mwords*grid->jcells*grid->kcells;
+
+    if (swstats == "1")
+    {
+        mfield    = new uint64_t[nmasks*msize];
+        mfieldh   = new uint64_t[nmasks*msize];
+        mfieldbot = new uint64_t[nmasks*mwords*grid->jcells];
+    }
+
+    int n = 0;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it, ++n)
+    {
+        it->second.nmask  = new int[grid->kcells];
+        it->second.nmaskh = new int[grid->kcells];
+
+        if (swstats == "1")
+        {
+            it->second.mfield    = &mfield   [n*msize];
+            it->second.mfieldh   = &mfieldh  [n*msize];
+            it->second.mfieldbot = &mfieldbot[n*mwords*grid->jcells];
+        }
+    }
 
     // set the number of stats to zero
     nstats = 0;
@@ -177,6 +286,9 @@ void Stats::create(int n)
     // for each mask add the area as a variable
     add_prof("area" , "Fractional area contained in mask", "-", "z" );
     add_prof("areah", "Fractional area contained in mask", "-", "zh");
+
+    add_hists();
+    add_corrs();
 }
 
 unsigned long Stats::get_time_limit(unsigned long itime)
@@ -210,6 +322,21 @@ void Stats::exec(int iteration, double time, unsigned long itime)
     if (itime % isampletime != 0)
         return;
 
+    // add the sample to the time average and only write the average at the end of the averaging period
+    if (doaverage)
+    {
+        accumulate_stats();
+
+        if (itime % iaveragetime != 0)
+            return;
+
+        average_stats();
+    }
+
+    // The histograms are only reduced over the processes at output time.
+    reduce_hists();
+    reduce_corrs();
+
     // write message in case stats is triggered
     master->print_message("Saving stats for time %f\n", model->timeloop->get_time());
 
@@ -238,6 +365,38 @@ void Stats::exec(int iteration, double time, unsigned long itime)
             for (Time_series_map::const_iterator it=m->tseries.begin(); it!=m->tseries.end(); ++it)
                 m->tseries[it->first].ncvar.putVar(time_index, &m->tseries[it->first].data);
 
+            for (Hist_map::iterator it=m->hists.begin(); it!=m->hists.end(); ++it)
+            {
+                std::vector<size_t> hist_index = {static_cast<size_t>(nstats), 0};
+                std::vector<size_t> hist_size  = {1, static_cast<size_t>(grid->kmax)};
+                for (size_t n=0; n<it->second.vars.size(); ++n)
+                {
+                    hist_index.push_back(0);
+                    hist_size .push_back(histbins[it->second.vars[n]].nbins);
+                }
+                it->second.ncvar.putVar(hist_index, hist_size, &it->second.data[grid->kstart*it->second.nbins]);
+            }
+
+            // The autocorrelations are only computed for the full domain.
+            if (m->name == "default")
+            {
+                const int nrx = grid->itot/2+1;
+                const int nry = grid->jtot/2+1;
+
+                const std::vector<size_t> time_height_r_index = {static_cast<size_t>(nstats), 0, 0};
+                const std::vector<size_t> time_height_rx_size = {1, static_cast<size_t>(grid->kmax), static_cast<size_t>(nrx)};
+                const std::vector<size_t> time_height_ry_size = {1, static_cast<size_t>(grid->kmax), static_cast<size_t>(nry)};
+                const std::vector<size_t> time_height_size    = {1, static_cast<size_t>(grid->kmax)};
+
+                for (std::map<std::string, Corr_var>::iterator it=corrs.begin(); it!=corrs.end(); ++it)
+                {
+                    it->second.ncvarx .putVar(time_height_r_index, time_height_rx_size, &it->second.covx[grid->kstart*nrx]);
+                    it->second.ncvary .putVar(time_height_r_index, time_height_ry_size, &it->second.covy[grid->kstart*nry]);
+                    it->second.ncvarlx.putVar(time_height_index, time_height_size, &it->second.lx[grid->kstart]);
+                    it->second.ncvarly.putVar(time_height_index, time_height_size, &it->second.ly[grid->kstart]);
+                }
+            }
+
             // Synchronize the NetCDF file
             // BvS: only the last netCDF4-c++ includes the NcFile->sync()
             //      for now use sync() from the netCDF-C library to support older NetCDF4-c++ versions
@@ -246,6 +405,26 @@ void Stats::exec(int iteration, double time, unsigned long itime)
         }
     }
 
+    // Start the histograms of the next output.
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
+        for (Hist_map::iterator it2=it->second.hists.begin(); it2!=it->second.hists.end(); ++it2)
+        {
+            Hist_var* h = &it2->second;
+            for (int n=0; n<grid->kcells*h->nbins; ++n)
+                h->data[n] = 0.;
+            for (int k=0; k<grid->kcells; ++k)
+                h->nsum[k] = 0.;
+        }
+
+    for (std::map<std::string, Corr_var>::iterator it=corrs.begin(); it!=corrs.end(); ++it)
+    {
+        for (int n=0; n<grid->kcells*(grid->itot/2+1); ++n)
+            it->second.covx[n] = 0.;
+        for (int n=0; n<grid->kcells*(grid->jtot/2+1); ++n)
+            it->second.covy[n] = 0.;
+    }
+    ncorrsamples = 0;
+
     ++nstats;
 }
 
@@ -258,6 +437,11 @@ void Stats::add_mask(const std::string maskname)
 {
     masks[maskname].name = maskname;
     masks[maskname].dataFile = 0;
+    masks[maskname].nmask  = 0;
+    masks[maskname].nmaskh = 0;
+    masks[maskname].mfield    = 0;
+    masks[maskname].mfieldh   = 0;
+    masks[maskname].mfieldbot = 0;
 }
 
 void Stats::add_prof(std::string name, std::string longname, std::string unit, std::string zloc)
@@ -294,6 +478,38 @@ void Stats::add_prof(std::string name, std::string longname, std::string unit, s
         m->profs[name].data = new double[grid->kcells];
         for (int k=0; k<grid->kcells; ++k)
             m->profs[name].data[k] = 0.;
+
+        m->profs[name].sum      = 0;
+        m->profs[name].nsamples = 0;
+        m->profs[name].partial  = false;
+
+        if (doaverage)
+        {
+            m->profs[name].sum      = new double[grid->kcells];
+            m->profs[name].nsamples = new int[grid->kcells];
+            for (int k=0; k<grid->kcells; ++k)
+            {
+                m->profs[name].sum     [k] = 0.;
+                m->profs[name].nsamples[k] = 0;
+            }
+        }
+    }
+}
+
+void Stats::add_tmp_prof(std::string name)
+{
+    // add a profile that is not saved, but used in the computation of other statistics
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
+    {
+        Mask* m = &it->second;
+
+        m->tmp_profs[name].data = new double[grid->kcells];
+        for (int k=0; k<grid->kcells; ++k)
+            m->tmp_profs[name].data[k] = 0.;
+
+        m->tmp_profs[name].sum      = 0;
+        m->tmp_profs[name].nsamples = 0;
+        m->tmp_profs[name].partial  = false;
     }
 }
 
@@ -350,297 +566,1243 @@ void Stats::add_time_series(std::string name, std::string longname, std::string
         }
 
         // Initialize at zero
-        m->tseries[name].data = 0.;
+        m->tseries[name].data     = 0.;
+        m->tseries[name].sum      = 0.;
+        m->tseries[name].nsamples = 0;
+        m->tseries[name].partial  = false;
     }
 }
 
-void Stats::get_mask(Field3d* mfield, Field3d* mfieldh, Mask* m)
-{
-    calc_mask(mfield->data, mfieldh->data, mfieldh->databot,
-              nmask, nmaskh, &nmaskbot);
-}
 
-// COMPUTATIONAL KERNELS BELOW
-void Stats::calc_mask(double* restrict mask, double* restrict maskh, double* restrict maskbot,
-                      int* restrict nmask, int* restrict nmaskh, int* restrict nmaskbot)
+void Stats::reset_masks()
 {
-    int ijtot = grid->itot*grid->jtot;
-
-    // set all the mask values to 1
-    for (int n=0; n<grid->ncells; ++n)
-        mask[n] = 1.;
+    // clear the bits of all masks
+    const int nmasks = masks.size();
 
-    for (int n=0; n<grid->ncells; ++n)
-        maskh[n] = 1.;
-
-    for (int n=0; n<grid->ijcells; ++n)
-        maskbot[n] = 1.;
-
-    for (int k=0; k<grid->kcells; ++k)
+    for (int n=0; n<nmasks*msize; ++n)
     {
-        nmask [k] = ijtot;
-        nmaskh[k] = ijtot;
+        mfield [n] = 0;
+        mfieldh[n] = 0;
     }
-    *nmaskbot = ijtot;
+
+    for (int n=0; n<nmasks*mwords*grid->jcells; ++n)
+        mfieldbot[n] = 0;
 }
 
-void Stats::calc_area(double* restrict area, const int loc[3], int* restrict nmask)
+void Stats::get_mask(Mask* m)
 {
-    const int ijtot = grid->itot*grid->jtot;
+    calc_mask(m->mfield, m->mfieldh, m->mfieldbot);
+}
 
-    for (int k=grid->kstart; k<grid->kend+loc[2]; k++)
+namespace
+{
+    // Count the bits of the cells istart to iend-1 in a row of a packed mask.
+    int count_row(const uint64_t* const restrict row, const int istart, const int iend)
     {
-        if (nmask[k] > nthres)
-            area[k] = (double)(nmask[k]) / (double)ijtot;
-        else
-            area[k] = 0.;
+        int count = 0;
+        for (int w=istart/64; w<=(iend-1)/64; ++w)
+        {
+            const int ilo = std::max(istart-64*w, 0);
+            const int ihi = std::min(iend  -64*w, 64);
+
+            uint64_t range = (ihi == 64) ? ~(uint64_t)0 : ((uint64_t)1 << ihi) - 1;
+            range &= ~(((uint64_t)1 << ilo) - 1);
+
+            count += std::bitset<64>(row[w] & range).count();
+        }
+        return count;
     }
 }
 
-void Stats::calc_mean(double* const restrict prof, const double* const restrict data,
-                      const double offset, const int loc[3],
-                      const double* const restrict mask, const int * const restrict nmask)
+void Stats::count_masks()
 {
-    const int jj = grid->icells;
-    const int kk = grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
+
+    // Count the cells of all masks, the full levels, half levels and surface
+    // are stored one after another to sum them in a single reduction.
+    std::vector<int> count((2*kcells+1)*nmasks, 0);
+    int* const restrict nmask    = &count[0];
+    int* const restrict nmaskh   = &count[kcells*nmasks];
+    int* const restrict nmaskbot = &count[2*kcells*nmasks];
 
-    for (int k=1; k<grid->kcells; k++)
+    for (int n=0; n<nmasks; ++n)
     {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+        for (int k=0; k<kcells; ++k)
+            for (int j=grid->jstart; j<grid->jend; ++j)
             {
-                const int ijk  = i + j*jj + k*kk;
-                prof[k] += mask[ijk]*(data[ijk] + offset);
+                const int row = n*msize + (j + k*mjcells)*mwords;
+                nmask [n*kcells+k] += count_row(&mfield [row], grid->istart, grid->iend);
+                nmaskh[n*kcells+k] += count_row(&mfieldh[row], grid->istart, grid->iend);
             }
+
+        for (int j=grid->jstart; j<grid->jend; ++j)
+            nmaskbot[n] += count_row(&mfieldbot[(n*mjcells + j)*mwords], grid->istart, grid->iend);
     }
 
-    master->sum(prof, grid->kcells);
+    master->sum(&count[0], count.size());
 
-    for (int k=1; k<grid->kcells; k++)
+    int n = 0;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it, ++n)
     {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
+        Mask* m = &it->second;
+
+        for (int k=0; k<kcells; ++k)
+        {
+            m->nmask [k] = nmask [n*kcells+k];
+            m->nmaskh[k] = nmaskh[n*kcells+k];
+        }
+        m->nmaskbot = nmaskbot[n];
     }
 }
 
-void Stats::calc_mean2d(double* const restrict mean, const double* const restrict data,
-                        const double offset,
-                        const double* const restrict mask, const int * const restrict nmask)
+std::vector<Prof_var*> Stats::get_prof_vars(std::string name)
 {
-    const int jj = grid->icells;
-
-    if (*nmask > nthres)
+    // collect the profile of each mask, in the order of the masks
+    std::vector<Prof_var*> profs;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
     {
-        *mean = 0.;
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ij = i + j*jj;
-                *mean += mask[ij]*(data[ij] + offset);
-            }
-        master->sum(mean,1);
-        *mean /= (double)*nmask;
+        Mask* m = &it->second;
+        if (m->tmp_profs.count(name))
+            profs.push_back(&m->tmp_profs[name]);
+        else
+            profs.push_back(&m->profs[name]);
     }
-    else
-        *mean = NC_FILL_DOUBLE;
+
+    return profs;
 }
 
-void Stats::calc_sorted_prof(double* restrict data, double* restrict bin, double* restrict prof)
+std::vector<double*> Stats::get_profs(std::string name)
 {
-    const int jj = grid->icells;
-    const int kk = grid->ijcells;
-    const int kstart = grid->kstart;
-    const int kend = grid->kend;
+    // the profiles are used in the calculation of other statistics, thus they need to be complete
+    std::vector<Prof_var*> vars = get_prof_vars(name);
+    reduce_profs(vars);
 
-    double minval =  Constants::dhuge;
-    double maxval = -Constants::dhuge;
+    std::vector<double*> profs;
+    for (size_t n=0; n<vars.size(); ++n)
+        profs.push_back(vars[n]->data);
 
-    // first, get min and max
-    for (int k=grid->kstart; k<grid->kend; ++k)
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                if (data[ijk] < minval)
-                    minval = data[ijk];
-                if (data[ijk] > maxval)
-                    maxval = data[ijk];
-            }
+    return profs;
+}
 
-    master->min(&minval, 1);
-    master->max(&maxval, 1);
+void Stats::sum_profs(std::vector<double>& sum, std::string name, const bool half)
+{
+    sum_profs(sum, std::vector<std::string>(1, name), half);
+}
 
-    // make sure that the max ends up in the last bin (introduce 1E-9 error)
-    maxval *= (1.+Constants::dsmall);
+void Stats::sum_profs(std::vector<double>& sum, const std::vector<std::string>& names, const bool half)
+{
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
 
-    const double range = maxval-minval;
+    // Sum the profiles of all masks in a single reduction. In case the samples are averaged in time,
+    // the reduction is postponed, and each process stores its contribution to the normalized profile.
+    if (!doaverage)
+        master->sum(&sum[0], sum.size());
 
-    // In case the field is entirely uniform, dbin becomes zero. In that case we set the profile to the minval.
-    if (range < 1.e-16)
+    for (size_t s=0; s<names.size(); ++s)
     {
-        for (int k=grid->kstart; k<grid->kend; ++k)
-            prof[k] = minval;
+        std::vector<Prof_var*> profs = get_prof_vars(names[s]);
+
+        int n = 0;
+        for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it, ++n)
+        {
+            const int* const restrict nmask = half ? it->second.nmaskh : it->second.nmask;
+            const double* const restrict profsum = &sum[(s*nmasks+n)*kcells];
+            double* const restrict prof = profs[n]->data;
+
+            for (int k=1; k<kcells; k++)
+            {
+                if (nmask[k] > nthres)
+                    prof[k] = profsum[k] / (double)(nmask[k]);
+                else
+                    prof[k] = NC_FILL_DOUBLE;
+            }
+
+            profs[n]->partial = doaverage;
+        }
     }
-    else
-    {
-        // create bins, equal to the number of grid cells per proc
-        // make sure that bins is not larger than the memory of one 3d field
-        const int bins = grid->nmax;
+}
 
-        // calculate bin width, subtract one to make the minimum and maximum
-        // are in the middle of the bin range and add half a bin size on both sides
-        // |----x----|----x----|----x----|
-        const double dbin = range / (double)(bins-1);
+void Stats::reduce_profs(std::vector<Prof_var*>& profs)
+{
+    if (profs.empty() || !profs[0]->partial)
+        return;
 
-        minval -= 0.5*dbin;
-        maxval += 0.5*dbin;
+    const int kcells = grid->kcells;
+    const int nprofs = profs.size();
 
-        // set the bin array to zero
-        for (int n=0; n<bins; ++n)
-            bin[n] = 0;
+    // The undefined levels are the same on all processes, exclude them from the sum.
+    std::vector<double> sum(nprofs*kcells);
+    for (int n=0; n<nprofs; ++n)
+        for (int k=0; k<kcells; ++k)
+            sum[n*kcells+k] = (profs[n]->data[k] == NC_FILL_DOUBLE) ? 0. : profs[n]->data[k];
 
-        // calculate the division factor of one equivalent height unit
-        // (the total volume saved is itot*jtot*zsize)
-        const double nslice = (double)(grid->itot*grid->jtot);
+    master->sum(&sum[0], sum.size());
 
-        // check in which bin each value falls and increment the bin count
-        for (int k=grid->kstart; k<grid->kend; ++k)
+    for (int n=0; n<nprofs; ++n)
+    {
+        for (int k=0; k<kcells; ++k)
+            if (profs[n]->data[k] != NC_FILL_DOUBLE)
+                profs[n]->data[k] = sum[n*kcells+k];
+
+        profs[n]->partial = false;
+    }
+}
+
+void Stats::accumulate_stats()
+{
+    const int kcells = grid->kcells;
+
+    // Add the sample to the time averages. The contributions of the processes are summed when
+    // the average is written, complete data is thus only added by the master process.
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
+    {
+        Mask* m = &it->second;
+
+        for (Prof_map::iterator it2=m->profs.begin(); it2!=m->profs.end(); ++it2)
         {
-            const double dzslice = grid->dz[k] / nslice;
-            for (int j=grid->jstart; j<grid->jend; ++j)
-                // do not add a ivdep pragma here, because multiple instances could write the same bin[index]
-                for (int i=grid->istart; i<grid->iend; ++i)
+            Prof_var* p = &it2->second;
+            const bool add = p->partial || master->mpiid == 0;
+
+            for (int k=0; k<kcells; ++k)
+                if (p->data[k] != NC_FILL_DOUBLE)
                 {
-                    const int ijk = i + j*jj + k*kk;
-                    const int index = (int)((data[ijk] - minval) / dbin);
-                    bin[index] += dzslice;
+                    if (add)
+                        p->sum[k] += p->data[k];
+                    ++p->nsamples[k];
                 }
-        }
-
-        // get the bin count
-        master->sum(bin, bins);
 
-        // set the starting values of the loop
-        int index = 0;
-        double zbin = 0.5*bin[index];
-        double profval = minval + 0.5*dbin;
+            p->partial = false;
+        }
 
-        for (int k=grid->kstart; k<grid->kend; ++k)
+        for (Time_series_map::iterator it2=m->tseries.begin(); it2!=m->tseries.end(); ++it2)
         {
-            // Integrate the profile up to the bin count.
-            // Escape the while loop when the integrated profile
-            // exceeds the next grid point.
-            while (zbin < grid->z[k])
-            {
-                zbin += 0.5*(bin[index]+bin[index+1]);
-                profval += dbin;
-                ++index;
-            }
+            Time_series_var* t = &it2->second;
 
-            // In case the first bin is larger than the grid spacing, which can happen
-            // in the inital phase of an MPI run, make sure that no out-of-bounds reads
-            // happen.
-            if (index == 0)
-                prof[k] = profval;
-            else
+            if (t->data != NC_FILL_DOUBLE)
             {
-                const double dzfrac = (zbin-grid->z[k]) / (0.5*(bin[index-1]+bin[index]));
-                prof[k] = profval - dzfrac*dbin;
+                if (t->partial || master->mpiid == 0)
+                    t->sum += t->data;
+                ++t->nsamples;
             }
+
+            t->partial = false;
         }
     }
+}
 
-    // now calculate the ghost cells
-    // \TODO this might not be accurate enough, extrapolate properly
-    double profbot = minval;
-    double proftop = maxval;
+void Stats::average_stats()
+{
+    const int kcells = grid->kcells;
 
-    if (grid->swspatialorder == "2")
+    // Sum the time averages of all statistics in a single reduction.
+    std::vector<double> sum;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
     {
-        prof[kstart-1] = 2.*profbot - prof[kstart];
-        prof[kend]     = 2.*proftop - prof[kend-1];
+        Mask* m = &it->second;
+        for (Prof_map::iterator it2=m->profs.begin(); it2!=m->profs.end(); ++it2)
+            sum.insert(sum.end(), it2->second.sum, it2->second.sum+kcells);
+        for (Time_series_map::iterator it2=m->tseries.begin(); it2!=m->tseries.end(); ++it2)
+            sum.push_back(it2->second.sum);
     }
-    else if (grid->swspatialorder == "4")
+
+    master->sum(&sum[0], sum.size());
+
+    int i = 0;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
     {
-        prof[kstart-1] = (8./3.)*profbot - 2.*prof[kstart] + (1./3.)*prof[kstart+1];
-        prof[kstart-2] = 8.*profbot      - 9.*prof[kstart] + 2.*prof[kstart+1];
-        prof[kend]     = (8./3.)*proftop - 2.*prof[kend-1] + (1./3.)*prof[kend-2];
+        Mask* m = &it->second;
+
+        for (Prof_map::iterator it2=m->profs.begin(); it2!=m->profs.end(); ++it2)
+        {
+            Prof_var* p = &it2->second;
+            for (int k=0; k<kcells; ++k, ++i)
+            {
+                if (p->nsamples[k] > 0)
+                    p->data[k] = sum[i] / (double)p->nsamples[k];
+                else
+                    p->data[k] = NC_FILL_DOUBLE;
+
+                p->sum[k] = 0.;
+                p->nsamples[k] = 0;
+            }
+        }
+
+        for (Time_series_map::iterator it2=m->tseries.begin(); it2!=m->tseries.end(); ++it2, ++i)
+        {
+            Time_series_var* t = &it2->second;
+            if (t->nsamples > 0)
+                t->data = sum[i] / (double)t->nsamples;
+            else
+                t->data = NC_FILL_DOUBLE;
+
+            t->sum = 0.;
+            t->nsamples = 0;
+        }
+    }
+}
+
+void Stats::add_hists()
+{
+    int nerror = 0;
+
+    for (std::map<std::string, Hist_bins>::const_iterator it=histbins.begin(); it!=histbins.end(); ++it)
+    {
+        #ifdef USECUDA
+        if (!fields->a.count(it->first))
+        #else
+        if (!fields->a.count(it->first) && !model->thermo->check_field_exists(it->first))
+        #endif
+        {
+            master->print_error("field %s in [stats][histlist] is illegal\n", it->first.c_str());
+            ++nerror;
+        }
+    }
+
+    if (nerror)
+        throw 1;
+
+    for (std::vector<std::string>::const_iterator it=histlist.begin(); it!=histlist.end(); ++it)
+    {
+        std::vector<std::string> vars;
+        std::stringstream ss(*it);
+        std::string var;
+        while (std::getline(ss, var, ':'))
+            vars.push_back(var);
+
+        std::string name = "hist";
+        int nbins = 1;
+        for (size_t n=0; n<vars.size(); ++n)
+        {
+            name  += "_" + vars[n];
+            nbins *= histbins[vars[n]].nbins;
+        }
+
+        for (Mask_map::iterator itm=masks.begin(); itm!=masks.end(); ++itm)
+        {
+            Mask* m = &itm->second;
+
+            if (master->mpiid == 0)
+            {
+                std::vector<NcDim> dim_vector = {m->t_dim, m->z_dim};
+
+                // Add the bin centers of each variable once to the file.
+                for (size_t n=0; n<vars.size(); ++n)
+                {
+                    const Hist_bins* b = &histbins[vars[n]];
+                    const std::string binname = "bins_" + vars[n];
+
+                    if (!m->bin_dims.count(vars[n]))
+                    {
+                        m->bin_dims[vars[n]] = m->dataFile->addDim(binname, b->nbins);
+
+                        NcVar bin_var = m->dataFile->addVar(binname, ncDouble, m->bin_dims[vars[n]]);
+                        bin_var.putAtt("long_name", b->type == "deviation" ? "Bin center of the deviation from the mean of " + vars[n]
+                                                                           : "Bin center of " + vars[n]);
+
+                        std::vector<double> centers(b->nbins);
+                        const double dbin = (b->max - b->min) / b->nbins;
+                        for (int i=0; i<b->nbins; ++i)
+                            centers[i] = b->min + (i+0.5)*dbin;
+
+                        const std::vector<size_t> index = {0};
+                        const std::vector<size_t> size  = {static_cast<size_t>(b->nbins)};
+                        bin_var.putVar(index, size, &centers[0]);
+                    }
+
+                    dim_vector.push_back(m->bin_dims[vars[n]]);
+                }
+
+                m->hists[name].ncvar = m->dataFile->addVar(name, ncDouble, dim_vector);
+                m->hists[name].ncvar.putAtt("units", "-");
+                m->hists[name].ncvar.putAtt("long_name", "Fraction of the mask in the bins of " + *it);
+                m->hists[name].ncvar.putAtt("_FillValue", ncDouble, NC_FILL_DOUBLE);
+            }
+
+            Hist_var* h = &m->hists[name];
+            h->vars  = vars;
+            h->nbins = nbins;
+            h->data  = new double[grid->kcells*nbins];
+            h->nsum  = new double[grid->kcells];
+            for (int n=0; n<grid->kcells*nbins; ++n)
+                h->data[n] = 0.;
+            for (int k=0; k<grid->kcells; ++k)
+                h->nsum[k] = 0.;
+        }
+    }
+}
+
+void Stats::reduce_hists()
+{
+    const int kcells = grid->kcells;
+
+    // Sum the histograms of all masks in a single reduction.
+    std::vector<double> sum;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
+        for (Hist_map::iterator it2=it->second.hists.begin(); it2!=it->second.hists.end(); ++it2)
+            sum.insert(sum.end(), it2->second.data, it2->second.data + kcells*it2->second.nbins);
+
+    if (sum.empty())
+        return;
+
+    master->sum(&sum[0], sum.size());
+
+    // Normalize the number of cells in the bins with the number of cells in the mask.
+    int i = 0;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
+        for (Hist_map::iterator it2=it->second.hists.begin(); it2!=it->second.hists.end(); ++it2)
+        {
+            Hist_var* h = &it2->second;
+            for (int k=0; k<kcells; ++k)
+                for (int n=0; n<h->nbins; ++n, ++i)
+                {
+                    if (h->nsum[k] > 0.)
+                        h->data[k*h->nbins+n] = sum[i] / h->nsum[k];
+                    else
+                        h->data[k*h->nbins+n] = NC_FILL_DOUBLE;
+                }
+        }
+}
+
+void Stats::get_center_field(double* restrict data, std::string name)
+{
+    const int ii = 1;
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+
+    // Get the field at the cell centers, the velocities are interpolated.
+    if (fields->a.count(name))
+    {
+        fields->get_double_field(fields->atmp["tmp1"]->data, fields->a[name]);
+        const double* restrict fld = fields->atmp["tmp1"]->data;
+
+        int ishift = 0;
+        if (name == "u")
+            ishift = ii;
+        else if (name == "v")
+            ishift = jj;
+        else if (name == "w")
+            ishift = kk;
+
+        for (int k=grid->kstart; k<grid->kend; ++k)
+            for (int j=grid->jstart; j<grid->jend; ++j)
+                #pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    data[ijk] = 0.5*(fld[ijk] + fld[ijk+ishift]);
+                }
+
+        // Add the Galilean transformation velocity.
+        const double offset = (name == "u") ? grid->utrans : (name == "v") ? grid->vtrans : 0.;
+        if (offset != 0.)
+            for (int n=0; n<grid->ncells; ++n)
+                data[n] += offset;
+    }
+    else
+    {
+        model->thermo->get_thermo_field(fields->atmp["tmp1"], fields->atmp["tmp2"], name, false);
+        const double* restrict fld = fields->atmp["tmp1"]->data;
+        for (int n=0; n<grid->ncells; ++n)
+            data[n] = fld[n];
+    }
+}
+
+void Stats::calc_hists()
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
+
+    // The histograms are the same for all masks, take the list of the default mask.
+    Hist_map& defhists = masks["default"].hists;
+
+    for (Hist_map::iterator it=defhists.begin(); it!=defhists.end(); ++it)
+    {
+        const std::string& name = it->first;
+        const std::vector<std::string>& vars = it->second.vars;
+        const int nvars = vars.size();
+
+        // Compute the bin index of each cell for every variable, in case of a joint
+        // histogram the indices are combined into the index of the two-dimensional bin.
+        double* const restrict data = fields->atmp["tmp3"]->data;
+        double* const restrict bin  = fields->atmp["tmp4"]->data;
+
+        for (int v=0; v<nvars; ++v)
+        {
+            const Hist_bins* b = &histbins[vars[v]];
+            get_center_field(data, vars[v]);
+
+            // Bin the deviation from the horizontal mean, such that the bins follow the mean profile.
+            std::vector<double> mean(kcells, 0.);
+            if (b->type == "deviation")
+            {
+                for (int k=grid->kstart; k<grid->kend; ++k)
+                    for (int j=grid->jstart; j<grid->jend; ++j)
+                        for (int i=grid->istart; i<grid->iend; ++i)
+                            mean[k] += data[i + j*jj + k*kk];
+
+                master->sum(&mean[0], kcells);
+
+                for (int k=grid->kstart; k<grid->kend; ++k)
+                    mean[k] /= (double)(grid->itot*grid->jtot);
+            }
+
+            const double dbini = b->nbins / (b->max - b->min);
+
+            for (int k=grid->kstart; k<grid->kend; ++k)
+                for (int j=grid->jstart; j<grid->jend; ++j)
+                    #pragma ivdep
+                    for (int i=grid->istart; i<grid->iend; ++i)
+                    {
+                        const int ijk = i + j*jj + k*kk;
+                        const double index = std::floor((data[ijk] - mean[k] - b->min) * dbini);
+
+                        // Cells outside of the range of the bins are marked negative.
+                        const double binv = (index >= 0. && index < b->nbins) ? index : -1.;
+
+                        if (v == 0)
+                            bin[ijk] = binv;
+                        else
+                            bin[ijk] = (bin[ijk] < 0. || binv < 0.) ? -1. : bin[ijk]*b->nbins + binv;
+                    }
+        }
+
+        // Add the cells to the histograms of the masks they are in.
+        std::vector<double*> hists;
+        int n = 0;
+        for (Mask_map::iterator itm=masks.begin(); itm!=masks.end(); ++itm, ++n)
+        {
+            Hist_var* h = &itm->second.hists[name];
+            hists.push_back(h->data);
+
+            for (int k=grid->kstart; k<grid->kend; ++k)
+                h->nsum[k] += itm->second.nmask[k];
+        }
+
+        const int nbins = it->second.nbins;
+
+        for (int k=grid->kstart; k<grid->kend; ++k)
+            for (int j=grid->jstart; j<grid->jend; ++j)
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    if (bin[ijk] < 0.)
+                        continue;
+
+                    const int ib = k*nbins + (int)bin[ijk];
+                    for (int n=0; n<nmasks; ++n)
+                        if (get_mask_bit(&mfield[n*msize], i, j, k))
+                            hists[n][ib] += 1.;
+                }
+    }
+}
+
+void Stats::add_corrs()
+{
+    int nerror = 0;
+
+    for (std::vector<std::string>::const_iterator it=corrlist.begin(); it!=corrlist.end(); ++it)
+    {
+        #ifdef USECUDA
+        if (!fields->a.count(*it))
+        #else
+        if (!fields->a.count(*it) && !model->thermo->check_field_exists(*it))
+        #endif
+        {
+            master->print_error("field %s in [stats][corrlist] is illegal\n", it->c_str());
+            ++nerror;
+        }
+    }
+
+    if (nerror || corrlist.empty())
+    {
+        if (nerror)
+            throw 1;
+        return;
+    }
+
+    const int nrx = grid->itot/2+1;
+    const int nry = grid->jtot/2+1;
+
+    Mask* m = &masks["default"];
+
+    NcDim rx_dim;
+    NcDim ry_dim;
+
+    // Add the separation distances to the file of the full domain.
+    if (master->mpiid == 0)
+    {
+        rx_dim = m->dataFile->addDim("rx", nrx);
+        ry_dim = m->dataFile->addDim("ry", nry);
+
+        NcVar rx_var = m->dataFile->addVar("rx", ncDouble, rx_dim);
+        rx_var.putAtt("units", "m");
+        rx_var.putAtt("long_name", "Separation distance in the x-direction");
+
+        NcVar ry_var = m->dataFile->addVar("ry", ncDouble, ry_dim);
+        ry_var.putAtt("units", "m");
+        ry_var.putAtt("long_name", "Separation distance in the y-direction");
+
+        std::vector<double> rx(nrx);
+        std::vector<double> ry(nry);
+        for (int i=0; i<nrx; ++i)
+            rx[i] = i*grid->dx;
+        for (int j=0; j<nry; ++j)
+            ry[j] = j*grid->dy;
+
+        const std::vector<size_t> index = {0};
+        rx_var.putVar(index, std::vector<size_t>(1, nrx), &rx[0]);
+        ry_var.putVar(index, std::vector<size_t>(1, nry), &ry[0]);
+    }
+
+    for (std::vector<std::string>::const_iterator it=corrlist.begin(); it!=corrlist.end(); ++it)
+    {
+        Corr_var* c = &corrs[*it];
+
+        if (master->mpiid == 0)
+        {
+            const std::vector<NcDim> dims_rx = {m->t_dim, m->z_dim, rx_dim};
+            const std::vector<NcDim> dims_ry = {m->t_dim, m->z_dim, ry_dim};
+            const std::vector<NcDim> dims_z  = {m->t_dim, m->z_dim};
+
+            c->ncvarx  = m->dataFile->addVar("corrx_" + *it, ncDouble, dims_rx);
+            c->ncvary  = m->dataFile->addVar("corry_" + *it, ncDouble, dims_ry);
+            c->ncvarlx = m->dataFile->addVar("lx_" + *it, ncDouble, dims_z);
+            c->ncvarly = m->dataFile->addVar("ly_" + *it, ncDouble, dims_z);
+
+            c->ncvarx .putAtt("units", "-");
+            c->ncvarx .putAtt("long_name", "Autocorrelation of " + *it + " in the x-direction");
+            c->ncvary .putAtt("units", "-");
+            c->ncvary .putAtt("long_name", "Autocorrelation of " + *it + " in the y-direction");
+            c->ncvarlx.putAtt("units", "m");
+            c->ncvarlx.putAtt("long_name", "Integral length scale of " + *it + " in the x-direction");
+            c->ncvarly.putAtt("units", "m");
+            c->ncvarly.putAtt("long_name", "Integral length scale of " + *it + " in the y-direction");
+
+            c->ncvarx .putAtt("_FillValue", ncDouble, NC_FILL_DOUBLE);
+            c->ncvary .putAtt("_FillValue", ncDouble, NC_FILL_DOUBLE);
+            c->ncvarlx.putAtt("_FillValue", ncDouble, NC_FILL_DOUBLE);
+            c->ncvarly.putAtt("_FillValue", ncDouble, NC_FILL_DOUBLE);
+        }
+
+        c->covx = new double[grid->kcells*nrx];
+        c->covy = new double[grid->kcells*nry];
+        c->lx   = new double[grid->kcells];
+        c->ly   = new double[grid->kcells];
+
+        for (int n=0; n<grid->kcells*nrx; ++n)
+            c->covx[n] = 0.;
+        for (int n=0; n<grid->kcells*nry; ++n)
+            c->covy[n] = 0.;
+        for (int k=0; k<grid->kcells; ++k)
+        {
+            c->lx[k] = 0.;
+            c->ly[k] = 0.;
+        }
+    }
+}
+
+namespace
+{
+    // Normalize the autocovariance at one level into the autocorrelation and integrate it
+    // up to the first zero crossing into the integral length scale.
+    double calc_length_scale(double* const restrict corr, const int nr, const double dr)
+    {
+        const double cov0 = corr[0];
+        if (!(cov0 > 0.))
+        {
+            for (int r=0; r<nr; ++r)
+                corr[r] = NC_FILL_DOUBLE;
+            return NC_FILL_DOUBLE;
+        }
+
+        for (int r=0; r<nr; ++r)
+            corr[r] /= cov0;
+
+        double length = 0.;
+        for (int r=1; r<nr; ++r)
+        {
+            if (corr[r] <= 0.)
+            {
+                length += 0.5*dr*corr[r-1]*corr[r-1] / (corr[r-1] - corr[r]);
+                break;
+            }
+            length += 0.5*dr*(corr[r-1] + corr[r]);
+        }
+
+        return length;
+    }
+}
+
+void Stats::reduce_corrs()
+{
+    if (corrs.empty())
+        return;
+
+    const int nrx = grid->itot/2+1;
+    const int nry = grid->jtot/2+1;
+    const int kcells = grid->kcells;
+
+    // Sum the autocovariances of all variables in a single reduction.
+    std::vector<double> sum;
+    for (std::map<std::string, Corr_var>::iterator it=corrs.begin(); it!=corrs.end(); ++it)
+    {
+        sum.insert(sum.end(), it->second.covx, it->second.covx + kcells*nrx);
+        sum.insert(sum.end(), it->second.covy, it->second.covy + kcells*nry);
+    }
+
+    master->sum(&sum[0], sum.size());
+
+    int i = 0;
+    for (std::map<std::string, Corr_var>::iterator it=corrs.begin(); it!=corrs.end(); ++it)
+    {
+        Corr_var* c = &it->second;
+
+        for (int n=0; n<kcells*nrx; ++n, ++i)
+            c->covx[n] = sum[i];
+        for (int n=0; n<kcells*nry; ++n, ++i)
+            c->covy[n] = sum[i];
+
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            c->lx[k] = ncorrsamples ? calc_length_scale(&c->covx[k*nrx], nrx, grid->dx) : NC_FILL_DOUBLE;
+            c->ly[k] = ncorrsamples ? calc_length_scale(&c->covy[k*nry], nry, grid->dy) : NC_FILL_DOUBLE;
+        }
+    }
+}
+
+/**
+ * This function adds the horizontal autocovariances of the selected variables to the time sums.
+ * Following the Wiener-Khinchin theorem, the autocovariance along a row is the inverse Fourier
+ * transform of the power spectrum of the row. The rows are made available with the transposes and
+ * the Fourier transforms of the pressure solver, the deviations from the horizontal mean are used.
+ */
+void Stats::calc_corrs()
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+    const int imax = grid->imax;
+    const int jmax = grid->jmax;
+    const int itot = grid->itot;
+    const int jtot = grid->jtot;
+    const int iblock = grid->iblock;
+    const int kblock = grid->kblock;
+    const int kcells = grid->kcells;
+    const int nrx = itot/2+1;
+    const int nry = jtot/2+1;
+
+    // Global index of the first level in the transposed orientations.
+    const int kglob = master->mpicoordx*kblock + grid->kstart;
+
+    double* const restrict fftini  = grid->fftini;
+    double* const restrict fftouti = grid->fftouti;
+    double* const restrict fftinj  = grid->fftinj;
+    double* const restrict fftoutj = grid->fftoutj;
+
+    for (std::map<std::string, Corr_var>::iterator it=corrs.begin(); it!=corrs.end(); ++it)
+    {
+        Corr_var* c = &it->second;
+
+        double* const restrict data  = fields->atmp["tmp3"]->data;
+        double* const restrict fld   = fields->atmp["tmp4"]->data;
+        double* const restrict fldx  = fields->atmp["tmp1"]->data;
+        double* const restrict fldy  = fields->atmp["tmp2"]->data;
+
+        get_center_field(data, it->first);
+
+        // Store the deviation from the horizontal mean without ghost cells, as the transposes require.
+        std::vector<double> mean(kcells, 0.);
+        for (int k=grid->kstart; k<grid->kend; ++k)
+            for (int j=grid->jstart; j<grid->jend; ++j)
+                for (int i=grid->istart; i<grid->iend; ++i)
+                    mean[k] += data[i + j*jj + k*kk];
+
+        master->sum(&mean[0], kcells);
+
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            mean[k] /= (double)(itot*jtot);
+            for (int j=grid->jstart; j<grid->jend; ++j)
+                #pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk  = i + j*jj + k*kk;
+                    const int ijkc = (i-grid->istart) + (j-grid->jstart)*imax + (k-grid->kstart)*imax*jmax;
+                    fld[ijkc] = data[ijk] - mean[k];
+                }
+        }
+
+        // Autocovariance in the x-direction, the sum of the inverse transform of the power spectrum over the rows.
+        grid->transpose_zx(fldx, fld);
+
+        for (int k=0; k<kblock; ++k)
+        {
+            for (int n=0; n<itot*jmax; ++n)
+                fftini[n] = fldx[n + k*itot*jmax];
+
+            fftw_execute(grid->iplanf);
+
+            for (int j=0; j<jmax; ++j)
+            {
+                double* const restrict spec = &fftouti[j*itot];
+                double* const restrict pow  = &fftini [j*itot];
+
+                // The half-complex output stores the real parts of wavenumbers 0 to n/2 and the imaginary parts in reversed order.
+                pow[0] = spec[0]*spec[0];
+                for (int i=1; i<(itot+1)/2; ++i)
+                {
+                    pow[i]      = spec[i]*spec[i] + spec[itot-i]*spec[itot-i];
+                    pow[itot-i] = 0.;
+                }
+                if (itot%2 == 0)
+                    pow[itot/2] = spec[itot/2]*spec[itot/2];
+            }
+
+            fftw_execute(grid->iplanb);
+
+            double* const restrict covx = &c->covx[(kglob+k)*nrx];
+            const double fac = 1./((double)itot*itot*jtot);
+            for (int j=0; j<jmax; ++j)
+                for (int i=0; i<nrx; ++i)
+                    covx[i] += fac*fftouti[i + j*itot];
+        }
+
+        // Autocovariance in the y-direction, the rows are in the y-direction after a second transpose.
+        grid->transpose_xy(fldy, fldx);
+
+        for (int k=0; k<kblock; ++k)
+        {
+            for (int n=0; n<iblock*jtot; ++n)
+                fftinj[n] = fldy[n + k*iblock*jtot];
+
+            fftw_execute(grid->jplanf);
+
+            for (int i=0; i<iblock; ++i)
+            {
+                double* const restrict spec = &fftoutj[i];
+                double* const restrict pow  = &fftinj [i];
+
+                pow[0] = spec[0]*spec[0];
+                for (int j=1; j<(jtot+1)/2; ++j)
+                {
+                    pow[j*iblock]        = spec[j*iblock]*spec[j*iblock] + spec[(jtot-j)*iblock]*spec[(jtot-j)*iblock];
+                    pow[(jtot-j)*iblock] = 0.;
+                }
+                if (jtot%2 == 0)
+                    pow[jtot/2*iblock] = spec[jtot/2*iblock]*spec[jtot/2*iblock];
+            }
+
+            fftw_execute(grid->jplanb);
+
+            double* const restrict covy = &c->covy[(kglob+k)*nry];
+            const double fac = 1./((double)jtot*jtot*itot);
+            for (int j=0; j<nry; ++j)
+                for (int i=0; i<iblock; ++i)
+                    covy[j] += fac*fftoutj[i + j*iblock];
+        }
+    }
+
+    ++ncorrsamples;
+}
+
+// COMPUTATIONAL KERNELS BELOW
+void Stats::calc_mask(uint64_t* restrict mask, uint64_t* restrict maskh, uint64_t* restrict maskbot)
+{
+    // set the mask everywhere
+    for (int n=0; n<msize; ++n)
+        mask[n] = ~(uint64_t)0;
+
+    for (int n=0; n<msize; ++n)
+        maskh[n] = ~(uint64_t)0;
+
+    for (int n=0; n<mwords*mjcells; ++n)
+        maskbot[n] = ~(uint64_t)0;
+}
+
+/**
+ * This function expands row j at level k of packed mask n into the weights of the cells.
+ * The mask at the u and v locations is interpolated from the two neighbouring cells,
+ * which gives a weight of one half in case only one of them is in the mask.
+ * The function returns false in case no cell of the row is in the mask, such that the
+ * statistics kernels can skip the row and accumulate the others in a dense loop.
+ */
+bool Stats::get_weights(double* const restrict weight, const uint64_t* const restrict mask,
+                        const int n, const int j, const int k, const int loc[3])
+{
+    const int istart = grid->istart;
+    const int iend   = grid->iend;
+
+    const uint64_t* const restrict row      = &mask[n*msize + (j + k*mjcells)*mwords];
+    const uint64_t* const restrict rowshift = row - loc[1]*mwords;
+    const int ishift = loc[0];
+
+    uint64_t inmask = 0;
+    for (int w=(istart-ishift)/64; w<=(iend-1)/64; ++w)
+        inmask |= row[w] | rowshift[w];
+
+    if (!inmask)
+        return false;
+
+    for (int i=istart; i<iend; ++i)
+    {
+        const int is = i-ishift;
+        weight[i] = 0.5*(double)(((rowshift[is/64] >> (is%64)) & 1) + ((row[i/64] >> (i%64)) & 1));
+    }
+
+    return true;
+}
+
+void Stats::calc_area(std::string name, const int loc[3])
+{
+    const int ijtot = grid->itot*grid->jtot;
+
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it)
+    {
+        double* restrict area = it->second.profs[name].data;
+        const int* restrict nmask = loc[2] ? it->second.nmaskh : it->second.nmask;
+
+        for (int k=grid->kstart; k<grid->kend+loc[2]; k++)
+        {
+            if (nmask[k] > nthres)
+                area[k] = (double)(nmask[k]) / (double)ijtot;
+            else
+                area[k] = 0.;
+        }
+    }
+}
+
+void Stats::calc_mean(std::string name, const double* const restrict data,
+                      const double offset, const int loc[3])
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
+
+    const uint64_t* const restrict mask = loc[2] ? mfieldh : mfield;
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
+
+    std::vector<double> sum(nmasks*kcells, 0.);
+
+    for (int k=1; k<kcells; k++)
+        for (int n=0; n<nmasks; ++n)
+        {
+            double prof = 0.;
+            for (int j=grid->jstart; j<grid->jend; ++j)
+            {
+                if (!get_weights(weight, mask, n, j, k, loc))
+                    continue;
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    prof += weight[i]*(data[ijk] + offset);
+                }
+            }
+            sum[n*kcells+k] = prof;
+        }
+
+    sum_profs(sum, name, loc[2]);
+}
+
+void Stats::calc_mean2d(std::string name, const double* const restrict data,
+                        const double offset)
+{
+    const int jj = grid->icells;
+    const int nmasks = masks.size();
+
+    const int sloc[] = {0,0,0};
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
+
+    std::vector<double> sum(nmasks, 0.);
+
+    for (int n=0; n<nmasks; ++n)
+        for (int j=grid->jstart; j<grid->jend; j++)
+        {
+            if (!get_weights(weight, &mfieldbot[n*mwords*mjcells], 0, j, 0, sloc))
+                continue;
+#pragma ivdep
+            for (int i=grid->istart; i<grid->iend; i++)
+            {
+                const int ij = i + j*jj;
+                sum[n] += weight[i]*(data[ij] + offset);
+            }
+        }
+
+    // in case the samples are averaged in time, the reduction is postponed
+    if (!doaverage)
+        master->sum(&sum[0], nmasks);
+
+    int n = 0;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it, ++n)
+    {
+        if (it->second.nmaskbot > nthres)
+            it->second.tseries[name].data = sum[n] / (double)it->second.nmaskbot;
+        else
+            it->second.tseries[name].data = NC_FILL_DOUBLE;
+
+        it->second.tseries[name].partial = doaverage;
+    }
+}
+
+void Stats::calc_sorted_prof(double* restrict data, double* restrict bin, double* restrict prof)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+    const int kstart = grid->kstart;
+    const int kend = grid->kend;
+
+    double minval =  Constants::dhuge;
+    double maxval = -Constants::dhuge;
+
+    // first, get min and max
+    for (int k=grid->kstart; k<grid->kend; ++k)
+        for (int j=grid->jstart; j<grid->jend; j++)
+#pragma ivdep
+            for (int i=grid->istart; i<grid->iend; i++)
+            {
+                const int ijk = i + j*jj + k*kk;
+                if (data[ijk] < minval)
+                    minval = data[ijk];
+                if (data[ijk] > maxval)
+                    maxval = data[ijk];
+            }
+
+    master->min(&minval, 1);
+    master->max(&maxval, 1);
+
+    // make sure that the max ends up in the last bin (introduce 1E-9 error)
+    maxval *= (1.+Constants::dsmall);
+
+    const double range = maxval-minval;
+
+    // In case the field is entirely uniform, dbin becomes zero. In that case we set the profile to the minval.
+    if (range < 1.e-16)
+    {
+        for (int k=grid->kstart; k<grid->kend; ++k)
+            prof[k] = minval;
+    }
+    else
+    {
+        // create bins, equal to the number of grid cells per proc
+        // make sure that bins is not larger than the memory of one 3d field
+        const int bins = grid->nmax;
+
+        // calculate bin width, subtract one to make the minimum and maximum
+        // are in the middle of the bin range and add half a bin size on both sides
+        // |----x----|----x----|----x----|
+        const double dbin = range / (double)(bins-1);
+
+        minval -= 0.5*dbin;
+        maxval += 0.5*dbin;
+
+        // set the bin array to zero
+        for (int n=0; n<bins; ++n)
+            bin[n] = 0;
+
+        // calculate the division factor of one equivalent height unit
+        // (the total volume saved is itot*jtot*zsize)
+        const double nslice = (double)(grid->itot*grid->jtot);
+
+        // check in which bin each value falls and increment the bin count
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            const double dzslice = grid->dz[k] / nslice;
+            for (int j=grid->jstart; j<grid->jend; ++j)
+                // do not add a ivdep pragma here, because multiple instances could write the same bin[index]
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    const int index = (int)((data[ijk] - minval) / dbin);
+                    bin[index] += dzslice;
+                }
+        }
+
+        // get the bin count
+        master->sum(bin, bins);
+
+        // set the starting values of the loop
+        int index = 0;
+        double zbin = 0.5*bin[index];
+        double profval = minval + 0.5*dbin;
+
+        for (int k=grid->kstart; k<grid->kend; ++k)
+        {
+            // Integrate the profile up to the bin count.
+            // Escape the while loop when the integrated profile
+            // exceeds the next grid point.
+            while (zbin < grid->z[k])
+            {
+                zbin += 0.5*(bin[index]+bin[index+1]);
+                profval += dbin;
+                ++index;
+            }
+
+            // In case the first bin is larger than the grid spacing, which can happen
+            // in the inital phase of an MPI run, make sure that no out-of-bounds reads
+            // happen.
+            if (index == 0)
+                prof[k] = profval;
+            else
+            {
+                const double dzfrac = (zbin-grid->z[k]) / (0.5*(bin[index-1]+bin[index]));
+                prof[k] = profval - dzfrac*dbin;
+            }
+        }
+    }
+
+    // now calculate the ghost cells
+    // \TODO this might not be accurate enough, extrapolate properly
+    double profbot = minval;
+    double proftop = maxval;
+
+    if (grid->swspatialorder == "2")
+    {
+        prof[kstart-1] = 2.*profbot - prof[kstart];
+        prof[kend]     = 2.*proftop - prof[kend-1];
+    }
+    else if (grid->swspatialorder == "4")
+    {
+        prof[kstart-1] = (8./3.)*profbot - 2.*prof[kstart] + (1./3.)*prof[kstart+1];
+        prof[kstart-2] = 8.*profbot      - 9.*prof[kstart] + 2.*prof[kstart+1];
+        prof[kend]     = (8./3.)*proftop - 2.*prof[kend-1] + (1./3.)*prof[kend-2];
         prof[kend+1]   = 8.*proftop      - 9.*prof[kend-1] + 2.*prof[kend-2];
     }
 }
 
-// \TODO the count function assumes that the variable to count is at the mask location
-void Stats::calc_count(double* restrict data, double* restrict prof, double threshold,
-                       double* restrict mask, int* restrict nmask)
+// \TODO the count function assumes that the variable to count is at the mask location
+void Stats::calc_count(double* restrict data, std::string name, double threshold)
+{
+    const int jj = grid->icells;
+    const int kk = grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
+
+    const int sloc[] = {0,0,0};
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
+
+    std::vector<double> sum(nmasks*kcells, 0.);
+
+    for (int k=0; k<kcells; ++k)
+        for (int n=0; n<nmasks; ++n)
+        {
+            double prof = 0.;
+            for (int j=grid->jstart; j<grid->jend; ++j)
+            {
+                if (!get_weights(weight, mfield, n, j, k, sloc))
+                    continue;
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    if (data[ijk] > threshold)
+                        prof += weight[i];
+                }
+            }
+            sum[n*kcells+k] = prof;
+        }
+
+    sum_profs(sum, name, false);
+}
+
+void Stats::calc_moment(double* restrict data, std::string meanname, std::string name, double power, const int loc[3])
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
 
-    for (int k=0; k<grid->kcells; ++k)
-    {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+    const uint64_t* const restrict mask = loc[2] ? mfieldh : mfield;
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
+
+    std::vector<double*> means = get_profs(meanname);
+    std::vector<double> sum(nmasks*kcells, 0.);
+
+    for (int k=grid->kstart; k<grid->kend+1; ++k)
+        for (int n=0; n<nmasks; ++n)
+        {
+            double prof = 0.;
+            for (int j=grid->jstart; j<grid->jend; ++j)
             {
-                const int ijk = i + j*jj + k*kk;
-                if (data[ijk] > threshold)
-                    prof[k] += mask[ijk]*1.;
+                if (!get_weights(weight, mask, n, j, k, loc))
+                    continue;
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    prof += weight[i]*std::pow(data[ijk]-means[n][k], power);
+                }
             }
-    }
-
-    master->sum(prof, grid->kcells);
+            sum[n*kcells+k] = prof;
+        }
 
-    for (int k=0; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_profs(sum, name, loc[2]);
 }
 
-void Stats::calc_moment(double* restrict data, double* restrict datamean, double* restrict prof, double power, const int loc[3],
-                        double* restrict mask, int* restrict nmask)
+void Stats::calc_moments(double* restrict data, std::string meanname, std::string name, const int loc[3])
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
+
+    const uint64_t* const restrict mask = loc[2] ? mfieldh : mfield;
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
+
+    std::vector<double*> means = get_profs(meanname);
+
+    // The second, third and fourth moment are stored one after another to sum them in a single reduction.
+    std::vector<std::string> names = {name+"2", name+"3", name+"4"};
+    std::vector<double> sum(3*nmasks*kcells, 0.);
+    double* const restrict sum2 = &sum[0];
+    double* const restrict sum3 = &sum[1*nmasks*kcells];
+    double* const restrict sum4 = &sum[2*nmasks*kcells];
 
     for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nmasks; ++n)
+        {
+            const double mean = means[n][k];
+            double prof2 = 0.;
+            double prof3 = 0.;
+            double prof4 = 0.;
+            for (int j=grid->jstart; j<grid->jend; ++j)
             {
-                const int ijk = i + j*jj + k*kk;
-                prof[k] += mask[ijk]*std::pow(data[ijk]-datamean[k], power);
+                if (!get_weights(weight, mask, n, j, k, loc))
+                    continue;
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    const double dev  = data[ijk] - mean;
+                    const double dev2 = weight[i]*dev*dev;
+                    prof2 += dev2;
+                    prof3 += dev2*dev;
+                    prof4 += dev2*dev*dev;
+                }
             }
-    }
-
-    master->sum(prof, grid->kcells);
+            sum2[n*kcells+k] = prof2;
+            sum3[n*kcells+k] = prof3;
+            sum4[n*kcells+k] = prof4;
+        }
 
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_profs(sum, names, loc[2]);
 }
 
-void Stats::calc_flux_2nd(double* restrict data, double* restrict datamean, double* restrict w, double* restrict wmean,
-                          double* restrict prof, double* restrict tmp1, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
+void Stats::calc_flux_2nd(double* restrict data, std::string meanname, double* restrict w, std::string wmeanname,
+                          std::string name, double* restrict tmp1, const int loc[3])
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
 
     // set a pointer to the field that contains w, either interpolated or the original
     double* restrict calcw = w;
@@ -661,38 +1823,52 @@ void Stats::calc_flux_2nd(double* restrict data, double* restrict datamean, doub
         calcw = tmp1;
     }
 
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
+
+    std::vector<double*> means  = get_profs(meanname);
+    std::vector<double*> wmeans = get_profs(wmeanname);
+    std::vector<double> sum(nmasks*kcells, 0.);
+
     for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nmasks; ++n)
+        {
+            const double meanh = 0.5*(means[n][k-1]+means[n][k]);
+            const double wmean = wmeans[n][k];
+            double prof = 0.;
+            for (int j=grid->jstart; j<grid->jend; ++j)
             {
-                const int ijk  = i + j*jj + k*kk;
-                prof[k] += mask[ijk]*(0.5*(data[ijk-kk]+data[ijk])-0.5*(datamean[k-1]+datamean[k]))*(calcw[ijk]-wmean[k]);
-                // prof[k] += mask[ijk]*0.5*(data[ijk-kk]+data[ijk])*calcw[ijk];
+                if (!get_weights(weight, mfieldh, n, j, k, loc))
+                    continue;
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk  = i + j*jj + k*kk;
+                    prof += weight[i]*(0.5*(data[ijk-kk]+data[ijk])-meanh)*(calcw[ijk]-wmean);
+                }
             }
-    }
+            sum[n*kcells+k] = prof;
+        }
 
-    master->sum(prof, grid->kcells);
+    sum_profs(sum, name, true);
 
-    for (int k=1; k<grid->kcells; ++k)
-    {
-        if (nmask[k] > nthres && datamean[k-1] != NC_FILL_DOUBLE && datamean[k] != NC_FILL_DOUBLE)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    // the flux is undefined where the mean is undefined
+    std::vector<Prof_var*> profs = get_prof_vars(name);
+    for (int n=0; n<nmasks; ++n)
+        for (int k=1; k<kcells; ++k)
+            if (means[n][k-1] == NC_FILL_DOUBLE || means[n][k] == NC_FILL_DOUBLE)
+                profs[n]->data[k] = NC_FILL_DOUBLE;
 }
 
-void Stats::calc_flux_4th(double* restrict data, double* restrict w, double* restrict prof, double* restrict tmp1, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
+void Stats::calc_flux_4th(double* restrict data, double* restrict w, std::string name, double* restrict tmp1, const int loc[3])
 {
     using namespace Finite_difference::O4;
 
     const int jj  = 1*grid->icells;
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
 
     // set a pointer to the field that contains w, either interpolated or the original
     double* restrict calcw = w;
@@ -713,323 +1889,419 @@ void Stats::calc_flux_4th(double* restrict data, double* restrict w, double* res
         calcw = tmp1;
     }
 
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
+
+    std::vector<double> sum(nmasks*kcells, 0.);
+
     for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nmasks; ++n)
+        {
+            double prof = 0.;
+            for (int j=grid->jstart; j<grid->jend; ++j)
             {
-                const int ijk = i + j*jj + k*kk1;
-                prof[k] += mask[ijk]*(ci0*data[ijk-kk2] + ci1*data[ijk-kk1] + ci2*data[ijk] + ci3*data[ijk+kk1])*calcw[ijk];
+                if (!get_weights(weight, mfieldh, n, j, k, loc))
+                    continue;
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk1;
+                    prof += weight[i]*(ci0*data[ijk-kk2] + ci1*data[ijk-kk1] + ci2*data[ijk] + ci3*data[ijk+kk1])*calcw[ijk];
+                }
             }
-    }
-
-    master->sum(prof, grid->kcells);
+            sum[n*kcells+k] = prof;
+        }
 
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_profs(sum, name, true);
 }
 
-void Stats::calc_grad_2nd(double* restrict data, double* restrict prof, double* restrict dzhi, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
+void Stats::calc_grad_2nd(double* restrict data, std::string name, double* restrict dzhi, const int loc[3])
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
+
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
+
+    std::vector<double> sum(nmasks*kcells, 0.);
 
     for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nmasks; ++n)
+        {
+            double prof = 0.;
+            for (int j=grid->jstart; j<grid->jend; ++j)
             {
-                const int ijk = i + j*jj + k*kk;
-                prof[k] += mask[ijk]*(data[ijk]-data[ijk-kk])*dzhi[k];
+                if (!get_weights(weight, mfieldh, n, j, k, loc))
+                    continue;
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    prof += weight[i]*(data[ijk]-data[ijk-kk])*dzhi[k];
+                }
             }
-    }
-
-    master->sum(prof, grid->kcells);
+            sum[n*kcells+k] = prof;
+        }
 
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_profs(sum, name, true);
 }
 
-void Stats::calc_grad_4th(double* restrict data, double* restrict prof, double* restrict dzhi4, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
+void Stats::calc_grad_4th(double* restrict data, std::string name, double* restrict dzhi4, const int loc[3])
 {
     using namespace Finite_difference::O4;
 
     const int jj  = 1*grid->icells;
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
+
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
+
+    std::vector<double> sum(nmasks*kcells, 0.);
 
     for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nmasks; ++n)
+        {
+            double prof = 0.;
+            for (int j=grid->jstart; j<grid->jend; ++j)
             {
-                const int ijk = i + j*jj + k*kk1;
-                prof[k] += mask[ijk]*(cg0*data[ijk-kk2] + cg1*data[ijk-kk1] + cg2*data[ijk] + cg3*data[ijk+kk1])*dzhi4[k];
+                if (!get_weights(weight, mfieldh, n, j, k, loc))
+                    continue;
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk1;
+                    prof += weight[i]*(cg0*data[ijk-kk2] + cg1*data[ijk-kk1] + cg2*data[ijk] + cg3*data[ijk+kk1])*dzhi4[k];
+                }
             }
-    }
-
-    master->sum(prof, grid->kcells);
+            sum[n*kcells+k] = prof;
+        }
 
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_profs(sum, name, true);
 }
 
-void Stats::calc_diff_4th(double* restrict data, double* restrict prof, double* restrict dzhi4, double visc, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
+void Stats::calc_diff_4th(double* restrict data, std::string name, double* restrict dzhi4, double visc, const int loc[3])
 {
     using namespace Finite_difference::O4;
 
     const int jj  = 1*grid->icells;
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
+
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
+
+    std::vector<double> sum(nmasks*kcells, 0.);
 
     for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nmasks; ++n)
+        {
+            double prof = 0.;
+            for (int j=grid->jstart; j<grid->jend; ++j)
             {
-                const int ijk = i + j*jj + k*kk1;
-                prof[k] -= mask[ijk]*visc*(cg0*data[ijk-kk2] + cg1*data[ijk-kk1] + cg2*data[ijk] + cg3*data[ijk+kk1])*dzhi4[k];
+                if (!get_weights(weight, mfieldh, n, j, k, loc))
+                    continue;
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk1;
+                    prof -= weight[i]*visc*(cg0*data[ijk-kk2] + cg1*data[ijk-kk1] + cg2*data[ijk] + cg3*data[ijk+kk1])*dzhi4[k];
+                }
             }
-    }
-
-    master->sum(prof, grid->kcells);
+            sum[n*kcells+k] = prof;
+        }
 
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_profs(sum, name, true);
 }
 
-void Stats::calc_diff_2nd(double* restrict data, double* restrict prof, double* restrict dzhi, double visc, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
+void Stats::calc_diff_2nd(double* restrict data, std::string name, double* restrict dzhi, double visc, const int loc[3])
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
+
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
+
+    std::vector<double> sum(nmasks*kcells, 0.);
 
     for (int k=grid->kstart; k<grid->kend+1; ++k)
-    {
-        prof[k] = 0.;
-        for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; ++i)
+        for (int n=0; n<nmasks; ++n)
+        {
+            double prof = 0.;
+            for (int j=grid->jstart; j<grid->jend; ++j)
             {
-                const int ijk = i + j*jj + k*kk;
-                prof[k] -= mask[ijk]*visc*(data[ijk] - data[ijk-kk])*dzhi[k];
+                if (!get_weights(weight, mfieldh, n, j, k, loc))
+                    continue;
+#pragma ivdep
+                for (int i=grid->istart; i<grid->iend; ++i)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    prof -= weight[i]*visc*(data[ijk] - data[ijk-kk])*dzhi[k];
+                }
             }
-    }
-
-    master->sum(prof, grid->kcells);
+            sum[n*kcells+k] = prof;
+        }
 
-    for (int k=1; k<grid->kcells; k++)
-    {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
-    }
+    sum_profs(sum, name, true);
 }
 
 
 void Stats::calc_diff_2nd(double* restrict data, double* restrict w, double* restrict evisc,
-                          double* restrict prof, double* restrict dzhi,
-                          double* restrict fluxbot, double* restrict fluxtop, double tPr, const int loc[3],
-                          double* restrict mask, int* restrict nmask)
+                          std::string name, double* restrict dzhi,
+                          double* restrict fluxbot, double* restrict fluxtop, double tPr, const int loc[3])
 {
     const int ii = 1;
     const int jj = grid->icells;
     const int kk = grid->ijcells;
     const int kstart = grid->kstart;
     const int kend = grid->kend;
+    const int kcells = grid->kcells;
+    const int nmasks = masks.size();
 
     const double dxi = 1./grid->dx;
     const double dyi = 1./grid->dy;
 
-    // bottom boundary
-    prof[kstart] = 0.;
-    for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
-        {
-            const int ij  = i + j*jj;
-            const int ijk = i + j*jj + kstart*kk;
-            prof[kstart] += mask[ijk]*fluxbot[ij];
-        }
+    std::vector<double> weights(grid->icells);
+    double* const restrict weight = &weights[0];
 
-    // calculate the interior
-    if (loc[0] == 1)
+    std::vector<double> sum(nmasks*kcells, 0.);
+
+    for (int n=0; n<nmasks; ++n)
     {
-        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        // bottom boundary
+        double prof = 0.;
+        for (int j=grid->jstart; j<grid->jend; ++j)
         {
-            prof[k] = 0.;
-            for (int j=grid->jstart; j<grid->jend; ++j)
+            if (!get_weights(weight, mfieldh, n, j, kstart, loc))
+                continue;
 #pragma ivdep
-                for (int i=grid->istart; i<grid->iend; ++i)
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ij = i + j*jj;
+                prof += weight[i]*fluxbot[ij];
+            }
+        }
+        sum[n*kcells+kstart] = prof;
+
+        // calculate the interior
+        if (loc[0] == 1)
+        {
+            for (int k=grid->kstart+1; k<grid->kend; ++k)
+            {
+                prof = 0.;
+                for (int j=grid->jstart; j<grid->jend; ++j)
                 {
-                    const int ijk  = i + j*jj + k*kk;
-                    // evisc * (du/dz + dw/dx)
-                    const double eviscu = 0.25*(evisc[ijk-ii-kk]+evisc[ijk-ii]+evisc[ijk-kk]+evisc[ijk]);
-                    prof[k] += -mask[ijk]*eviscu*( (data[ijk]-data[ijk-kk])*dzhi[k] + (w[ijk]-w[ijk-ii])*dxi );
+                    if (!get_weights(weight, mfieldh, n, j, k, loc))
+                        continue;
+#pragma ivdep
+                    for (int i=grid->istart; i<grid->iend; ++i)
+                    {
+                        const int ijk  = i + j*jj + k*kk;
+                        // evisc * (du/dz + dw/dx)
+                        const double eviscu = 0.25*(evisc[ijk-ii-kk]+evisc[ijk-ii]+evisc[ijk-kk]+evisc[ijk]);
+                        prof += -weight[i]*eviscu*( (data[ijk]-data[ijk-kk])*dzhi[k] + (w[ijk]-w[ijk-ii])*dxi );
+                    }
                 }
+                sum[n*kcells+k] = prof;
+            }
         }
-    }
-    else if (loc[1] == 1)
-    {
-        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        else if (loc[1] == 1)
         {
-            prof[k] = 0.;
-            for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-                for (int i=grid->istart; i<grid->iend; ++i)
+            for (int k=grid->kstart+1; k<grid->kend; ++k)
+            {
+                prof = 0.;
+                for (int j=grid->jstart; j<grid->jend; ++j)
                 {
-                    const int ijk = i + j*jj + k*kk;
-                    // evisc * (dv/dz + dw/dy)
-                    const double eviscv = 0.25*(evisc[ijk-jj-kk]+evisc[ijk-jj]+evisc[ijk-kk]+evisc[ijk]);
-                    prof[k] += -mask[ijk]*eviscv*( (data[ijk]-data[ijk-kk])*dzhi[k] + (w[ijk]-w[ijk-jj])*dyi );
+                    if (!get_weights(weight, mfieldh, n, j, k, loc))
+                        continue;
+#pragma ivdep
+                    for (int i=grid->istart; i<grid->iend; ++i)
+                    {
+                        const int ijk = i + j*jj + k*kk;
+                        // evisc * (dv/dz + dw/dy)
+                        const double eviscv = 0.25*(evisc[ijk-jj-kk]+evisc[ijk-jj]+evisc[ijk-kk]+evisc[ijk]);
+                        prof += -weight[i]*eviscv*( (data[ijk]-data[ijk-kk])*dzhi[k] + (w[ijk]-w[ijk-jj])*dyi );
+                    }
                 }
+                sum[n*kcells+k] = prof;
+            }
         }
-    }
-    else
-    {
-        for (int k=grid->kstart+1; k<grid->kend; ++k)
+        else
         {
-            prof[k] = 0.;
-            for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-                for (int i=grid->istart; i<grid->iend; ++i)
+            for (int k=grid->kstart+1; k<grid->kend; ++k)
+            {
+                prof = 0.;
+                for (int j=grid->jstart; j<grid->jend; ++j)
                 {
-                    const int ijk = i + j*jj + k*kk;
-                    const double eviscs = 0.5*(evisc[ijk-kk]+evisc[ijk])/tPr;
-                    prof[k] += -mask[ijk]*eviscs*(data[ijk]-data[ijk-kk])*dzhi[k];
+                    if (!get_weights(weight, mfieldh, n, j, k, loc))
+                        continue;
+#pragma ivdep
+                    for (int i=grid->istart; i<grid->iend; ++i)
+                    {
+                        const int ijk = i + j*jj + k*kk;
+                        const double eviscs = 0.5*(evisc[ijk-kk]+evisc[ijk])/tPr;
+                        prof += -weight[i]*eviscs*(data[ijk]-data[ijk-kk])*dzhi[k];
+                    }
                 }
+                sum[n*kcells+k] = prof;
+            }
         }
-    }
 
-    // top boundary
-    prof[kend] = 0.;
-    for (int j=grid->jstart; j<grid->jend; ++j)
-#pragma ivdep
-        for (int i=grid->istart; i<grid->iend; ++i)
+        // top boundary
+        prof = 0.;
+        for (int j=grid->jstart; j<grid->jend; ++j)
         {
-            const int ij  = i + j*jj;
-            const int ijk = i + j*jj + kend*kk;
-            prof[kend] += mask[ijk]*fluxtop[ij];
+            if (!get_weights(weight, mfieldh, n, j, kend, loc))
+                continue;
+#pragma ivdep
+            for (int i=grid->istart; i<grid->iend; ++i)
+            {
+                const int ij = i + j*jj;
+                prof += weight[i]*fluxtop[ij];
+            }
         }
+        sum[n*kcells+kend] = prof;
+    }
+
+    sum_profs(sum, name, true);
+}
 
-    master->sum(prof, grid->kcells);
+void Stats::add_fluxes(std::string fluxname, std::string turbname, std::string diffname)
+{
+    std::vector<Prof_var*> fluxes = get_prof_vars(fluxname);
+    std::vector<Prof_var*> turbs  = get_prof_vars(turbname);
+    std::vector<Prof_var*> diffs  = get_prof_vars(diffname);
 
-    for (int k=1; k<grid->kcells; k++)
+    // The sum of the contributions of a process is the contribution to the sum,
+    // thus only complete the profiles if one of them is complete already.
+    if (turbs[0]->partial != diffs[0]->partial)
     {
-        if (nmask[k] > nthres)
-            prof[k] /= (double)(nmask[k]);
-        else
-            prof[k] = NC_FILL_DOUBLE;
+        reduce_profs(turbs);
+        reduce_profs(diffs);
     }
-}
 
-void Stats::add_fluxes(double* restrict flux, double* restrict turb, double* restrict diff)
-{
-    for (int k=grid->kstart; k<grid->kend+1; ++k)
+    for (size_t n=0; n<fluxes.size(); ++n)
     {
-        if (turb[k] == NC_FILL_DOUBLE || diff[k] == NC_FILL_DOUBLE)
-            flux[k] = NC_FILL_DOUBLE;
-        else
-            flux[k] = turb[k] + diff[k];
+        double* restrict flux = fluxes[n]->data;
+        double* restrict turb = turbs[n]->data;
+        double* restrict diff = diffs[n]->data;
+
+        fluxes[n]->partial = turbs[n]->partial;
+
+        for (int k=grid->kstart; k<grid->kend+1; ++k)
+        {
+            if (turb[k] == NC_FILL_DOUBLE || diff[k] == NC_FILL_DOUBLE)
+                flux[k] = NC_FILL_DOUBLE;
+            else
+                flux[k] = turb[k] + diff[k];
+        }
     }
 }
 
 /**
- * This function calculates the total domain integrated path of variable data over maskbot
+ * This function calculates the total domain integrated path of variable data over the surface masks
  */
-void Stats::calc_path(double* restrict data, double* restrict maskbot, int* restrict nmaskbot, double* restrict path)
+void Stats::calc_path(double* restrict data, std::string name)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
     const int kstart = grid->kstart;
+    const int nmasks = masks.size();
 
-    *path = 0.;
+    std::vector<double> path(nmasks, 0.);
 
-    if (*nmaskbot > nthres)
-    {
-        // Integrate liquid water
+    // Integrate liquid water
+    for (int n=0; n<nmasks; ++n)
         for (int j=grid->jstart; j<grid->jend; j++)
             for (int i=grid->istart; i<grid->iend; i++)
             {
-                const int ij = i + j*jj;
-                if (maskbot[ij] == 1)
-                    for (int k=kstart; k<grid->kend; k++)
-                    {
-                        const int ijk = i + j*jj + k*kk;
-                        *path += fields->rhoref[k] * data[ijk] * grid->dz[k];
-                    }
+                if (!get_mask_bit(&mfieldbot[n*mwords*mjcells], i, j, 0))
+                    continue;
+
+                for (int k=kstart; k<grid->kend; k++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    path[n] += fields->rhoref[k] * data[ijk] * grid->dz[k];
+                }
             }
-        *path /= (double)*nmaskbot;
-        master->sum(path, 1);
+
+    int n = 0;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it, ++n)
+        if (it->second.nmaskbot > nthres)
+            path[n] /= (double)it->second.nmaskbot;
+
+    // in case the samples are averaged in time, the reduction is postponed
+    if (!doaverage)
+        master->sum(&path[0], nmasks);
+
+    n = 0;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it, ++n)
+    {
+        if (it->second.nmaskbot > nthres)
+            it->second.tseries[name].data = path[n];
+        else
+            it->second.tseries[name].data = NC_FILL_DOUBLE;
+
+        it->second.tseries[name].partial = doaverage;
     }
-    else
-        *path = NC_FILL_DOUBLE;
 }
 
 /**
- * This function calculates the vertical projected cover of variable data over maskbot
+ * This function calculates the vertical projected cover of variable data over the surface masks
  */
-void Stats::calc_cover(double* restrict data, double* restrict maskbot, int* restrict nmaskbot, double* restrict cover, double threshold)
+void Stats::calc_cover(double* restrict data, std::string name, double threshold)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
     const int kstart = grid->kstart;
+    const int nmasks = masks.size();
 
-    *cover = 0.;
+    std::vector<double> cover(nmasks, 0.);
 
-    if (*nmaskbot > nthres)
-    {
-        // Per column, check if cloud present
+    // Per column, check if cloud present
+    for (int n=0; n<nmasks; ++n)
         for (int j=grid->jstart; j<grid->jend; j++)
             for (int i=grid->istart; i<grid->iend; i++)
             {
-                const int ij = i + j*jj;
-                if (maskbot[ij] == 1)
-                    for (int k=kstart; k<grid->kend; k++)
+                if (!get_mask_bit(&mfieldbot[n*mwords*mjcells], i, j, 0))
+                    continue;
+
+                for (int k=kstart; k<grid->kend; k++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    if (data[ijk]>threshold)
                     {
-                        const int ijk = i + j*jj + k*kk;
-                        if (data[ijk]>threshold)
-                        {
-                            *cover += 1.;
-                            break;
-                        }
+                        cover[n] += 1.;
+                        break;
                     }
+                }
             }
-        *cover /= (double)*nmaskbot;
-        master->sum(cover,1);
+
+    int n = 0;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it, ++n)
+        if (it->second.nmaskbot > nthres)
+            cover[n] /= (double)it->second.nmaskbot;
+
+    // in case the samples are averaged in time, the reduction is postponed
+    if (!doaverage)
+        master->sum(&cover[0], nmasks);
+
+    n = 0;
+    for (Mask_map::iterator it=masks.begin(); it!=masks.end(); ++it, ++n)
+    {
+        if (it->second.nmaskbot > nthres)
+            it->second.tseries[name].data = cover[n];
+        else
+            it->second.tseries[name].data = NC_FILL_DOUBLE;
+
+        it->second.tseries[name].partial = doaverage;
     }
-    else
-        *cover = NC_FILL_DOUBLE;
 }
@@ -0,0 +1,117 @@
+/*
+ * MicroHH
+ * Copyright (c) 2011-2017 Chiel van Heerwaarden
+ * Copyright (c) 2011-2017 Thijs Heus
+ * Copyright (c) 2014-2017 Bart van Stratum
+ *
+ * This file is part of MicroHH
+ *
+ * MicroHH is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * MicroHH is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with MicroHH.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <algorithm>
+#include "master.h"
+#include "input.h"
+#include "grid.h"
+#include "fields.h"
+#include "model.h"
+#include "advec.h"
+#include "diff.h"
+#include "thermo.h"
+#include "buffer.h"
+#include "tendency.h"
+
+Tendency::Tendency(Model* modelin, Input* inputin)
+{
+    model  = modelin;
+    grid   = model->grid;
+    master = model->master;
+
+    int nerror = 0;
+    nerror += inputin->get_item(&swfused, "tendency", "swfused", "", "0");
+    if (swfused == "1")
+        nerror += inputin->get_item(&kblock, "tendency", "kblock", "", 4);
+
+    if (nerror)
+        throw 1;
+
+    if (swfused == "1")
+    {
+        #ifdef USECUDA
+        master->print_error("swfused=1 is not supported on the GPU\n");
+        throw 1;
+        #endif
+
+        // The blocked kernels are only available for the second order schemes.
+        if (grid->swspatialorder != "2")
+        {
+            master->print_error("swfused=1 requires swspatialorder=2\n");
+            ++nerror;
+        }
+        if (model->advec->get_switch() != "0" && model->advec->get_switch() != "2")
+        {
+            master->print_error("swfused=1 is not supported for swadvec=%s\n", model->advec->get_switch().c_str());
+            ++nerror;
+        }
+        if (model->diff->get_switch() != "0" && model->diff->get_switch() != "2" && model->diff->get_switch() != "smag2")
+        {
+            master->print_error("swfused=1 is not supported for swdiff=%s\n", model->diff->get_switch().c_str());
+            ++nerror;
+        }
+        if (model->thermo->get_switch() != "0" && model->thermo->get_switch() != "dry" && model->thermo->get_switch() != "moist")
+        {
+            master->print_error("swfused=1 is not supported for swthermo=%s\n", model->thermo->get_switch().c_str());
+            ++nerror;
+        }
+        if (kblock < 1)
+        {
+            master->print_error("kblock has to be at least 1\n");
+            ++nerror;
+        }
+    }
+
+    if (nerror)
+        throw 1;
+}
+
+Tendency::~Tendency()
+{
+}
+
+std::string Tendency::get_switch()
+{
+    return swfused;
+}
+
+void Tendency::exec()
+{
+    // Operations on full columns that have to precede the sweep, such as the base state update.
+    model->thermo->prepare_block_sweep();
+
+    // Walk through the domain in blocks of kblock levels and let every operator
+    // add its tendency to the block, while the fields of the block are in cache.
+    for (int kb=grid->kstart; kb<grid->kend; kb+=kblock)
+    {
+        const int ke = std::min(kb+kblock, grid->kend);
+
+        model->advec ->exec_block(kb, ke);
+        model->diff  ->exec_block(kb, ke);
+        model->thermo->exec_block(kb, ke);
+        model->buffer->exec_block(kb, ke);
+    }
+
+    // The operations that follow the sweep, such as the microphysics, need the
+    // time step and are called by the model after the time step is set.
+}
@@ -46,6 +46,12 @@ Thermo::~Thermo()
 {
 }
 
+void Thermo::exec_block(const int kb, const int ke)
+{
+    master->print_error("swthermo=%s does not support the fused tendency sweep\n", swthermo.c_str());
+    throw 1;
+}
+
 std::string Thermo::get_switch()
 {
     return swthermo;
@@ -158,18 +158,23 @@ void Thermo_dry::create(Input *inputin)
 void Thermo_dry::exec()
 {
     if (grid->swspatialorder== "2")
-        calc_buoyancy_tend_2nd(fields->wt->data, fields->sp["th"]->data, threfh);
+        calc_buoyancy_tend_2nd(fields->wt->data, fields->sp["th"]->data, threfh, grid->kstart, grid->kend);
     else if (grid->swspatialorder == "4")
         calc_buoyancy_tend_4th(fields->wt->data, fields->sp["th"]->data, threfh);
 }
 #endif
 
+void Thermo_dry::exec_block(const int kb, const int ke)
+{
+    calc_buoyancy_tend_2nd(fields->wt->data, fields->sp["th"]->data, threfh, kb, ke);
+}
+
 unsigned long Thermo_dry::get_time_limit(unsigned long idt, const double dt)
 {
     return Constants::ulhuge;
 }
 
-void Thermo_dry::exec_stats(Mask *m)
+void Thermo_dry::exec_stats()
 {
     const double NoOffset = 0.;
 
@@ -181,35 +186,23 @@ void Thermo_dry::exec_stats(Mask *m)
     const int sloc[] = {0,0,0};
 
     // calculate the mean
-    stats->calc_mean(m->profs["b"].data, fields->atmp["tmp1"]->data, NoOffset, sloc,
-                     fields->atmp["tmp3"]->data, stats->nmask);
+    stats->calc_mean("b", fields->atmp["tmp1"]->data, NoOffset, sloc);
 
     // calculate the moments
-    for (int n=2; n<5; ++n)
-    {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(fields->atmp["tmp1"]->data, m->profs["b"].data, m->profs["b"+sn].data, n, sloc,
-                           fields->atmp["tmp3"]->data, stats->nmask);
-    }
+    stats->calc_moments(fields->atmp["tmp1"]->data, "b", "b", sloc);
 
     // calculate the gradients
     if (grid->swspatialorder == "2")
-        stats->calc_grad_2nd(fields->atmp["tmp1"]->data, m->profs["bgrad"].data, grid->dzhi, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_grad_2nd(fields->atmp["tmp1"]->data, "bgrad", grid->dzhi, sloc);
     else if (grid->swspatialorder == "4")
-        stats->calc_grad_4th(fields->atmp["tmp1"]->data, m->profs["bgrad"].data, grid->dzhi4, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_grad_4th(fields->atmp["tmp1"]->data, "bgrad", grid->dzhi4, sloc);
 
     // calculate turbulent fluxes
     if (grid->swspatialorder == "2")
-        stats->calc_flux_2nd(fields->atmp["tmp1"]->data, m->profs["b"].data, fields->w->data, m->profs["w"].data,
-                             m->profs["bw"].data, fields->atmp["tmp2"]->data, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_flux_2nd(fields->atmp["tmp1"]->data, "b", fields->w->data, "w",
+                             "bw", fields->atmp["tmp2"]->data, sloc);
     else if (grid->swspatialorder == "4")
-        stats->calc_flux_4th(fields->atmp["tmp1"]->data, fields->w->data, m->profs["bw"].data, fields->atmp["tmp2"]->data, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_flux_4th(fields->atmp["tmp1"]->data, fields->w->data, "bw", fields->atmp["tmp2"]->data, sloc);
 
     // calculate diffusive fluxes
     if (grid->swspatialorder == "2")
@@ -218,22 +211,19 @@ void Thermo_dry::exec_stats(Mask *m)
         {
             Diff_smag_2* diffptr = static_cast<Diff_smag_2*>(model->diff);
             stats->calc_diff_2nd(fields->atmp["tmp1"]->data, fields->w->data, fields->sd["evisc"]->data,
-                                 m->profs["bdiff"].data, grid->dzhi,
-                                 fields->atmp["tmp1"]->datafluxbot, fields->atmp["tmp1"]->datafluxtop, diffptr->tPr, sloc,
-                                 fields->atmp["tmp4"]->data, stats->nmaskh);
+                                 "bdiff", grid->dzhi,
+                                 fields->atmp["tmp1"]->datafluxbot, fields->atmp["tmp1"]->datafluxtop, diffptr->tPr, sloc);
         }
         else
-            stats->calc_diff_2nd(fields->atmp["tmp1"]->data, m->profs["bdiff"].data, grid->dzhi, fields->sp["th"]->visc, sloc,
-                                 fields->atmp["tmp4"]->data, stats->nmaskh);
+            stats->calc_diff_2nd(fields->atmp["tmp1"]->data, "bdiff", grid->dzhi, fields->sp["th"]->visc, sloc);
     }
     else if (grid->swspatialorder == "4")
     {
-        stats->calc_diff_4th(fields->atmp["tmp1"]->data, m->profs["bdiff"].data, grid->dzhi4, fields->sp["th"]->visc, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_diff_4th(fields->atmp["tmp1"]->data, "bdiff", grid->dzhi4, fields->sp["th"]->visc, sloc);
     }
 
     // calculate the total fluxes
-    stats->add_fluxes(m->profs["bflux"].data, m->profs["bw"].data, m->profs["bdiff"].data);
+    stats->add_fluxes("bflux", "bw", "bdiff");
 
     // calculate the sorted buoyancy profile
     //stats->calc_sorted_prof(fields->sd["tmp1"]->data, fields->sd["tmp2"]->data, m->profs["bsort"].data);
@@ -408,14 +398,15 @@ void Thermo_dry::calc_buoyancy_fluxbot(double* restrict bfluxbot, double* restri
         }
 }
 
-void Thermo_dry::calc_buoyancy_tend_2nd(double* restrict wt, double* restrict th, double* restrict threfh)
+void Thermo_dry::calc_buoyancy_tend_2nd(double* restrict wt, double* restrict th, double* restrict threfh,
+                                        const int kb, const int ke)
 {
     using namespace Finite_difference::O2;
 
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    for (int k=grid->kstart+1; k<grid->kend; ++k)
+    for (int k=std::max(kb, grid->kstart+1); k<ke; ++k)
         for (int j=grid->jstart; j<grid->jend; ++j)
 #pragma ivdep
             for (int i=grid->istart; i<grid->iend; ++i)
@@ -413,14 +413,15 @@ void Thermo_moist::exec()
         cudaMemcpy(fields->sp["thl"]->datamean, fields->sp["thl"]->datamean_g, grid->kcells*sizeof(double), cudaMemcpyDeviceToHost);
         cudaMemcpy(fields->sp["qt"]->datamean,  fields->sp["qt"]->datamean_g,  grid->kcells*sizeof(double), cudaMemcpyDeviceToHost);
              
-        int kcells = grid->kcells; 
-        double *tmp2 = fields->atmp["tmp2"]->data;
-        calc_base_state(pref, prefh, &tmp2[0*kcells], &tmp2[1*kcells], &tmp2[2*kcells], &tmp2[3*kcells], exnref, exnrefh, 
-                fields->sp["thl"]->datamean, fields->sp["qt"]->datamean);
-             
-        // Only half level pressure and exner needed for BuoyancyTend()
-        cudaMemcpy(prefh_g,   prefh,   grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
-        cudaMemcpy(exnrefh_g, exnrefh, grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
+        // The base state is only updated if the mean state has changed sufficiently, in which case
+        // both the full and half level profiles are copied, as they are shared with get_thermo_field()
+        if (update_base_state())
+        {
+            cudaMemcpy(pref_g,    pref,    grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
+            cudaMemcpy(prefh_g,   prefh,   grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
+            cudaMemcpy(exnref_g,  exnref,  grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
+            cudaMemcpy(exnrefh_g, exnrefh, grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
+        }
     }
 
     if (grid->swspatialorder== "2")
@@ -476,14 +477,13 @@ void Thermo_moist::get_thermo_field(Field3d *fld, Field3d *tmp, std::string name
         cudaMemcpy(fields->sp["thl"]->datamean, fields->sp["thl"]->datamean_g, grid->kcells*sizeof(double), cudaMemcpyDeviceToHost);
         cudaMemcpy(fields->sp["qt"]->datamean,  fields->sp["qt"]->datamean_g,  grid->kcells*sizeof(double), cudaMemcpyDeviceToHost);
 
-        int kcells = grid->kcells; 
-        double *tmp2 = fields->atmp["tmp2"]->data;
-        calc_base_state(pref, prefh, &tmp2[0*kcells], &tmp2[1*kcells], &tmp2[2*kcells], &tmp2[3*kcells], exnref, exnrefh, 
-                fields->sp["thl"]->datamean, fields->sp["qt"]->datamean);
-
-        // Only full level pressure and exner needed
-        cudaMemcpy(pref_g,   pref,   grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
-        cudaMemcpy(exnref_g, exnref, grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
+        if (update_base_state())
+        {
+            cudaMemcpy(pref_g,    pref,    grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
+            cudaMemcpy(prefh_g,   prefh,   grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
+            cudaMemcpy(exnref_g,  exnref,  grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
+            cudaMemcpy(exnrefh_g, exnrefh, grid->kcells*sizeof(double), cudaMemcpyHostToDevice);
+        }
     }
 
     if (name == "b")
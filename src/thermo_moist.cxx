@@ -40,6 +40,7 @@
 #include "dump.h"
 #include "thermo_moist_functions.h"
 #include "timeloop.h"
+#include "slice_balance.h"
 
 using Finite_difference::O2::interp2;
 using Finite_difference::O4::interp4;
@@ -63,6 +64,31 @@ namespace
     const double ql_min  = 1.e-6;    // Min cloud liquid water for which calculations are performed 
     const double qr_min  = 1.e-15;   // Min rain liquid water for which calculations are performed 
 
+    // Table of the saturation vapor pressure. It starts at the lower bound of esat(), below which it
+    // is constant, and it is clamped at the upper bound, which is far above atmospheric temperatures.
+    const double esat_table_tmin = T0 - 75.;
+    const double esat_table_dt   = 0.01;
+    const int    esat_table_n    = 17501; // Up to T0 + 100 K
+    const double esat_table_tol  = 1.e-6; // Maximum relative error of the interpolation
+
+    // Saturation vapor pressure, from the table with linear interpolation or from esat() if no table is given
+    inline double esat_tab(const double* const restrict table, const double T)
+    {
+        if (table == 0)
+            return esat(T);
+
+        const double x  = std::min(std::max(0., (T - esat_table_tmin)/esat_table_dt), esat_table_n - 1.00001);
+        const int    n  = static_cast<int>(x);
+        const double fx = x - n;
+        return table[n] + fx*(table[n+1] - table[n]);
+    }
+
+    inline double qsat_tab(const double* const restrict table, const double p, const double T)
+    {
+        const double es = esat_tab(table, T);
+        return ep*es/(p-(1-ep)*es);
+    }
+
     // Rational tanh approximation  
     inline double tanh2(const double x)
     {
@@ -118,6 +144,50 @@ namespace
 // Microphysics per 2D (xz) slices
 namespace mp2d
 {
+    // Find the range of levels [kbeg, kend) of an xz-slice that contains cloud or rain water.
+    // The range is empty (kbeg >= kend) if the slice contains neither.
+    void find_active_levels(int& kbeg, int& kend,
+                            const double* const restrict qr, const double* const restrict ql,
+                            const int istart, const int iend,
+                            const int kstart, const int kendin,
+                            const int icells, const int ijcells, const int j)
+    {
+        kbeg = kendin;
+        kend = kstart;
+
+        for (int k=kstart; k<kendin; k++)
+        {
+            int nactive = 0;
+            for (int i=istart; i<iend; i++)
+            {
+                const int ijk = i + j*icells + k*ijcells;
+                nactive += (qr[ijk] > qr_min) || (ql[ijk] > ql_min);
+            }
+
+            if (nactive > 0)
+            {
+                kbeg = k;
+                break;
+            }
+        }
+
+        for (int k=kendin-1; k>=kbeg; k--)
+        {
+            int nactive = 0;
+            for (int i=istart; i<iend; i++)
+            {
+                const int ijk = i + j*icells + k*ijcells;
+                nactive += (qr[ijk] > qr_min) || (ql[ijk] > ql_min);
+            }
+
+            if (nactive > 0)
+            {
+                kend = k+1;
+                break;
+            }
+        }
+    }
+
     // Calculate microphysics properties which are used in multiple routines
     void prepare_microphysics_slice(double* const restrict rain_mass, double* const restrict rain_diameter,
                                     double* const restrict mu_r, double* const restrict lambda_r,
@@ -161,7 +231,8 @@ namespace mp2d
                      const double* const restrict rain_mass, const double* const restrict rain_diameter,
                      const int istart, const int jstart, const int kstart,
                      const int iend,   const int jend,   const int kend,
-                     const int jj, const int kk, const int j)
+                     const int jj, const int kk, const int j,
+                     const double* const restrict esat_table)
     {
         const double lambda_evap = 1.; // 1.0 in UCLA, 0.7 in DALES
 
@@ -178,9 +249,9 @@ namespace mp2d
                     const double dr  = rain_diameter[ik];
 
                     const double T   = thl[ijk] * exner[k] + (Lv * ql[ijk]) / (cp * exner[k]); // Absolute temperature [K]
-                    const double Glv = pow(Rv * T / (esat(T) * D_v) + (Lv / (K_t * T)) * (Lv / (Rv * T) - 1), -1); // Cond/evap rate (kg m-1 s-1)?
+                    const double Glv = pow(Rv * T / (esat_tab(esat_table, T) * D_v) + (Lv / (K_t * T)) * (Lv / (Rv * T) - 1), -1); // Cond/evap rate (kg m-1 s-1)?
 
-                    const double S   = (qt[ijk] - ql[ijk]) / qsat(p[k], T) - 1; // Saturation
+                    const double S   = (qt[ijk] - ql[ijk]) / qsat_tab(esat_table, p[k], T) - 1; // Saturation
                     const double F   = 1.; // Evaporation excludes ventilation term from SB06 (like UCLA, unimportant term? TODO: test)
 
                     const double ev_tend = 2. * pi * dr * Glv * S * F * nr[ijk] / rho[k];             
@@ -408,6 +479,66 @@ namespace mp2d
                 nrt[ijk] += -(flux_nr[ik+kk2d] - flux_nr[ik]) / rho[k] * dzi[k]; 
             }
     }
+
+    // Sedimentation sub-cycled in nsub steps. The slice is copied into the buffers qr_s and nr_s, which
+    // have the layout of a 3D field with a single row in the y-direction, such that the slice routines
+    // can be applied to them. The tendency is the change of the buffers over the full time step.
+    void sedimentation_ss08_subcycled(double* const restrict qrt, double* const restrict nrt,
+                                      double* const restrict qr_s, double* const restrict nr_s,
+                                      double* const restrict qrt_s, double* const restrict nrt_s,
+                                      double* const restrict rain_mass, double* const restrict rain_diam,
+                                      double* const restrict mu_r, double* const restrict lambda_r,
+                                      double* const restrict tmpxz1, double* const restrict tmpxz2,
+                                      double* const restrict tmpxz3, double* const restrict tmpxz4,
+                                      double* const restrict tmpxz5, double* const restrict tmpxz6,
+                                      const double* const restrict qr, const double* const restrict nr,
+                                      const double* const restrict rho, const double* const restrict dzi,
+                                      const double* const restrict dz, const double dt, const int nsub,
+                                      const int istart, const int iend,
+                                      const int kstart, const int kend,
+                                      const int icells, const int kcells, const int ijcells, const int j)
+    {
+        const double dtsub = dt / nsub;
+
+        for (int n=0; n<nsub; ++n)
+        {
+            for (int k=kstart; k<kend; k++)
+                #pragma ivdep
+                for (int i=istart; i<iend; i++)
+                {
+                    const int ik = i + k*icells;
+                    qrt_s[ik] = 0.;
+                    nrt_s[ik] = 0.;
+                }
+
+            prepare_microphysics_slice(rain_mass, rain_diam, mu_r, lambda_r, qr_s, nr_s, rho,
+                                       istart, iend, kstart, kend, icells, icells, 0);
+
+            sedimentation_ss08(qrt_s, nrt_s, tmpxz1, tmpxz2, tmpxz3, tmpxz4, tmpxz5, tmpxz6, mu_r, lambda_r,
+                               qr_s, nr_s, rho, dzi, dz, dtsub,
+                               istart, 0, kstart, iend, 1, kend,
+                               icells, kcells, icells, 0);
+
+            for (int k=kstart; k<kend; k++)
+                #pragma ivdep
+                for (int i=istart; i<iend; i++)
+                {
+                    const int ik = i + k*icells;
+                    qr_s[ik] += dtsub * qrt_s[ik];
+                    nr_s[ik] += dtsub * nrt_s[ik];
+                }
+        }
+
+        for (int k=kstart; k<kend; k++)
+            #pragma ivdep
+            for (int i=istart; i<iend; i++)
+            {
+                const int ijk = i + j*icells + k*ijcells;
+                const int ik  = i + k*icells;
+                qrt[ijk] += (qr_s[ik] - qr[ijk]) / dt;
+                nrt[ijk] += (nr_s[ik] - nr[ijk]) / dt;
+            }
+    }
 }
 
 namespace mp
@@ -841,6 +972,20 @@ Thermo_moist::Thermo_moist(Model* modelin, Input* inputin) : Thermo(modelin, inp
     pref    = 0;
     prefh   = 0;
 
+    sat_index = 0;
+    sat_work  = 0;
+
+    ql_cache       = 0;
+    ql_cache_pref  = 0;
+    ql_cache_valid = false;
+
+    esat_table = 0;
+
+    balance = 0;
+
+    thvmean_basestate = 0;
+    basestate_valid   = false;
+
     thvref_g  = 0;
     thvrefh_g = 0;
     exnref_g  = 0;
@@ -865,6 +1010,12 @@ Thermo_moist::Thermo_moist(Model* modelin, Input* inputin) : Thermo(modelin, inp
         nerror += inputin->get_item(&swmicrobudget, "thermo", "swmicrobudget", "", "0");
         nerror += inputin->get_item(&swmicrobudget, "thermo", "swmicrobudget", "", "0");
         nerror += inputin->get_item(&cflmax_micro,  "thermo", "cflmax_micro",  "", 2.);
+        nerror += inputin->get_item(&swmicrosubcycle, "thermo", "swmicrosubcycle", "", "0");
+
+        // Option to distribute the microphysics of the xz-slices over the processes of a node
+        nerror += inputin->get_item(&swbalance, "thermo", "swbalance", "", "0");
+        if (swbalance == "1")
+            nerror += inputin->get_item(&balanceiter, "thermo", "balanceiter", "", 10);
 
         // The microphysics requires three additional tmp fields
         const int n_tmp = 7;
@@ -914,6 +1065,30 @@ Thermo_moist::Thermo_moist(Model* modelin, Input* inputin) : Thermo(modelin, inp
     // swupdate..=1 -> base state pressure updated before saturation calculation
     nerror += inputin->get_item(&swupdatebasestate, "thermo", "swupdatebasestate", "");
 
+    // Update policy of the base state: only refresh the base state if at least basestatetime
+    // seconds have passed since the last update and the mean virtual potential temperature
+    // has changed by more than basestatetol. The defaults update it on every call.
+    if (swupdatebasestate)
+    {
+        nerror += inputin->get_item(&basestatetime, "thermo", "basestatetime", "", 0.);
+        nerror += inputin->get_item(&basestatetol,  "thermo", "basestatetol",  "", 0.);
+    }
+    else
+    {
+        basestatetime = 0.;
+        basestatetol  = 0.;
+    }
+
+    // Option to take the saturation vapor pressure from a table
+    nerror += inputin->get_item(&swesattable, "thermo", "swesattable", "", "0");
+    #ifdef USECUDA
+    if (swesattable == "1")
+    {
+        master->print_error("swesattable = \"1\" not (yet) implemented in CUDA\n");
+        throw 1;
+    }
+    #endif
+
     // Remove the data from the input that is not used, to avoid warnings.
     if (master->mode == "init")
     {
@@ -936,6 +1111,18 @@ Thermo_moist::~Thermo_moist()
     delete[] pref;
     delete[] prefh;
 
+    delete[] sat_index;
+    delete[] sat_work;
+
+    delete[] ql_cache;
+    delete[] ql_cache_pref;
+
+    delete[] esat_table;
+
+    delete balance;
+
+    delete[] thvmean_basestate;
+
     #ifdef USECUDA
     clear_device();
     #endif
@@ -966,10 +1153,55 @@ void Thermo_moist::init()
         prefh  [k] = 0.;
     }
 
+    sat_index = new int[grid->ijcells];
+    sat_work  = new double[5*grid->ijcells];
+
+    ql_cache      = new double[grid->ncells];
+    ql_cache_pref = new double[grid->kcells];
+
+    thvmean_basestate = new double[grid->kcells];
+
+    for (int n=0; n<grid->ncells; ++n)
+        ql_cache[n] = 0.;
+
+    if (swesattable == "1")
+        init_esat_table();
+
+    // The four microphysics tendencies are returned, after the five fields that are required as input
+    if (swmicro == "2mom_warm" && swbalance == "1")
+    {
+        balance = new Slice_balance(master, grid);
+        balance->init(9, 4);
+    }
+
     init_cross();
     init_dump();
 }
 
+void Thermo_moist::init_esat_table()
+{
+    esat_table = new double[esat_table_n];
+
+    for (int n=0; n<esat_table_n; ++n)
+        esat_table[n] = esat(esat_table_tmin + n*esat_table_dt);
+
+    // Check the interpolation error in between the table points against the analytic function
+    const int nsub = 10;
+    double errmax = 0.;
+    for (int n=0; n<(esat_table_n-1)*nsub; ++n)
+    {
+        const double T = esat_table_tmin + n*esat_table_dt/nsub;
+        const double es = esat(T);
+        errmax = std::max(errmax, std::abs(esat_tab(esat_table, T) - es) / es);
+    }
+
+    if (errmax > esat_table_tol)
+    {
+        master->print_error("Relative error of the esat table of %E exceeds %E\n", errmax, esat_table_tol);
+        throw 1;
+    }
+}
+
 void Thermo_moist::create(Input* inputin)
 {
     const int kstart = grid->kstart;
@@ -1023,22 +1255,29 @@ void Thermo_moist::create(Input* inputin)
 #ifndef USECUDA
 void Thermo_moist::exec()
 {
-    const int kk = grid->ijcells;
-    const int kcells = grid->kcells;
+    prepare_block_sweep();
+    exec_block(grid->kstart, grid->kend);
+    finish_block_sweep();
+}
+#endif
 
-    // Re-calculate hydrostatic pressure and exner, pass dummy as rhoref,thvref to prevent overwriting base state
-    double *tmp2 = fields->atmp["tmp2"]->data;
+void Thermo_moist::prepare_block_sweep()
+{
+    // Re-calculate hydrostatic pressure and exner if the mean state has changed sufficiently
     if (swupdatebasestate)
-        calc_base_state(pref, prefh,
-                        &tmp2[0*kcells], &tmp2[1*kcells], &tmp2[2*kcells], &tmp2[3*kcells],
-                        exnref, exnrefh, fields->sp[thvar]->datamean, fields->sp["qt"]->datamean);
+        update_base_state();
+}
+
+void Thermo_moist::exec_block(const int kb, const int ke)
+{
+    const int kk = grid->ijcells;
 
     // extend later for gravity vector not normal to surface
     if (grid->swspatialorder == "2")
     {
         calc_buoyancy_tend_2nd(fields->wt->data, fields->sp[thvar]->data, fields->sp["qt"]->data, prefh,
                                &fields->atmp["tmp2"]->data[0*kk], &fields->atmp["tmp2"]->data[1*kk],
-                               &fields->atmp["tmp2"]->data[2*kk], thvrefh);
+                               &fields->atmp["tmp2"]->data[2*kk], thvrefh, kb, ke);
     }
     //else if (grid->swspatialorder == "4")
     //{
@@ -1047,16 +1286,19 @@ void Thermo_moist::exec()
     //                           &fields->atmp["tmp2"]->data[2*kk],
     //                           thvrefh);
     //}
+}
 
+void Thermo_moist::finish_block_sweep()
+{
     // 2-moment warm microphysics 
     if(swmicro == "2mom_warm")
         exec_microphysics();
 }
-#endif
 
 unsigned long Thermo_moist::get_time_limit(unsigned long idt, const double dt)
 {
-    if(swmicro == "2mom_warm")
+    // With sub-cycling, the sedimentation takes its own sub-steps and does not limit the time step
+    if(swmicro == "2mom_warm" && swmicrosubcycle != "1")
     {
         double cfl = mp::calc_max_sedimentation_cfl(fields->atmp["tmp1"]->data, fields->sp["qr"]->data, fields->sp["nr"]->data,
                                                     fields->rhoref, grid->dzi, dt,
@@ -1082,78 +1324,77 @@ void Thermo_moist::exec_microphysics()
     mp::remove_neg_values(fields->sp["qr"]->data, grid->istart, grid->jstart, grid->kstart, grid->iend, grid->jend, grid->kend, grid->icells, grid->ijcells);
     mp::remove_neg_values(fields->sp["nr"]->data, grid->istart, grid->jstart, grid->kstart, grid->iend, grid->jend, grid->kend, grid->icells, grid->ijcells);
 
-    // Calculate the cloud liquid water concent using the saturation adjustment method
-    calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp["thl"]->data, fields->sp["qt"]->data, pref);
+    // Get the cloud liquid water concent, calculated using the saturation adjustment method
+    double* ql = get_liquid_water();
 
     const double dt = model->timeloop->get_dt();
 
-    // xz tmp slices for quantities which are used by multiple microphysics routines
-    const int ikslice = grid->icells * grid->kcells;
-    double* rain_mass = &fields->atmp["tmp2"]->data[0*ikslice]; 
-    double* rain_diam = &fields->atmp["tmp2"]->data[1*ikslice]; 
-    double* mu_r      = &fields->atmp["tmp2"]->data[2*ikslice]; 
-    double* lambda_r  = &fields->atmp["tmp3"]->data[0*ikslice]; 
-
-    // xz tmp slices for intermediate calculations
-    double* tmpxz1    = &fields->atmp["tmp3"]->data[1*ikslice];
-    double* tmpxz2    = &fields->atmp["tmp3"]->data[2*ikslice];
-    double* tmpxz3    = &fields->atmp["tmp4"]->data[0*ikslice];
-    double* tmpxz4    = &fields->atmp["tmp4"]->data[1*ikslice];
-    double* tmpxz5    = &fields->atmp["tmp4"]->data[2*ikslice];
-    double* tmpxz6    = &fields->atmp["tmp5"]->data[0*ikslice];
+    if(per_slice)
+    {
+        // The tendencies that are computed by the microphysics, followed by the fields that are needed as input
+        double* const slicefields[] = {fields->st["qr"]->data, fields->st["nr"]->data, fields->st["qt"]->data, fields->st["thl"]->data,
+                                       fields->sp["qr"]->data, fields->sp["nr"]->data, fields->sp["qt"]->data, fields->sp["thl"]->data, ql};
 
-    // Autoconversion; formation of rain drop by coagulating cloud droplets
-    mp::autoconversion(fields->st["qr"]->data, fields->st["nr"]->data, fields->st["qt"]->data, fields->st["thl"]->data,
-                       fields->sp["qr"]->data, fields->atmp["tmp1"]->data, fields->rhoref, exnref,
-                       grid->istart, grid->jstart, grid->kstart, 
-                       grid->iend,   grid->jend,   grid->kend, 
-                       grid->icells, grid->ijcells);
+        // Update the distribution of the slices over the processes from the measured cost
+        if (balance && model->timeloop->get_substep() == 0 && model->timeloop->get_iteration() % balanceiter == 0)
+            balance->update_plan();
 
-    // Accretion; growth of raindrops collecting cloud droplets
-    mp::accretion(fields->st["qr"]->data, fields->st["qt"]->data, fields->st["thl"]->data,
-                  fields->sp["qr"]->data, fields->atmp["tmp1"]->data, fields->rhoref, exnref,
-                  grid->istart, grid->jstart, grid->kstart, 
-                  grid->iend,   grid->jend,   grid->kend, 
-                  grid->icells, grid->ijcells);
+        // Send the slices that are computed by other processes, and compute the local slices in the meantime
+        if (balance)
+            balance->send_slices(slicefields);
 
-    if(per_slice)
-    {
         for (int j=grid->jstart; j<grid->jend; ++j)
         {
-            mp2d::prepare_microphysics_slice(rain_mass, rain_diam, mu_r, lambda_r, fields->sp["qr"]->data, fields->sp["nr"]->data, fields->rhoref,
-                                             grid->istart, grid->iend, grid->kstart, grid->kend, grid->icells, grid->ijcells, j);
-
-            // Evaporation; evaporation of rain drops in unsaturated environment
-            mp2d::evaporation(fields->st["qr"]->data, fields->st["nr"]->data,  fields->st["qt"]->data, fields->st["thl"]->data,
-                              fields->sp["qr"]->data, fields->sp["nr"]->data,  fields->atmp["tmp1"]->data,
-                              fields->sp["qt"]->data, fields->sp["thl"]->data, fields->rhoref, exnref, pref,
-                              rain_mass, rain_diam,
-                              grid->istart, grid->jstart, grid->kstart, 
-                              grid->iend,   grid->jend,   grid->kend, 
-                              grid->icells, grid->ijcells, j);
-
-            // Self collection and breakup; growth of raindrops by mutual (rain-rain) coagulation, and breakup by collisions
-            mp2d::selfcollection_breakup(fields->st["nr"]->data, fields->sp["qr"]->data, fields->sp["nr"]->data, fields->rhoref,
-                                         rain_mass, rain_diam, lambda_r,
-                                         grid->istart, grid->jstart, grid->kstart, 
-                                         grid->iend,   grid->jend,   grid->kend, 
-                                         grid->icells, grid->ijcells, j);
-
-            // Sedimentation; sub-grid sedimentation of rain 
-            mp2d::sedimentation_ss08(fields->st["qr"]->data, fields->st["nr"]->data, 
-                                     tmpxz1, tmpxz2, tmpxz3, tmpxz4, tmpxz5, tmpxz6, mu_r, lambda_r,
-                                     fields->sp["qr"]->data, fields->sp["nr"]->data, 
-                                     fields->rhoref, grid->dzi, grid->dz, dt,
-                                     grid->istart, grid->jstart, grid->kstart, 
-                                     grid->iend,   grid->jend,   grid->kend, 
-                                     grid->icells, grid->kcells, grid->ijcells, j);
+            if (balance && balance->is_exported(j))
+                continue;
+
+            const double t0 = master->get_wall_clock_time();
+            exec_microphysics_slice(slicefields[0], slicefields[1], slicefields[2], slicefields[3],
+                                    slicefields[4], slicefields[5], slicefields[6], slicefields[7], slicefields[8],
+                                    j, grid->ijcells, dt);
+            if (balance)
+                balance->add_cost(j, master->get_wall_clock_time() - t0);
+        }
+
+        if (balance)
+        {
+            // Compute the slices of other processes; these consist of a single xz-slice per field
+            balance->wait_imported();
+            for (int n=0; n<balance->get_nimported(); ++n)
+            {
+                const double t0 = master->get_wall_clock_time();
+                exec_microphysics_slice(balance->get_imported_field(n, 0), balance->get_imported_field(n, 1),
+                                        balance->get_imported_field(n, 2), balance->get_imported_field(n, 3),
+                                        balance->get_imported_field(n, 4), balance->get_imported_field(n, 5),
+                                        balance->get_imported_field(n, 6), balance->get_imported_field(n, 7),
+                                        balance->get_imported_field(n, 8),
+                                        0, grid->icells, dt);
+                balance->set_imported_cost(n, master->get_wall_clock_time() - t0);
+            }
+
+            balance->return_slices();
+            balance->receive_slices(slicefields);
         }
     }
     else
     {
+        // Autoconversion; formation of rain drop by coagulating cloud droplets
+        mp::autoconversion(fields->st["qr"]->data, fields->st["nr"]->data, fields->st["qt"]->data, fields->st["thl"]->data,
+                           fields->sp["qr"]->data, ql, fields->rhoref, exnref,
+                           grid->istart, grid->jstart, grid->kstart, 
+                           grid->iend,   grid->jend,   grid->kend, 
+                           grid->icells, grid->ijcells);
+
+        // Accretion; growth of raindrops collecting cloud droplets
+        mp::accretion(fields->st["qr"]->data, fields->st["qt"]->data, fields->st["thl"]->data,
+                      fields->sp["qr"]->data, ql, fields->rhoref, exnref,
+                      grid->istart, grid->jstart, grid->kstart, 
+                      grid->iend,   grid->jend,   grid->kend, 
+                      grid->icells, grid->ijcells);
+
         // Evaporation; evaporation of rain drops in unsaturated environment
         mp::evaporation(fields->st["qr"]->data, fields->st["nr"]->data,  fields->st["qt"]->data, fields->st["thl"]->data,
-                        fields->sp["qr"]->data, fields->sp["nr"]->data,  fields->atmp["tmp1"]->data,
+                        fields->sp["qr"]->data, fields->sp["nr"]->data,  ql,
                         fields->sp["qt"]->data, fields->sp["thl"]->data, fields->rhoref, exnref, pref,
                         grid->istart, grid->jstart, grid->kstart, 
                         grid->iend,   grid->jend,   grid->kend, 
@@ -1176,29 +1417,149 @@ void Thermo_moist::exec_microphysics()
     }
 }
 
-void Thermo_moist::get_mask(Field3d *mfield, Field3d *mfieldh, Mask *m)
+void Thermo_moist::exec_microphysics_slice(double* const restrict qrt, double* const restrict nrt,
+                                           double* const restrict qtt, double* const restrict thlt,
+                                           double* const restrict qr,  double* const restrict nr,
+                                           double* const restrict qt,  double* const restrict thl,
+                                           double* const restrict ql,
+                                           const int j, const int kk, const double dt)
 {
+    // xz tmp slices for quantities which are used by multiple microphysics routines
+    const int ikslice = grid->icells * grid->kcells;
+    double* rain_mass = &fields->atmp["tmp2"]->data[0*ikslice]; 
+    double* rain_diam = &fields->atmp["tmp2"]->data[1*ikslice]; 
+    double* mu_r      = &fields->atmp["tmp2"]->data[2*ikslice]; 
+    double* lambda_r  = &fields->atmp["tmp3"]->data[0*ikslice]; 
+
+    // xz tmp slices for intermediate calculations
+    double* tmpxz1    = &fields->atmp["tmp3"]->data[1*ikslice];
+    double* tmpxz2    = &fields->atmp["tmp3"]->data[2*ikslice];
+    double* tmpxz3    = &fields->atmp["tmp4"]->data[0*ikslice];
+    double* tmpxz4    = &fields->atmp["tmp4"]->data[1*ikslice];
+    double* tmpxz5    = &fields->atmp["tmp4"]->data[2*ikslice];
+    double* tmpxz6    = &fields->atmp["tmp5"]->data[0*ikslice];
+
+    // xz tmp slices for the sub-cycling of the sedimentation
+    double* qr_s      = &fields->atmp["tmp6"]->data[0*ikslice];
+    double* nr_s      = &fields->atmp["tmp6"]->data[1*ikslice];
+    double* qrt_s     = &fields->atmp["tmp6"]->data[2*ikslice];
+    double* nrt_s     = &fields->atmp["tmp7"]->data[0*ikslice];
+
+    // Restrict the calculations to the levels of the slice that contain cloud or rain water. All
+    // processes are zero outside of these levels, except for the sedimentation, in which rain falls
+    // two levels below the lowest level with rain, and which needs one level above the highest level
+    // to find that the flux is zero. With this range, the results are identical to a full slice.
+    int kbeg, kend;
+    mp2d::find_active_levels(kbeg, kend, qr, ql,
+                             grid->istart, grid->iend, grid->kstart, grid->kend, grid->icells, kk, j);
+
+    if (kbeg >= kend)
+        return;
+
+    kbeg = std::max(grid->kstart, kbeg-2);
+    kend = std::min(grid->kend, kend+1);
+
+    // Autoconversion; formation of rain drop by coagulating cloud droplets
+    mp::autoconversion(qrt, nrt, qtt, thlt,
+                       qr, ql, fields->rhoref, exnref,
+                       grid->istart, j,   kbeg, 
+                       grid->iend,   j+1, kend, 
+                       grid->icells, kk);
+
+    // Accretion; growth of raindrops collecting cloud droplets
+    mp::accretion(qrt, qtt, thlt,
+                  qr, ql, fields->rhoref, exnref,
+                  grid->istart, j,   kbeg, 
+                  grid->iend,   j+1, kend, 
+                  grid->icells, kk);
+
+    mp2d::prepare_microphysics_slice(rain_mass, rain_diam, mu_r, lambda_r, qr, nr, fields->rhoref,
+                                     grid->istart, grid->iend, kbeg, kend, grid->icells, kk, j);
+
+    // Evaporation; evaporation of rain drops in unsaturated environment
+    mp2d::evaporation(qrt, nrt,  qtt, thlt,
+                      qr, nr,  ql,
+                      qt, thl, fields->rhoref, exnref, pref,
+                      rain_mass, rain_diam,
+                      grid->istart, grid->jstart, kbeg, 
+                      grid->iend,   grid->jend,   kend, 
+                      grid->icells, kk, j, esat_table);
+
+    // Self collection and breakup; growth of raindrops by mutual (rain-rain) coagulation, and breakup by collisions
+    mp2d::selfcollection_breakup(nrt, qr, nr, fields->rhoref,
+                                 rain_mass, rain_diam, lambda_r,
+                                 grid->istart, grid->jstart, kbeg, 
+                                 grid->iend,   grid->jend,   kend, 
+                                 grid->icells, kk, j);
+
+    // Number of sub-steps of the sedimentation, based on the sedimentation CFL number of the slice
+    int nsub = 1;
+    if (swmicrosubcycle == "1")
+    {
+        // Copy the slice including the ghost levels into the buffers
+        for (int k=grid->kstart-1; k<grid->kend+1; k++)
+            #pragma ivdep
+            for (int i=grid->istart; i<grid->iend; i++)
+            {
+                const int ijk = i + j*grid->icells + k*kk;
+                const int ik  = i + k*grid->icells;
+                qr_s  [ik] = qr[ijk];
+                nr_s  [ik] = nr[ijk];
+                tmpxz1[ik] = 0.;
+            }
+
+        const double cfl = mp::calc_max_sedimentation_cfl(tmpxz1, qr_s, nr_s, fields->rhoref, grid->dzi, dt,
+                                                          grid->istart, 0, grid->kstart,
+                                                          grid->iend,   1, grid->kend,
+                                                          grid->icells, grid->icells);
+        nsub = static_cast<int>(std::ceil(cfl / cflmax_micro));
+    }
+
+    // Sedimentation; sub-grid sedimentation of rain 
+    if (nsub > 1)
+        mp2d::sedimentation_ss08_subcycled(qrt, nrt,
+                                           qr_s, nr_s, qrt_s, nrt_s, rain_mass, rain_diam, mu_r, lambda_r,
+                                           tmpxz1, tmpxz2, tmpxz3, tmpxz4, tmpxz5, tmpxz6,
+                                           qr, nr,
+                                           fields->rhoref, grid->dzi, grid->dz, dt, nsub,
+                                           grid->istart, grid->iend, grid->kstart, grid->kend,
+                                           grid->icells, grid->kcells, kk, j);
+    else
+        mp2d::sedimentation_ss08(qrt, nrt, 
+                                 tmpxz1, tmpxz2, tmpxz3, tmpxz4, tmpxz5, tmpxz6, mu_r, lambda_r,
+                                 qr, nr, 
+                                 fields->rhoref, grid->dzi, grid->dz, dt,
+                                 grid->istart, grid->jstart, kbeg, 
+                                 grid->iend,   grid->jend,   kend, 
+                                 grid->icells, grid->kcells, kk, j);
+}
+
+void Thermo_moist::get_mask(Mask *m)
+{
+    // The masks are also set in the ghost cells, thus the ghost cells of the fields are filled first.
     if (m->name == "ql")
     {
-        calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
-        calc_mask_ql(mfield->data, mfieldh->data, mfieldh->databot,
-                     stats->nmask, stats->nmaskh, &stats->nmaskbot,
+        copy_liquid_water(fields->atmp["tmp1"]->data);
+        grid->boundary_cyclic(fields->atmp["tmp1"]->data);
+
+        calc_mask_ql(m->mfield, m->mfieldh, m->mfieldbot,
                      fields->atmp["tmp1"]->data);
     }
     else if (m->name == "qlcore")
     {
-        calc_buoyancy(fields->atmp["tmp2"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp1"]->data,thvref);
+        calc_buoyancy(fields->atmp["tmp2"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp1"]->data, thvref, get_liquid_water());
         grid->calc_mean(fields->atmp["tmp2"]->datamean, fields->atmp["tmp2"]->data, grid->kcells);
+        grid->boundary_cyclic(fields->atmp["tmp2"]->data);
+
+        copy_liquid_water(fields->atmp["tmp1"]->data);
+        grid->boundary_cyclic(fields->atmp["tmp1"]->data);
 
-        calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
-        calc_mask_qlcore(mfield->data, mfieldh->data, mfieldh->databot,
-                         stats->nmask, stats->nmaskh, &stats->nmaskbot,
+        calc_mask_qlcore(m->mfield, m->mfieldh, m->mfieldbot,
                          fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data, fields->atmp["tmp2"]->datamean);
     }
 }
 
-void Thermo_moist::calc_mask_ql(double* restrict mask, double* restrict maskh, double* restrict maskbot,
-                                int* restrict nmask, int* restrict nmaskh, int* restrict nmaskbot,
+void Thermo_moist::calc_mask_ql(uint64_t* restrict mask, uint64_t* restrict maskh, uint64_t* restrict maskbot,
                                 double* restrict ql)
 {
     const int jj = grid->icells;
@@ -1206,60 +1567,34 @@ void Thermo_moist::calc_mask_ql(double* restrict mask, double* restrict maskh, d
     const int kstart = grid->kstart;
 
     for (int k=grid->kstart; k<grid->kend; k++)
-    {
-        nmask[k] = 0;
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+        for (int j=0; j<grid->jcells; j++)
+            for (int i=0; i<grid->icells; i++)
             {
                 const int ijk = i + j*jj + k*kk;
-                const int ntmp = ql[ijk] > 0.;
-                nmask[k] += ntmp;
-                mask[ijk] = (double)ntmp;
+                if (ql[ijk] > 0.)
+                    stats->set_mask_bit(mask, i, j, k);
             }
-    }
 
     for (int k=grid->kstart; k<grid->kend+1; k++)
-    {
-        nmaskh[k] = 0;
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+        for (int j=0; j<grid->jcells; j++)
+            for (int i=0; i<grid->icells; i++)
             {
                 const int ijk = i + j*jj + k*kk;
-                const int ntmp = (ql[ijk-kk] + ql[ijk]) > 0.;
-
-                nmaskh[k] += ntmp;
-                maskh[ijk] = (double)ntmp;
+                if ((ql[ijk-kk] + ql[ijk]) > 0.)
+                    stats->set_mask_bit(maskh, i, j, k);
             }
-    }
 
     // Set the mask for surface projected quantities
     // In this case: ql at surface
-    for (int j=grid->jstart; j<grid->jend; j++)
-        #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
+    for (int j=0; j<grid->jcells; j++)
+        for (int i=0; i<grid->icells; i++)
         {
-            const int ij  = i + j*jj;
-            const int ijk = i + j*jj + kstart*kk;
-            maskbot[ij] = maskh[ijk];
+            if (stats->get_mask_bit(maskh, i, j, kstart))
+                stats->set_mask_bit(maskbot, i, j, 0);
         }
-
-    grid->boundary_cyclic(mask);
-    grid->boundary_cyclic(maskh);
-    grid->boundary_cyclic_2d(maskbot);
-
-    master->sum(nmask , grid->kcells);
-    master->sum(nmaskh, grid->kcells);
-    *nmaskbot = nmaskh[grid->kstart];
-
-    // BvS: should no longer be necessary now that the ql ghost cells are set to zero
-    //nmaskh[kstart] = 0;
-    //nmaskh[kend  ] = 0;
 }
 
-void Thermo_moist::calc_mask_qlcore(double* restrict mask, double* restrict maskh, double* restrict maskbot,
-                                    int* restrict nmask, int* restrict nmaskh, int* restrict nmaskbot,
+void Thermo_moist::calc_mask_qlcore(uint64_t* restrict mask, uint64_t* restrict maskh, uint64_t* restrict maskbot,
                                     double* restrict ql, double* restrict b, double* restrict bmean)
 {
     const int jj = grid->icells;
@@ -1267,94 +1602,62 @@ void Thermo_moist::calc_mask_qlcore(double* restrict mask, double* restrict mask
     const int kstart = grid->kstart;
 
     for (int k=grid->kstart; k<grid->kend; k++)
-    {
-        nmask[k] = 0;
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+        for (int j=0; j<grid->jcells; j++)
+            for (int i=0; i<grid->icells; i++)
             {
                 const int ijk = i + j*jj + k*kk;
-                const int ntmp = (ql[ijk] > 0.)*(b[ijk]-bmean[k] > 0.);
-                nmask[k] += ntmp;
-                mask[ijk] = (double)ntmp;
+                if ((ql[ijk] > 0.) && (b[ijk]-bmean[k] > 0.))
+                    stats->set_mask_bit(mask, i, j, k);
             }
-    }
 
     for (int k=grid->kstart; k<grid->kend+1; k++)
-    {
-        nmaskh[k] = 0;
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
+        for (int j=0; j<grid->jcells; j++)
+            for (int i=0; i<grid->icells; i++)
             {
                 const int ijk = i + j*jj + k*kk;
-                const int ntmp = (ql[ijk-kk]+ql[ijk] > 0.)*(b[ijk-kk]+b[ijk]-bmean[k-1]-bmean[k] > 0.);
-                nmaskh[k] += ntmp;
-                maskh[ijk] = (double)ntmp;
+                if ((ql[ijk-kk]+ql[ijk] > 0.) && (b[ijk-kk]+b[ijk]-bmean[k-1]-bmean[k] > 0.))
+                    stats->set_mask_bit(maskh, i, j, k);
             }
-    }
 
     // Set the mask for surface projected quantities
     // In this case: qlcore at surface
-    for (int j=grid->jstart; j<grid->jend; j++)
-        #pragma ivdep
-        for (int i=grid->istart; i<grid->iend; i++)
+    for (int j=0; j<grid->jcells; j++)
+        for (int i=0; i<grid->icells; i++)
         {
-            const int ij  = i + j*jj;
-            const int ijk = i + j*jj + kstart*kk;
-            maskbot[ij] = maskh[ijk];
+            if (stats->get_mask_bit(maskh, i, j, kstart))
+                stats->set_mask_bit(maskbot, i, j, 0);
         }
-
-    grid->boundary_cyclic(mask);
-    grid->boundary_cyclic(maskh);
-    grid->boundary_cyclic_2d(maskbot);
-
-    master->sum(nmask , grid->kcells);
-    master->sum(nmaskh, grid->kcells);
-    *nmaskbot = nmaskh[grid->kstart];
 }
 
-void Thermo_moist::exec_stats(Mask *m)
+void Thermo_moist::exec_stats()
 {
     const double NoOffset = 0.;
 
     // calc the buoyancy and its surface flux for the profiles
-    calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp2"]->data, thvref);
+    calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp2"]->data, thvref, get_liquid_water());
     calc_buoyancy_fluxbot(fields->atmp["tmp1"]->datafluxbot, fields->sp[thvar]->databot, fields->sp[thvar]->datafluxbot, fields->sp["qt"]->databot, fields->sp["qt"]->datafluxbot, thvrefh);
 
     // define location
     const int sloc[] = {0,0,0};
 
     // mean
-    stats->calc_mean(m->profs["b"].data, fields->atmp["tmp1"]->data, NoOffset, sloc,
-                     fields->atmp["tmp3"]->data, stats->nmask);
+    stats->calc_mean("b", fields->atmp["tmp1"]->data, NoOffset, sloc);
 
     // moments
-    for (int n=2; n<5; ++n)
-    {
-        std::stringstream ss;
-        ss << n;
-        std::string sn = ss.str();
-        stats->calc_moment(fields->atmp["tmp1"]->data, m->profs["b"].data, m->profs["b"+sn].data, n, sloc,
-                           fields->atmp["tmp3"]->data, stats->nmask);
-    }
+    stats->calc_moments(fields->atmp["tmp1"]->data, "b", "b", sloc);
 
     // calculate the gradients
     if (grid->swspatialorder == "2")
-        stats->calc_grad_2nd(fields->atmp["tmp1"]->data, m->profs["bgrad"].data, grid->dzhi, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_grad_2nd(fields->atmp["tmp1"]->data, "bgrad", grid->dzhi, sloc);
     else if (grid->swspatialorder == "4")
-        stats->calc_grad_4th(fields->atmp["tmp1"]->data, m->profs["bgrad"].data, grid->dzhi4, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_grad_4th(fields->atmp["tmp1"]->data, "bgrad", grid->dzhi4, sloc);
 
     // calculate turbulent fluxes
     if (grid->swspatialorder == "2")
-        stats->calc_flux_2nd(fields->atmp["tmp1"]->data, m->profs["b"].data, fields->w->data, m->profs["w"].data,
-                             m->profs["bw"].data, fields->atmp["tmp2"]->data, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_flux_2nd(fields->atmp["tmp1"]->data, "b", fields->w->data, "w",
+                             "bw", fields->atmp["tmp2"]->data, sloc);
     else if (grid->swspatialorder == "4")
-        stats->calc_flux_4th(fields->atmp["tmp1"]->data, fields->w->data, m->profs["bw"].data, fields->atmp["tmp2"]->data, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_flux_4th(fields->atmp["tmp1"]->data, fields->w->data, "bw", fields->atmp["tmp2"]->data, sloc);
 
     // calculate diffusive fluxes
     if (grid->swspatialorder == "2")
@@ -1363,39 +1666,35 @@ void Thermo_moist::exec_stats(Mask *m)
         {
             Diff_smag_2 *diffptr = static_cast<Diff_smag_2 *>(model->diff);
             stats->calc_diff_2nd(fields->atmp["tmp1"]->data, fields->w->data, fields->sd["evisc"]->data,
-                                 m->profs["bdiff"].data, grid->dzhi,
-                                 fields->atmp["tmp1"]->datafluxbot, fields->atmp["tmp1"]->datafluxtop, diffptr->tPr, sloc,
-                                 fields->atmp["tmp4"]->data, stats->nmaskh);
+                                 "bdiff", grid->dzhi,
+                                 fields->atmp["tmp1"]->datafluxbot, fields->atmp["tmp1"]->datafluxtop, diffptr->tPr, sloc);
         }
         else
         {
-            stats->calc_diff_2nd(fields->atmp["tmp1"]->data, m->profs["bdiff"].data, grid->dzhi, fields->sp[thvar]->visc, sloc,
-                                 fields->atmp["tmp4"]->data, stats->nmaskh);
+            stats->calc_diff_2nd(fields->atmp["tmp1"]->data, "bdiff", grid->dzhi, fields->sp[thvar]->visc, sloc);
         }
     }
     else if (grid->swspatialorder == "4")
     {
         // take the diffusivity of temperature for that of buoyancy
-        stats->calc_diff_4th(fields->atmp["tmp1"]->data, m->profs["bdiff"].data, grid->dzhi4, fields->sp[thvar]->visc, sloc,
-                             fields->atmp["tmp4"]->data, stats->nmaskh);
+        stats->calc_diff_4th(fields->atmp["tmp1"]->data, "bdiff", grid->dzhi4, fields->sp[thvar]->visc, sloc);
     }
 
     // calculate the total fluxes
-    stats->add_fluxes(m->profs["bflux"].data, m->profs["bw"].data, m->profs["bdiff"].data);
+    stats->add_fluxes("bflux", "bw", "bdiff");
 
     // calculate the liquid water stats
-    calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
-    stats->calc_mean(m->profs["ql"].data, fields->atmp["tmp1"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-    stats->calc_count(fields->atmp["tmp1"]->data, m->profs["cfrac"].data, 0.,
-                      fields->atmp["tmp3"]->data, stats->nmask);
+    copy_liquid_water(fields->atmp["tmp1"]->data);
+    stats->calc_mean("ql", fields->atmp["tmp1"]->data, NoOffset, sloc);
+    stats->calc_count(fields->atmp["tmp1"]->data, "cfrac", 0.);
 
-    stats->calc_cover(fields->atmp["tmp1"]->data, fields->atmp["tmp4"]->databot, &stats->nmaskbot, &m->tseries["ccover"].data, 0.);
-    stats->calc_path (fields->atmp["tmp1"]->data, fields->atmp["tmp4"]->databot, &stats->nmaskbot, &m->tseries["lwp"].data);
+    stats->calc_cover(fields->atmp["tmp1"]->data, "ccover", 0.);
+    stats->calc_path (fields->atmp["tmp1"]->data, "lwp");
 
     // BvS:micro 
     if(swmicro == "2mom_warm")
     {
-        stats->calc_path (fields->sp["qr"]->data, fields->atmp["tmp4"]->databot, &stats->nmaskbot, &m->tseries["rwp"].data);
+        stats->calc_path (fields->sp["qr"]->data, "rwp");
 
         if(swmicrobudget == "1")
         {
@@ -1411,10 +1710,10 @@ void Thermo_moist::exec_stats(Mask *m)
                                grid->iend,   grid->jend,   grid->kend, 
                                grid->icells, grid->ijcells);
 
-            stats->calc_mean(m->profs["auto_qrt" ].data, fields->atmp["tmp2"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["auto_nrt" ].data, fields->atmp["tmp5"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["auto_qtt" ].data, fields->atmp["tmp6"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["auto_thlt"].data, fields->atmp["tmp7"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
+            stats->calc_mean("auto_qrt" , fields->atmp["tmp2"]->data, NoOffset, sloc);
+            stats->calc_mean("auto_nrt" , fields->atmp["tmp5"]->data, NoOffset, sloc);
+            stats->calc_mean("auto_qtt" , fields->atmp["tmp6"]->data, NoOffset, sloc);
+            stats->calc_mean("auto_thlt", fields->atmp["tmp7"]->data, NoOffset, sloc);
 
             // Evaporation
             mp::zero(fields->atmp["tmp2"]->data, grid->ncells);
@@ -1429,10 +1728,10 @@ void Thermo_moist::exec_stats(Mask *m)
                             grid->iend,   grid->jend,   grid->kend, 
                             grid->icells, grid->ijcells);
 
-            stats->calc_mean(m->profs["evap_qrt" ].data, fields->atmp["tmp2"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["evap_nrt" ].data, fields->atmp["tmp5"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["evap_qtt" ].data, fields->atmp["tmp6"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["evap_thlt"].data, fields->atmp["tmp7"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
+            stats->calc_mean("evap_qrt" , fields->atmp["tmp2"]->data, NoOffset, sloc);
+            stats->calc_mean("evap_nrt" , fields->atmp["tmp5"]->data, NoOffset, sloc);
+            stats->calc_mean("evap_qtt" , fields->atmp["tmp6"]->data, NoOffset, sloc);
+            stats->calc_mean("evap_thlt", fields->atmp["tmp7"]->data, NoOffset, sloc);
 
             // Accretion
             mp::zero(fields->atmp["tmp2"]->data, grid->ncells);
@@ -1445,9 +1744,9 @@ void Thermo_moist::exec_stats(Mask *m)
                           grid->iend,   grid->jend,   grid->kend, 
                           grid->icells, grid->ijcells);
 
-            stats->calc_mean(m->profs["accr_qrt" ].data, fields->atmp["tmp2"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["accr_qtt" ].data, fields->atmp["tmp5"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["accr_thlt"].data, fields->atmp["tmp6"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
+            stats->calc_mean("accr_qrt" , fields->atmp["tmp2"]->data, NoOffset, sloc);
+            stats->calc_mean("accr_qtt" , fields->atmp["tmp5"]->data, NoOffset, sloc);
+            stats->calc_mean("accr_thlt", fields->atmp["tmp6"]->data, NoOffset, sloc);
 
             // Selfcollection and breakup
             mp::zero(fields->atmp["tmp2"]->data, grid->ncells);
@@ -1457,7 +1756,7 @@ void Thermo_moist::exec_stats(Mask *m)
                                        grid->iend,   grid->jend,   grid->kend, 
                                        grid->icells, grid->ijcells);
 
-            stats->calc_mean(m->profs["scbr_nrt" ].data, fields->atmp["tmp2"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
+            stats->calc_mean("scbr_nrt" , fields->atmp["tmp2"]->data, NoOffset, sloc);
 
             // Sedimentation
             mp::zero(fields->atmp["tmp2"]->data, grid->ncells);
@@ -1498,8 +1797,8 @@ void Thermo_moist::exec_stats(Mask *m)
                                    grid->iend,   grid->jend,   grid->kend, 
                                    grid->icells, grid->kcells, grid->ijcells);
 
-            stats->calc_mean(m->profs["sed_qrt"].data, fields->atmp["tmp2"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
-            stats->calc_mean(m->profs["sed_nrt"].data, fields->atmp["tmp5"]->data, NoOffset, sloc, fields->atmp["tmp3"]->data, stats->nmask);
+            stats->calc_mean("sed_qrt", fields->atmp["tmp2"]->data, NoOffset, sloc);
+            stats->calc_mean("sed_nrt", fields->atmp["tmp5"]->data, NoOffset, sloc);
         }
     }
 
@@ -1512,12 +1811,16 @@ void Thermo_moist::exec_stats(Mask *m)
                         &tmp2[4*kcells], &tmp2[5*kcells], &tmp2[6*kcells], &tmp2[7*kcells],
                         fields->sp[thvar]->datamean, fields->sp["qt"]->datamean);
 
-        for (int k=0; k<kcells; ++k)
+        for (Mask_map::iterator it=stats->masks.begin(); it!=stats->masks.end(); ++it)
         {
-            m->profs["ph"  ].data[k] = tmp2[0*kcells+k];
-            m->profs["phh" ].data[k] = tmp2[1*kcells+k];
-            m->profs["rho" ].data[k] = tmp2[2*kcells+k];
-            m->profs["rhoh"].data[k] = tmp2[3*kcells+k];
+            Mask* m = &it->second;
+            for (int k=0; k<kcells; ++k)
+            {
+                m->profs["ph"  ].data[k] = tmp2[0*kcells+k];
+                m->profs["phh" ].data[k] = tmp2[1*kcells+k];
+                m->profs["rho" ].data[k] = tmp2[2*kcells+k];
+                m->profs["rhoh"].data[k] = tmp2[3*kcells+k];
+            }
         }
     }
 }
@@ -1536,41 +1839,41 @@ void Thermo_moist::exec_cross()
 
         if (*it == "b")
         {
-            calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp2"]->data, thvref);
+            calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp2"]->data, thvref, get_liquid_water());
             nerror += cross->cross_simple(fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data, *it);
         }
         else if (*it == "ql")
         {
-            calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            copy_liquid_water(fields->atmp["tmp1"]->data);
             nerror += cross->cross_simple(fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data, *it);
         }
         else if (*it == "blngrad")
         {
-            calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp2"]->data, thvref);
+            calc_buoyancy(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp2"]->data, thvref, get_liquid_water());
             // Note: tmp1 twice used as argument -> overwritten in crosspath()
             nerror += cross->cross_lngrad(fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data, fields->atmp["tmp1"]->data, grid->dzi4, *it);
         }
         else if (*it == "qlpath")
         {
-            calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            copy_liquid_water(fields->atmp["tmp1"]->data);
             // Note: tmp1 twice used as argument -> overwritten in crosspath()
             nerror += cross->cross_path(fields->atmp["tmp1"]->data, fields->atmp["tmp2"]->data, fields->atmp["tmp1"]->data, "qlpath");
         }
         else if (*it == "qlbase")
         {
             const double ql_threshold = 0.;
-            calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            copy_liquid_water(fields->atmp["tmp1"]->data);
             nerror += cross->cross_height_threshold(fields->atmp["tmp1"]->data, fields->atmp["tmp1"]->databot, fields->atmp["tmp2"]->data, grid->z, ql_threshold, Bottom_to_top, "qlbase");
         }
         else if (*it == "qltop")
         {
             const double ql_threshold = 0.;
-            calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            copy_liquid_water(fields->atmp["tmp1"]->data);
             nerror += cross->cross_height_threshold(fields->atmp["tmp1"]->data, fields->atmp["tmp1"]->databot, fields->atmp["tmp2"]->data, grid->z, ql_threshold, Top_to_bottom, "qltop");
         }
         else if (*it == "maxthvcloud")
         {
-            calc_liquid_water(fields->atmp["tmp1"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            copy_liquid_water(fields->atmp["tmp1"]->data);
             calc_maximum_thv_perturbation_cloud(fields->atmp["tmp2"]->databot, fields->atmp["tmp2"]->data,
                                                 fields->sp["thl"]->data, fields->sp["qt"]->data, fields->atmp["tmp1"]->data, pref, fields->atmp["tmp2"]->datamean);
             nerror += cross->cross_plane(fields->atmp["tmp2"]->databot, fields->atmp["tmp1"]->data, "maxthvcloud");
@@ -1602,9 +1905,9 @@ void Thermo_moist::exec_dump()
     {
         // TODO BvS restore getThermoField(), the combination of checkThermoField with getThermoField is more elegant...
         if (*it == "b")
-            calc_buoyancy(fields->atmp["tmp2"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp1"]->data, thvref);
+            calc_buoyancy(fields->atmp["tmp2"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, fields->atmp["tmp1"]->data, thvref, get_liquid_water());
         else if (*it == "ql")
-            calc_liquid_water(fields->atmp["tmp2"]->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+            copy_liquid_water(fields->atmp["tmp2"]->data);
         else
             throw 1;
 
@@ -1623,19 +1926,14 @@ bool Thermo_moist::check_field_exists(const std::string name)
 #ifndef USECUDA
 void Thermo_moist::get_thermo_field(Field3d* fld, Field3d* tmp, const std::string name, bool cyclic)
 {
-    const int kcells = grid->kcells;
-
     // BvS: getThermoField() is called from subgrid-model, before thermo(), so re-calculate the hydrostatic pressure
-    // Pass dummy as rhoref,thvref to prevent overwriting base state
-    double* restrict tmp2 = fields->atmp["tmp2"]->data;
     if (swupdatebasestate)
-        calc_base_state(pref, prefh, &tmp2[0*kcells], &tmp2[1*kcells], &tmp2[2*kcells], &tmp2[3*kcells], exnref, exnrefh,
-                fields->sp[thvar]->datamean, fields->sp["qt"]->datamean);
+        update_base_state();
 
     if (name == "b")
-        calc_buoyancy(fld->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, tmp->data, thvref);
+        calc_buoyancy(fld->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref, tmp->data, thvref, get_liquid_water());
     else if (name == "ql")
-        calc_liquid_water(fld->data, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+        copy_liquid_water(fld->data);
     else if (name == "N2")
         calc_N2(fld->data, fields->sp[thvar]->data, grid->dzi, thvref);
     else
@@ -1664,6 +1962,40 @@ void Thermo_moist::get_buoyancy_fluxbot(Field3d *bfield)
 }
 #endif
 
+double* Thermo_moist::get_liquid_water()
+{
+    // The liquid water field is a function of the prognostic fields and the pressure only, thus it only has to
+    // be recomputed if the model has moved to another substep, or if the base state has been updated.
+    bool valid = ql_cache_valid
+              && ql_cache_itime   == model->timeloop->get_itime()
+              && ql_cache_substep == model->timeloop->get_substep();
+
+    for (int k=0; k<grid->kcells && valid; ++k)
+        valid = (ql_cache_pref[k] == pref[k]);
+
+    if (!valid)
+    {
+        calc_liquid_water(ql_cache, fields->sp[thvar]->data, fields->sp["qt"]->data, pref);
+
+        for (int k=0; k<grid->kcells; ++k)
+            ql_cache_pref[k] = pref[k];
+
+        ql_cache_itime   = model->timeloop->get_itime();
+        ql_cache_substep = model->timeloop->get_substep();
+        ql_cache_valid   = true;
+    }
+
+    return ql_cache;
+}
+
+void Thermo_moist::copy_liquid_water(double* restrict ql)
+{
+    const double* restrict qlc = get_liquid_water();
+
+    for (int n=0; n<grid->ncells; ++n)
+        ql[n] = qlc[n];
+}
+
 void Thermo_moist::get_prog_vars(std::vector<std::string> *list)
 {
     list->push_back(thvar);
@@ -1707,6 +2039,127 @@ namespace
         ql = std::max(0.,qt - qs);
         return ql;
     }
+
+    // Saturation adjustment of a horizontal slice at a single pressure level. A pre-pass
+    // sets ql to zero and collects the cells in which qt exceeds the saturation specific
+    // humidity at the liquid water temperature. The Newton iterations of these cells are
+    // done in lockstep, where cells that have converged are masked, so that the loop over
+    // the cells vectorizes. The result is identical to that of sat_adjust(), unless the
+    // saturation vapor pressure is taken from a table.
+    void sat_adjust_slice(double* const restrict ql, const double* const restrict thl, const double* const restrict qt,
+                          const double p, const double exn,
+                          const int istart, const int iend, const int jstart, const int jend, const int jj,
+                          int* const restrict index, double* const restrict work,
+                          const double* const restrict esat_table)
+    {
+        const int nitermax = 30;
+
+        // Find the cells that are saturated at the liquid water temperature.
+        int n = 0;
+        for (int j=jstart; j<jend; ++j)
+            for (int i=istart; i<iend; ++i)
+            {
+                const int ij = i + j*jj;
+                const double qlest = qt[ij] - qsat_tab(esat_table, p, thl[ij]*exn);
+                ql[ij] = 0.;
+                index[n] = ij;
+                n += (qlest > 0);
+            }
+
+        if (n == 0)
+            return;
+
+        double* const restrict tl     = &work[0*n];
+        double* const restrict qtc    = &work[1*n];
+        double* const restrict tnr    = &work[2*n];
+        double* const restrict tnrold = &work[3*n];
+        double* const restrict qs     = &work[4*n];
+
+        #pragma ivdep
+        for (int c=0; c<n; ++c)
+        {
+            tl    [c] = thl[index[c]] * exn;
+            qtc   [c] = qt[index[c]];
+            tnr   [c] = tl[c];
+            tnrold[c] = 1.e9;
+            qs    [c] = 0.;
+        }
+
+        int niter = 0;
+        int nactive = n;
+        while (nactive > 0 && niter < nitermax)
+        {
+            ++niter;
+            nactive = 0;
+
+            #pragma ivdep
+            for (int c=0; c<n; ++c)
+            {
+                const bool active = std::fabs(tnr[c]-tnrold[c])/tnrold[c] > 1e-5;
+                const double qsn  = qsat_tab(esat_table, p, tnr[c]);
+                const double tnrn = tnr[c] - (tnr[c]+(Lv/cp)*qsn-tl[c]-(Lv/cp)*qtc[c])/(1+(std::pow(Lv,2)*qsn)/ (Rv*cp*std::pow(tnr[c],2)));
+
+                tnrold[c] = active ? tnr[c] : tnrold[c];
+                qs    [c] = active ? qsn    : qs[c];
+                tnr   [c] = active ? tnrn   : tnr[c];
+                nactive  += active;
+            }
+        }
+
+        if (nactive > 0)
+        {
+            for (int c=0; c<n; ++c)
+                if (std::fabs(tnr[c]-tnrold[c])/tnrold[c] > 1e-5)
+                {
+                    printf("Saturation adjustment not converged!! [thl=%f K, qt=%f kg/kg, p=%f p]\n",thl[index[c]],qt[index[c]],p);
+                    break;
+                }
+            throw 1;
+        }
+
+        #pragma ivdep
+        for (int c=0; c<n; ++c)
+            ql[index[c]] = std::max(0.,qtc[c] - qs[c]);
+    }
+}
+
+// Recalculate the base state if the update interval has passed and the mean state has changed sufficiently.
+bool Thermo_moist::update_base_state()
+{
+    const int kcells = grid->kcells;
+
+    const double* restrict thlmean = fields->sp[thvar]->datamean;
+    const double* restrict qtmean  = fields->sp["qt"]->datamean;
+
+    const unsigned long itime = model->timeloop->get_itime();
+    const unsigned long ibasestatetime = (unsigned long)(model->timeloop->get_ifactor()*basestatetime + 0.5);
+
+    if (basestate_valid)
+    {
+        if (itime - basestate_itime < ibasestatetime)
+            return false;
+
+        // Largest change of the dry estimate of the mean virtual potential temperature
+        double dthvmax = 0.;
+        for (int k=0; k<kcells; ++k)
+            dthvmax = std::max(dthvmax, std::abs(thlmean[k]*(1. + (Rv/Rd-1.)*qtmean[k]) - thvmean_basestate[k]));
+
+        if (dthvmax <= basestatetol)
+            return false;
+    }
+
+    // Pass dummy as rhoref,thvref to prevent overwriting base state
+    double* restrict tmp2 = fields->atmp["tmp2"]->data;
+    calc_base_state(pref, prefh, &tmp2[0*kcells], &tmp2[1*kcells], &tmp2[2*kcells], &tmp2[3*kcells], exnref, exnrefh,
+                    fields->sp[thvar]->datamean, fields->sp["qt"]->datamean);
+
+    for (int k=0; k<kcells; ++k)
+        thvmean_basestate[k] = thlmean[k]*(1. + (Rv/Rd-1.)*qtmean[k]);
+
+    basestate_itime = itime;
+    basestate_valid = true;
+
+    return true;
 }
 
 /**
@@ -1777,14 +2230,15 @@ void  Thermo_moist::calc_base_state(double* restrict pref,    double* restrict p
 
 void Thermo_moist::calc_buoyancy_tend_2nd(double* restrict wt, double* restrict thl, double* restrict qt,
                                           double* restrict ph, double* restrict thlh, double* restrict qth,
-                                          double* restrict ql, double* restrict thvrefh)
+                                          double* restrict ql, double* restrict thvrefh,
+                                          const int kb, const int ke)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    double tl, exnh;
+    double exnh;
 
-    for (int k=grid->kstart+1; k<grid->kend; k++)
+    for (int k=std::max(kb, grid->kstart+1); k<ke; k++)
     {
         exnh = exner(ph[k]);
         for (int j=grid->jstart; j<grid->jend; j++)
@@ -1795,23 +2249,11 @@ void Thermo_moist::calc_buoyancy_tend_2nd(double* restrict wt, double* restrict
                 const int ij  = i + j*jj;
                 thlh[ij] = interp2(thl[ijk-kk], thl[ijk]);
                 qth[ij]  = interp2(qt[ijk-kk], qt[ijk]);
-                tl       = thlh[ij] * exnh;
-                // Calculate first estimate of ql using Tl
-                // if ql(Tl)>0, saturation adjustment routine needed
-                ql[ij]  = qth[ij]-qsat(ph[k],tl);
-            }
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ij  = i + j*jj;
-                if (ql[ij]>0)   // already doesn't vectorize because of iteration in sat_adjust()
-                {
-                    ql[ij] = sat_adjust(thlh[ij], qth[ij], ph[k], exnh);
-                }
-                else
-                    ql[ij] = 0.;
             }
+
+        sat_adjust_slice(ql, thlh, qth, ph[k], exnh,
+                         grid->istart, grid->iend, grid->jstart, grid->jend, jj, sat_index, sat_work, esat_table);
+
         for (int j=grid->jstart; j<grid->jend; j++)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; i++)
@@ -1825,37 +2267,33 @@ void Thermo_moist::calc_buoyancy_tend_2nd(double* restrict wt, double* restrict
 
 
 void Thermo_moist::calc_buoyancy(double* restrict b, double* restrict thl, double* restrict qt,
-                                 double* restrict p, double* restrict ql, double* restrict thvref)
+                                 double* restrict p, double* restrict ql, double* restrict thvref,
+                                 double* restrict qlfull)
 {
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    double tl, ex;
+    double ex;
 
     for (int k=0; k<grid->kcells; k++)
     {
         ex = exner(p[k]);
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                const int ij  = i + j*jj;
-                tl  = thl[ijk] * ex;
-                ql[ij]  = qt[ijk]-qsat(p[k],tl);   // not real ql, just estimate
-            }
 
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                const int ij  = i + j*jj;
-                if (ql[ij] > 0)
-                    ql[ij] = sat_adjust(thl[ijk], qt[ijk], p[k], ex);
-                else
-                    ql[ij] = 0.;
-            }
+        // Take the liquid water from the full field inside the domain, the ghost levels are not included in it.
+        if (k >= grid->kstart && k < grid->kend)
+        {
+            for (int j=grid->jstart; j<grid->jend; j++)
+                #pragma ivdep
+                for (int i=grid->istart; i<grid->iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    const int ij  = i + j*jj;
+                    ql[ij] = qlfull[ijk];
+                }
+        }
+        else
+            sat_adjust_slice(ql, &thl[k*kk], &qt[k*kk], p[k], ex,
+                             grid->istart, grid->iend, grid->jstart, grid->jend, jj, sat_index, sat_work, esat_table);
 
         for (int j=grid->jstart; j<grid->jend; j++)
             #pragma ivdep
@@ -1956,13 +2394,8 @@ void Thermo_moist::calc_liquid_water(double* restrict ql, double* restrict thl,
     for (int k=grid->kstart; k<grid->kend; k++)
     {
         ex = exner(p[k]);
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                ql[ijk] = sat_adjust(thl[ijk], qt[ijk], p[k], ex);
-            }
+        sat_adjust_slice(&ql[k*kk], &thl[k*kk], &qt[k*kk], p[k], ex,
+                         grid->istart, grid->iend, grid->jstart, grid->jend, jj, sat_index, sat_work, esat_table);
     }
 }
 
@@ -2166,7 +2599,7 @@ void Thermo_moist::calc_buoyancy_tend_4th(double* restrict wt, double* restrict
     const int kk1 = 1*grid->ijcells;
     const int kk2 = 2*grid->ijcells;
 
-    double tl, exnh;
+    double exnh;
 
     for (int k=grid->kstart+1; k<grid->kend; k++)
     {
@@ -2179,21 +2612,11 @@ void Thermo_moist::calc_buoyancy_tend_4th(double* restrict wt, double* restrict
                 const int ij  = i + j*jj;
                 thlh[ij] = interp4(thl[ijk-kk2], thl[ijk-kk1], thl[ijk], thl[ijk+kk1]);
                 qth[ij]  = interp4(qt[ijk-kk2],  qt[ijk-kk1],  qt[ijk],  qt[ijk+kk1]);
-                tl       = thlh[ij] * exnh;
-                // Calculate first estimate of ql using Tl
-                // if ql(Tl)>0, saturation adjustment routine needed
-                ql[ij]  = qth[ij]-qsat(ph[k],tl);
-            }
-        for (int j=grid->jstart; j<grid->jend; j++)
-            #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ij = i + j*jj;
-                if (ql[ij]>0)   // already doesn't vectorize because of iteration in sat_adjust()
-                    ql[ij] = sat_adjust(thlh[ij], qth[ij], ph[k], exnh);
-                else
-                    ql[ij] = 0.;
             }
+
+        sat_adjust_slice(ql, thlh, qth, ph[k], exnh,
+                         grid->istart, grid->iend, grid->jstart, grid->jend, jj, sat_index, sat_work, esat_table);
+
         for (int j=grid->jstart; j<grid->jend; j++)
             #pragma ivdep
             for (int i=grid->istart; i<grid->iend; i++)
@@ -22,6 +22,7 @@
 
 #include <cstdio>
 #include <cmath>
+#include <vector>
 #include "input.h"
 #include "master.h"
 #include "grid.h"
@@ -216,18 +217,35 @@ void Timeloop::set_time_step()
 #ifndef USECUDA
 void Timeloop::exec()
 {
+    // Collect the prognostic fields, so that all of them are integrated in a single sweep.
+    std::vector<double*> a;
+    std::vector<double*> at;
+    for (FieldMap::const_iterator it = fields->at.begin(); it!=fields->at.end(); ++it)
+    {
+        a .push_back(fields->ap[it->first]->data);
+        at.push_back(it->second->data);
+    }
+
+    std::vector<float*> as;
+    std::vector<double*> ats;
+    for (FieldMap::const_iterator it = fields->sts.begin(); it!=fields->sts.end(); ++it)
+    {
+        as .push_back(fields->sps[it->first]->data_single);
+        ats.push_back(it->second->data);
+    }
+
     if (rkorder == 3)
     {
-        for (FieldMap::const_iterator it = fields->at.begin(); it!=fields->at.end(); ++it)
-            rk3(fields->ap[it->first]->data, it->second->data, dt);
+        rk3(a.data() , at.data() , a.size() , dt);
+        rk3(as.data(), ats.data(), as.size(), dt);
 
         substep = (substep+1) % 3;
     }
 
     if (rkorder == 4)
     {
-        for (FieldMap::const_iterator it = fields->at.begin(); it!=fields->at.end(); ++it)
-            rk4(fields->ap[it->first]->data, it->second->data, dt);
+        rk4(a.data() , at.data() , a.size() , dt);
+        rk4(as.data(), ats.data(), as.size(), dt);
 
         substep = (substep+1) % 5;
     }
@@ -245,6 +263,33 @@ double Timeloop::get_sub_time_step()
     return subdt;
 }
 
+double Timeloop::get_stage_time_step()
+{
+    // The substep has already been advanced by exec(), so take the interval between the
+    // stage times of the previous substep and the current one. The intervals sum to dt.
+    double stagedt = 0.;
+    if (rkorder == 3)
+    {
+        const double c [] = {0., 1./3., 3./4., 1.};
+        const int s = (substep+2) % 3;
+        stagedt = (c[s+1]-c[s])*dt;
+    }
+    else if (rkorder == 4)
+    {
+        const double c [] = {
+            0.,
+            1432997174477./9575080441755.,
+            2526269341429./6820363962896.,
+            2006345519317./3224310063776.,
+            2802321613138./2924317926251.,
+            1.};
+        const int s = (substep+4) % 5;
+        stagedt = (c[s+1]-c[s])*dt;
+    }
+
+    return stagedt;
+}
+
 inline double Timeloop::rk3subdt(const double dt)
 {
     const double cB [] = {1./3., 15./16., 8./15.};
@@ -262,7 +307,8 @@ inline double Timeloop::rk4subdt(const double dt)
     return cB[substep]*dt;
 }
 
-void Timeloop::rk3(double * restrict a, double * restrict at, const double dt)
+template<typename T>
+void Timeloop::rk3(T* const* a, double* const* at, const int nfields, const double dt)
 {
     const double cA [] = {0., -5./9., -153./128.};
     const double cB [] = {1./3., 15./16., 8./15.};
@@ -270,29 +316,33 @@ void Timeloop::rk3(double * restrict a, double * restrict at, const double dt)
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    for (int k=grid->kstart; k<grid->kend; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                a[ijk] += cB[substep]*dt*at[ijk];
-            }
-
     const int substepn = (substep+1) % 3;
 
-    // substep 0 resets the tendencies, because cA[0] == 0
+    const double cBdt = cB[substep]*dt;
+    const double cAn  = cA[substepn];
+
+    // Update the field and scale the tendency in one pass, walking through all
+    // fields per level, so the level of every field is read and written once.
+    // Substep 0 resets the tendencies, because cA[0] == 0.
     for (int k=grid->kstart; k<grid->kend; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
+        for (int n=0; n<nfields; ++n)
+        {
+            T* restrict an = a[n];
+            double* restrict atn = at[n];
+
+            for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                at[ijk] *= cA[substepn];
-            }
+                for (int i=grid->istart; i<grid->iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    an[ijk] += cBdt*atn[ijk];
+                    atn[ijk] *= cAn;
+                }
+        }
 }
 
-void Timeloop::rk4(double * restrict a, double * restrict at, const double dt)
+template<typename T>
+void Timeloop::rk4(T* const* a, double* const* at, const int nfields, const double dt)
 {
     const double cA [] = {
         0.,
@@ -311,26 +361,27 @@ void Timeloop::rk4(double * restrict a, double * restrict at, const double dt)
     const int jj = grid->icells;
     const int kk = grid->ijcells;
 
-    for (int k=grid->kstart; k<grid->kend; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
-#pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                a[ijk] = a[ijk] + cB[substep]*dt*at[ijk];
-            }
-
     const int substepn = (substep+1) % 5;
 
-    // substep 0 resets the tendencies, because cA[0] == 0
+    const double cBdt = cB[substep]*dt;
+    const double cAn  = cA[substepn];
+
+    // Substep 0 resets the tendencies, because cA[0] == 0.
     for (int k=grid->kstart; k<grid->kend; k++)
-        for (int j=grid->jstart; j<grid->jend; j++)
+        for (int n=0; n<nfields; ++n)
+        {
+            T* restrict an = a[n];
+            double* restrict atn = at[n];
+
+            for (int j=grid->jstart; j<grid->jend; j++)
 #pragma ivdep
-            for (int i=grid->istart; i<grid->iend; i++)
-            {
-                const int ijk = i + j*jj + k*kk;
-                at[ijk] = cA[substepn]*at[ijk];
-            }
+                for (int i=grid->istart; i<grid->iend; i++)
+                {
+                    const int ijk = i + j*jj + k*kk;
+                    an[ijk] = an[ijk] + cBdt*atn[ijk];
+                    atn[ijk] = cAn*atn[ijk];
+                }
+        }
 }
 
 bool Timeloop::in_substep()